@@ -31,6 +31,11 @@ using Sequence = uint16_t;
 	#undef assert
 #endif
 
+#ifndef _WIN32
+	#include <signal.h>
+	#define __debugbreak() raise(SIGTRAP)
+#endif
+
 #ifdef _DEBUG
 #define ASSERT(expression, ...) do { if (!(expression)) \
 { \
@@ -7,31 +7,37 @@
 using namespace input;
 
 Action::Action() :
-	m_hashedName(0)
+	m_hashedName(0),
+	m_isAxis(false),
+	m_value(0.0f)
 {
 }
 
 void Action::set(size_t hash, ButtonState inputEvent)
 {
 	m_hashedName = hash;
+	m_isAxis     = false;
 	m_inputEvent = inputEvent;
 }
 
 void Action::set(size_t hash, float value)
 {
 	m_hashedName  = hash;
+	m_isAxis      = true;
 	m_value = value;
 }
 
 void Action::set(const std::string& name, ButtonState inputEvent)
 {
 	m_hashedName = std::hash<std::string>()(name);
+	m_isAxis     = false;
 	m_inputEvent = inputEvent;
 }
 
 void Action::set(const std::string& name, float value)
 {
 	m_hashedName  = std::hash<std::string>()(name);
+	m_isAxis      = true;
 	m_value = value;
 }
 
@@ -45,6 +51,16 @@ float Action::getValue() const
 	return m_value;
 }
 
+ButtonState Action::getInputEvent() const
+{
+	return m_inputEvent;
+}
+
+bool Action::isAxis() const
+{
+	return m_isAxis;
+}
+
 bool input::operator==(const Action& a, const Action& b)
 {
 	return (a.getHash() == b.getHash() && a.getValue() == b.getValue());
@@ -24,11 +24,16 @@ namespace input
 		void set(const std::string& name, ButtonState inputEvent);
 		void set(const std::string& name, float value);
 
-		size_t getHash() const;
-		float  getValue() const;
+		size_t      getHash()       const;
+		float       getValue()      const;
+		ButtonState getInputEvent() const;
+
+		/* @return true if the action carries an axis value instead of a ButtonState */
+		bool        isAxis()        const;
 
 	protected:
 		size_t m_hashedName;
+		bool   m_isAxis;
 
 		union
 		{
@@ -3,9 +3,15 @@
 
 #include <common.h>
 #include <network/message.h>
+#include <utility/bitstream.h>
+
+#include <algorithm>
 
 using namespace input;
 
+/* Axis values are sent within [-1, 1] */
+static const float s_axisPrecision = 1.0f / 512.0f;
+
 ActionBuffer::ActionBuffer() :
 	m_actions(s_maxActions)
 {
@@ -55,19 +61,19 @@ const input::Action* ActionBuffer::end() const
 	return m_actions.end();
 }
 
-bool ActionBuffer::serialize(ReadStream& stream)
+bool ActionBuffer::isEqual(const ActionBuffer& other) const
 {
-	uint32_t numActions = 0;
-	serializeInt(stream, numActions);
-	if (numActions > s_maxActions)
+	if (getCount() != other.getCount())
 	{
 		return false;
 	}
 
-	if (numActions > 0)
+	for (uint32_t i = 0; i < getCount(); i++)
 	{
-		if (!stream.serializeData(reinterpret_cast<char*>(m_actions.begin()),
-			numActions * sizeof(Action)))
+		const Action& a = m_actions[i];
+		const Action& b = other.m_actions[i];
+		if (a.getHash() != b.getHash() || a.isAxis() != b.isAxis()
+			|| (a.isAxis() ? a.getValue() != b.getValue() : a.getInputEvent() != b.getInputEvent()))
 		{
 			return false;
 		}
@@ -76,15 +82,111 @@ bool ActionBuffer::serialize(ReadStream& stream)
 	return true;
 }
 
-bool ActionBuffer::serialize(WriteStream& stream)
+bool ActionBuffer::serialize(ReadStream& stream, const ActionDictionary& dictionary, const ActionBuffer* previous)
 {
-	uint32_t numActions = m_actions.getCount();
+	clear();
+
+	bool isUnchanged = false;
+	serializeBool(stream, isUnchanged);
+	if (isUnchanged)
+	{
+		if (previous != nullptr)
+		{
+			insert(*previous);
+		}
+		return true;
+	}
+
+	int32_t numActions = 0;
+	serializeInt(stream, numActions, 0, s_maxActions);
+	if (numActions > 0 && dictionary.getCount() == 0)
+	{
+		return false;
+	}
 
-	serializeInt(stream, numActions);
-	if (numActions > 0)
+	for (int32_t i = 0; i < numActions; i++)
 	{
-		stream.serializeData(reinterpret_cast<const char*>(begin()),
-			numActions * sizeof(input::Action));
+		int32_t index = 0;
+		serializeInt(stream, index, 0, std::max(dictionary.getCount() - 1, 1));
+		if (index >= dictionary.getCount())
+		{
+			return false;
+		}
+
+		Action action;
+		bool isAxis = false;
+		serializeBool(stream, isAxis);
+		if (isAxis)
+		{
+			float value = 0.0f;
+			if (!serializeFloat(stream, value, -1.0f, 1.0f, s_axisPrecision))
+			{
+				return false;
+			}
+			action.set(dictionary.getHash(index), value);
+		}
+		else
+		{
+			uint32_t inputEvent = 0;
+			serializeBits(stream, inputEvent, 2);
+			if (inputEvent > ButtonState::Repeat)
+			{
+				return false;
+			}
+			action.set(dictionary.getHash(index), static_cast<ButtonState>(inputEvent));
+		}
+
+		insert(action);
+	}
+
+	return true;
+}
+
+bool ActionBuffer::serialize(WriteStream& stream, const ActionDictionary& dictionary, const ActionBuffer* previous) const
+{
+	bool isUnchanged = (previous != nullptr) ? isEqual(*previous) : isEmpty();
+	serializeBool(stream, isUnchanged);
+	if (isUnchanged)
+	{
+		return true;
+	}
+
+	int32_t indices[s_maxActions];
+	int32_t numActions = 0;
+	for (const Action& action : m_actions)
+	{
+		const int32_t index = dictionary.find(action.getHash());
+		if (index != INDEX_NONE)
+		{
+			indices[numActions++] = index;
+		}
+	}
+
+	serializeInt(stream, numActions, 0, s_maxActions);
+
+	int32_t actionIndex = 0;
+	for (const Action& action : m_actions)
+	{
+		if (dictionary.find(action.getHash()) == INDEX_NONE)
+		{
+			continue;
+		}
+
+		int32_t index = indices[actionIndex++];
+		serializeInt(stream, index, 0, std::max(dictionary.getCount() - 1, 1));
+
+		bool isAxis = action.isAxis();
+		serializeBool(stream, isAxis);
+		if (isAxis)
+		{
+			float value = action.getValue();
+			serializeFloat(stream, value, -1.0f, 1.0f, s_axisPrecision);
+		}
+		else
+		{
+			uint32_t inputEvent = action.getInputEvent();
+			serializeBits(stream, inputEvent, 2);
+		}
 	}
 
 	return true;
@@ -4,6 +4,7 @@
 #include <utility/buffer.h>
 #include <common.h>
 #include <core/action.h>
+#include <core/action_dictionary.h>
 
 #include <string>
 
@@ -27,12 +28,17 @@ public:
 
 	uint32_t getCount() const;
 	bool     isEmpty()  const;
+	bool     isEqual(const ActionBuffer& other) const;
 
 	const input::Action* begin() const;
 	const input::Action* end()   const;
 
-	bool serialize(class ReadStream& message);
-	bool serialize(class WriteStream& message);
+	/** Writes the actions as indices into dictionary with their ButtonState or
+	*   axis value, or a single bit when they equal previous. Actions missing
+	*   from dictionary are left out
+	*   @param previous  The player's actions the frame before, nullptr if none */
+	bool serialize(class ReadStream& stream, const ActionDictionary& dictionary, const ActionBuffer* previous);
+	bool serialize(class WriteStream& stream, const ActionDictionary& dictionary, const ActionBuffer* previous) const;
 
 private:
 	Buffer<input::Action> m_actions;
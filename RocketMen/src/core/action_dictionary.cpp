@@ -0,0 +1,81 @@
+#include <core/action_dictionary.h>
+
+#include <core/debug.h>
+#include <utility/bitstream.h>
+
+ActionDictionary::ActionDictionary()
+{
+	clear();
+}
+
+void ActionDictionary::clear()
+{
+	m_count = 0;
+}
+
+int32_t ActionDictionary::add(size_t hash)
+{
+	const int32_t index = find(hash);
+	if (index != INDEX_NONE)
+	{
+		return index;
+	}
+
+	if (m_count == s_maxEntries)
+	{
+		LOG_WARNING("ActionDictionary: out of entries, action left out");
+		return INDEX_NONE;
+	}
+
+	m_hashes[m_count] = hash;
+	return m_count++;
+}
+
+int32_t ActionDictionary::find(size_t hash) const
+{
+	for (int32_t i = 0; i < m_count; i++)
+	{
+		if (m_hashes[i] == hash)
+		{
+			return i;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+size_t ActionDictionary::getHash(int32_t index) const
+{
+	ASSERT(index >= 0 && index < m_count, "Invalid index");
+	return m_hashes[index];
+}
+
+int32_t ActionDictionary::getCount() const
+{
+	return m_count;
+}
+
+bool ActionDictionary::serialize(ReadStream& stream)
+{
+	serializeInt(stream, m_count, 0, s_maxEntries);
+	for (int32_t i = 0; i < m_count; i++)
+	{
+		uint64_t hash = 0;
+		serializeUint64(stream, hash);
+		m_hashes[i] = static_cast<size_t>(hash);
+	}
+
+	return true;
+}
+
+bool ActionDictionary::serialize(WriteStream& stream)
+{
+	serializeInt(stream, m_count, 0, s_maxEntries);
+	for (int32_t i = 0; i < m_count; i++)
+	{
+		uint64_t hash = m_hashes[i];
+		serializeUint64(stream, hash);
+	}
+
+	return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <common.h>
+
+/* ActionDictionary
+*  Hashed action names a client sends input for, in the order they were
+*  first used. Sent once per session, and again when it grows, so input
+*  refers to actions by their index instead of their hash.
+*/
+class ActionDictionary
+{
+public:
+	static const int32_t s_maxEntries = 64;
+
+	ActionDictionary();
+
+	void clear();
+
+	/** @return index of hash, added when missing. INDEX_NONE when full */
+	int32_t add(size_t hash);
+
+	/** @return index of hash, INDEX_NONE when missing */
+	int32_t find(size_t hash) const;
+
+	size_t  getHash(int32_t index) const;
+	int32_t getCount()             const;
+
+	bool serialize(class ReadStream& stream);
+	bool serialize(class WriteStream& stream);
+
+private:
+	size_t  m_hashes[s_maxEntries];
+	int32_t m_count;
+};
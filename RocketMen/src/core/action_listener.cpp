@@ -1,28 +1,28 @@
 
 #include <core/action_listener.h>
 #include <core/debug.h>
+#include <core/room.h>
 #include <network/network.h>
 
-static std::vector<ActionListener*> s_actionListeners;
-
 std::vector<ActionListener*>& ActionListener::getList()
 {
-	return s_actionListeners;
+	return Room::getCurrent()->m_actionListeners;
 }
 
 ActionListener::ActionListener(int16_t playerId) :
 	m_playerId(playerId)
 {
-	s_actionListeners.push_back(this);
+	getList().push_back(this);
 }
 
 ActionListener::~ActionListener()
 {
-	for (auto it = s_actionListeners.begin(); it != s_actionListeners.end();)
+	std::vector<ActionListener*>& actionListeners = getList();
+	for (auto it = actionListeners.begin(); it != actionListeners.end();)
 	{
 		if (*it == this)
 		{
-			s_actionListeners.erase(it);
+			actionListeners.erase(it);
 			return;
 		}
 		++it;
@@ -18,6 +18,7 @@
 class ActionListener
 {
 public:
+	/* Listeners of the Room bound to the calling thread */
 	static std::vector<ActionListener*>& getList();
 
 public:
@@ -0,0 +1,302 @@
+#include "bot_host.h"
+
+#include <core/action_buffer.h>
+#include <core/debug.h>
+#include <core/entity_manager.h>
+#include <core/game.h>
+#include <core/game_time.h>
+#include <core/room.h>
+#include <core/room_host.h>
+#include <network/bot_client.h>
+#include <network/network.h>
+#include <physics/physics.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+/* Bots tick at the default timestep of Game */
+static const uint64_t s_botTimestep = 33333ULL / 2;
+
+/* Longest a frame may catch up on, as in Core::run */
+static const float    s_maxFrameTime = 0.25f;
+
+/* Frames between shots of a bot, scripted or on average */
+static const int32_t  s_fireInterval = 30;
+
+/* Frames the bots keep running after disconnecting, to send their Disconnect */
+static const int32_t  s_numDisconnectFrames = 4;
+
+struct BotHost::Bot
+{
+	Bot(int32_t id) : room(id), random(static_cast<uint32_t>(id)) {}
+
+	Room               room;
+	Physics            physics;
+	network::BotClient client;
+	std::mt19937       random;
+};
+
+/** @return the value below which percentile of the samples fall, 0 without samples */
+static float getPercentile(std::vector<float>& samples, float percentile)
+{
+	if (samples.empty())
+	{
+		return 0.0f;
+	}
+
+	const size_t index = std::min(samples.size() - 1, static_cast<size_t>(percentile * samples.size()));
+	std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+	return samples[index];
+}
+
+//=============================================================================
+
+BotHost::BotHost(int32_t maxBots, int32_t botsPerStep, float stepSeconds, BotInput input) :
+	m_maxBots(maxBots),
+	m_botsPerStep(botsPerStep),
+	m_stepSeconds(stepSeconds),
+	m_input(input),
+	m_isRunning(false),
+	m_bytesReceived(0),
+	m_bytesSent(0),
+	m_serverRoom(nullptr),
+	m_isServerStarted(false),
+	m_isServerHosting(false)
+{
+	ASSERT(maxBots > 0 && botsPerStep > 0);
+	ASSERT(stepSeconds > 0.0f);
+}
+
+BotHost::~BotHost()
+{
+	stop();
+	removeBots();
+	delete m_serverRoom;
+}
+
+bool BotHost::runWithServer(const CreateGameMethod& createGame, const CommandLineOptions& options)
+{
+	ASSERT(createGame);
+	ASSERT(m_serverRoom == nullptr, "BotHost already hosted a server");
+
+	m_isRunning = true;
+	m_serverRoom = new Room(0);
+	m_serverThread = std::thread(&BotHost::runServer, this, createGame, std::cref(options));
+	{
+		std::unique_lock<std::mutex> lock(m_serverMutex);
+		m_serverCondition.wait(lock, [this]() { return m_isServerStarted; });
+	}
+
+	if (m_isServerHosting)
+	{
+		run(network::Address("127.0.0.1", s_defaultServerPort));
+	}
+	else
+	{
+		LOG_ERROR("BotHost: The game did not host a server, start it as a dedicated server");
+	}
+
+	stop();
+	m_serverThread.join();
+	return m_isServerHosting;
+}
+
+void BotHost::run(const network::Address& address)
+{
+	LOG_INFO("BotHost: Ramping up to %d bots, %d every %.1f seconds", m_maxBots, m_botsPerStep, m_stepSeconds);
+	m_isRunning = true;
+
+	input::Action fire;
+	fire.set("Fire", input::ButtonState::Press);
+	std::uniform_int_distribution<int32_t> fireDistribution(0, s_fireInterval - 1);
+
+	Time time;
+	const float fixedDeltaTime = s_botTimestep / 1000000.0f;
+	float accumulator = 0.0f;
+	float stepTime = 0.0f;
+	Sequence frameCounter = 0;
+	ActionBuffer actions;
+
+	addBots(m_botsPerStep, address);
+	while (m_isRunning)
+	{
+		time.update();
+		for (Bot* bot : m_bots)
+		{
+			Room::bind(&bot->room);
+			bot->client.update(time);
+			EntityManager::flushEntities();
+		}
+		Room::bind(nullptr);
+
+		accumulator += std::min(time.getDeltaSeconds(), s_maxFrameTime);
+		while (accumulator >= fixedDeltaTime)
+		{
+			for (size_t i = 0; i < m_bots.size(); i++)
+			{
+				Bot* bot = m_bots[i];
+				actions.clear();
+				if ((m_input == BotInput::Scripted && (frameCounter + i) % s_fireInterval == 0)
+					|| (m_input == BotInput::Random && fireDistribution(bot->random) == 0))
+				{
+					actions.insert(fire);
+				}
+				bot->client.tick(frameCounter, actions);
+			}
+			accumulator -= fixedDeltaTime;
+			frameCounter++;
+		}
+
+		stepTime += time.getDeltaSeconds();
+		if (stepTime >= m_stepSeconds)
+		{
+			report(stepTime);
+			stepTime = 0.0f;
+
+			const int32_t numBots = static_cast<int32_t>(m_bots.size());
+			if (numBots >= m_maxBots)
+			{
+				break;
+			}
+			addBots(std::min(m_botsPerStep, m_maxBots - numBots), address);
+		}
+
+		std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>((fixedDeltaTime - accumulator) * 1000000.0f)));
+	}
+
+	removeBots();
+}
+
+void BotHost::stop()
+{
+	m_isRunning = false;
+}
+
+void BotHost::runServer(const CreateGameMethod& createGame, const CommandLineOptions& options)
+{
+	Room::bind(m_serverRoom);
+
+	Physics physics;
+	physics.initialize();
+
+	Game* game = createGame();
+	const GameContext context = { options, nullptr };
+	game->initialize(context);
+
+	{
+		std::lock_guard<std::mutex> lock(m_serverMutex);
+		m_isServerStarted = true;
+		m_isServerHosting = Network::isServer();
+	}
+	m_serverCondition.notify_one();
+
+	Time time;
+	float accumulator = 0.0f;
+	Sequence frameCounter = 0;
+
+	while (m_isRunning && Network::isServer())
+	{
+		time.update();
+
+		const auto startTime = std::chrono::steady_clock::now();
+		const float timeToNextTick = RoomHost::runFrame(game, physics, time, accumulator, frameCounter);
+		const std::chrono::duration<float, std::milli> frameTime = std::chrono::steady_clock::now() - startTime;
+		{
+			std::lock_guard<std::mutex> lock(m_serverMutex);
+			m_serverFrameTimes.push_back(frameTime.count());
+		}
+
+		std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(timeToNextTick * 1000000.0f)));
+	}
+
+	game->leaveSession();
+	EntityManager::flushEntities();
+	EntityManager::killEntities();
+	physics.terminate();
+	game->terminate();
+	delete game;
+
+	Room::bind(nullptr);
+}
+
+void BotHost::addBots(int32_t numBots, const network::Address& address)
+{
+	for (int32_t i = 0; i < numBots; i++)
+	{
+		Bot* bot = new Bot(static_cast<int32_t>(m_bots.size()) + 1);
+		Room::bind(&bot->room);
+		bot->physics.initialize();
+		bot->client.connect(address);
+		m_bots.push_back(bot);
+	}
+	Room::bind(nullptr);
+}
+
+void BotHost::removeBots()
+{
+	for (Bot* bot : m_bots)
+	{
+		bot->client.disconnect();
+	}
+
+	Time time;
+	for (int32_t i = 0; i < s_numDisconnectFrames; i++)
+	{
+		time.update();
+		for (Bot* bot : m_bots)
+		{
+			Room::bind(&bot->room);
+			bot->client.update(time);
+		}
+		Room::bind(nullptr);
+	}
+
+	for (Bot* bot : m_bots)
+	{
+		Room::bind(&bot->room);
+		EntityManager::killEntities();
+		EntityManager::flushEntities();
+		bot->physics.terminate();
+		Room::bind(nullptr);
+		delete bot;
+	}
+	m_bots.clear();
+}
+
+void BotHost::report(float stepSeconds)
+{
+	std::vector<float> frameTimes;
+	{
+		std::lock_guard<std::mutex> lock(m_serverMutex);
+		frameTimes.swap(m_serverFrameTimes);
+	}
+
+	int32_t numConnected = 0;
+	uint64_t bytesReceived = 0;
+	uint64_t bytesSent = 0;
+	std::vector<float> rtts;
+	for (Bot* bot : m_bots)
+	{
+		bytesReceived += bot->client.getBytesReceived();
+		bytesSent     += bot->client.getBytesSent();
+		if (bot->client.getState() == network::BotClient::State::Connected)
+		{
+			rtts.push_back(bot->client.getRtt() * 1000.0f);
+			numConnected++;
+		}
+	}
+
+	// Shared by the bots connected at the end of the step
+	const float bitsPerClient = 8.0f / (stepSeconds * std::max(1, numConnected));
+	const float kbpsIn  = (bytesReceived - m_bytesReceived) * bitsPerClient / 1000.0f;
+	const float kbpsOut = (bytesSent - m_bytesSent) * bitsPerClient / 1000.0f;
+	m_bytesReceived = bytesReceived;
+	m_bytesSent = bytesSent;
+
+	LOG_INFO("BotHost: %d/%d bots connected | server frame p50 %.3f p99 %.3f max %.3f ms | per client in %.1f out %.1f kbit/s | rtt p50 %.1f p95 %.1f p99 %.1f ms",
+		numConnected, static_cast<int32_t>(m_bots.size()),
+		getPercentile(frameTimes, 0.5f), getPercentile(frameTimes, 0.99f), getPercentile(frameTimes, 1.0f),
+		kbpsIn, kbpsOut,
+		getPercentile(rtts, 0.5f), getPercentile(rtts, 0.95f), getPercentile(rtts, 0.99f));
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <common.h>
+#include <network/address.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CommandLineOptions;
+class Game;
+class Room;
+
+/* Input the bots of a BotHost send */
+enum class BotInput : uint8_t
+{
+	Idle,       // No actions, only the traffic of a connected player
+	Scripted,   // Fires at a fixed interval, spread over the bots
+	Random      // Fires at random, seeded per bot so runs repeat
+};
+
+/* BotHost
+*  Load generator: connects an increasing number of BotClients from this
+*  process to a server, each in a Room of its own on one thread. After
+*  every step of the ramp it logs the server frame time, the bandwidth per
+*  client and the round trip time percentiles, until maxBots are connected.
+*  The server is either a headless game hosted here on a thread, or remote.
+*/
+class BotHost
+{
+public:
+	using CreateGameMethod = std::function<Game*()>;
+
+	BotHost(int32_t maxBots, int32_t botsPerStep, float stepSeconds, BotInput input);
+	~BotHost();
+
+	/** Hosts a game of createGame on a thread, its options have to make it
+	*   a dedicated server, and ramps the bots up against it over loopback
+	*   @return false when the game did not host */
+	bool runWithServer(const CreateGameMethod& createGame, const CommandLineOptions& options);
+
+	/** Ramps the bots up against the server at address */
+	void run(const network::Address& address);
+
+	/** Ends the ramp after the current frame, callable from any thread */
+	void stop();
+
+private:
+	struct Bot;
+
+	void runServer(const CreateGameMethod& createGame, const CommandLineOptions& options);
+	void addBots(int32_t numBots, const network::Address& address);
+	void removeBots();
+	void report(float stepSeconds);
+
+	int32_t  m_maxBots;
+	int32_t  m_botsPerStep;
+	float    m_stepSeconds;
+	BotInput m_input;
+
+	std::vector<Bot*> m_bots;
+	std::atomic<bool> m_isRunning;
+
+	/* Bytes all bots had received and sent at the last report */
+	uint64_t m_bytesReceived;
+	uint64_t m_bytesSent;
+
+	/* Hosted server */
+	Room*                   m_serverRoom;
+	std::thread             m_serverThread;
+	std::mutex              m_serverMutex;
+	std::condition_variable m_serverCondition;
+	bool                    m_isServerStarted;
+	bool                    m_isServerHosting;
+
+	/* Milliseconds the server frames took since the last report */
+	std::vector<float>      m_serverFrameTimes;
+};
@@ -1,9 +1,12 @@
 
 #include <core/core.h>
+#include <core/bot_host.h>
 
 #include <core/debug.h>
 #include <core/game.h>
 #include <core/resource_manager.h>
+#include <core/replay_host.h>
+#include <core/room_host.h>
 #include <core/window.h>
 #include <core/entity.h>
 #include <core/entity_manager.h>
@@ -178,6 +181,61 @@ void Core::run()
 	LOG_DEBUG("Core: main loop ended");
 }
 
+void Core::runRooms(int32_t numRooms, const std::function<Game*()>& createGame, const CommandLineOptions& options)
+{
+	crcInit();
+
+	LOG_INFO("Core: Starting %d rooms..", numRooms);
+	RoomHost roomHost(numRooms, createGame);
+	if (!roomHost.start(s_defaultServerPort, options))
+	{
+		LOG_ERROR("Core: Starting rooms has failed");
+		return;
+	}
+
+	roomHost.run();
+	roomHost.stop();
+
+	LOG_INFO("Core: Cleaning up resources..");
+	ResourceManager::clear();
+}
+
+void Core::runReplay(const std::string& path, bool isMaxSpeed, const std::function<Game*()>& createGame, 
+	const CommandLineOptions& options)
+{
+	crcInit();
+
+	LOG_INFO("Core: Replaying %s..", path.c_str());
+	ReplayHost replayHost(path, isMaxSpeed);
+	if (!replayHost.run(createGame, options))
+	{
+		LOG_ERROR("Core: Replaying %s has failed", path.c_str());
+	}
+
+	LOG_INFO("Core: Cleaning up resources..");
+	ResourceManager::clear();
+}
+
+void Core::runBots(int32_t maxBots, int32_t botsPerStep, float stepSeconds, BotInput input,
+	const network::Address* address, const std::function<Game*()>& createGame, const CommandLineOptions& options)
+{
+	crcInit();
+
+	BotHost botHost(maxBots, botsPerStep, stepSeconds, input);
+	if (address != nullptr)
+	{
+		LOG_INFO("Core: Connecting bots to %s..", address->toString().c_str());
+		botHost.run(*address);
+	}
+	else if (!botHost.runWithServer(createGame, options))
+	{
+		LOG_ERROR("Core: Hosting a server for the bots has failed");
+	}
+
+	LOG_INFO("Core: Cleaning up resources..");
+	ResourceManager::clear();
+}
+
 void Core::destroy()
 {
 	LOG_INFO("Core: Shutting down..");
@@ -187,7 +245,7 @@ void Core::destroy()
 	EntityManager::flushEntities();
 
 	LOG_INFO("Core: Terminating physics..");
-	Physics::destroyBodies();
+	m_physics->terminate();
 	delete m_physics;
 
 	LOG_INFO("Core: Cleaning up resources..");
@@ -5,6 +5,9 @@
 #include <core/input.h>
 #include <core/game_time.h>
 
+#include <functional>
+#include <string>
+
 static const Vector2i g_defaultResolution(640, 480);
 static const Vector2i g_defaultWindowSize = g_defaultResolution;
 
@@ -13,6 +16,11 @@ class Renderer;
 class Physics;
 class Window;
 class CommandLineOptions;
+enum class BotInput : uint8_t;
+
+namespace network {
+	class Address;
+}; // namespace network
 
 class Core
 {
@@ -24,6 +32,22 @@ public:
 	void run();
 	void destroy();
 
+	/** Runs numRooms headless games of createGame in this process behind
+	*   the default server port, instead of initialize, run and destroy */
+	void runRooms(int32_t numRooms, const std::function<Game*()>& createGame,
+		const CommandLineOptions& options);
+
+	/** Runs a headless game of createGame on the datagrams of the capture 
+	*   at path, as fast as it can when isMaxSpeed is set */
+	void runReplay(const std::string& path, bool isMaxSpeed, const std::function<Game*()>& createGame,
+		const CommandLineOptions& options);
+
+	/** Ramps up to maxBots headless bots of input against the server at 
+	*   address, or against a game of createGame hosted in this process 
+	*   when address is nullptr, and logs the load of every step */
+	void runBots(int32_t maxBots, int32_t botsPerStep, float stepSeconds, BotInput input, 
+		const network::Address* address, const std::function<Game*()>& createGame, const CommandLineOptions& options);
+
 private:
 	void initializeWindow(const char* name);
 	void initializeInput();
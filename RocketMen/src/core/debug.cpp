@@ -6,12 +6,14 @@
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdarg.h>
 
 static bool             s_fileOpened = false;
 static std::ofstream    s_logFile;
 static Debug::Verbosity	s_verbosityLevel = Debug::Verbosity::Info;
+static std::mutex       s_logMutex; // Network threads log as well
 // ============================================================================
 
 inline std::string verbosityToString(Debug::Verbosity verbosity)
@@ -92,9 +94,10 @@ void Debug::log(Verbosity verbosityLevel, const char* format, ...)
 	vsnprintf(buffer, 1024, format, args);
 	std::stringstream stream;
 	stream << verbosityStr << " : " << buffer << std::endl;
-	std::cout << stream.str();
 	va_end(args);
 
+	std::lock_guard<std::mutex> lock(s_logMutex);
+	std::cout << stream.str();
 	if (s_fileOpened)
 	{
 		s_logFile << stream.str();
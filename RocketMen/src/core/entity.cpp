@@ -56,7 +56,14 @@ std::string Entity::getSpriteName() const
 void Entity::setNetworkId(int32_t networkId)
 {
 	ASSERT(m_networkId <= INDEX_NONE, "NetworkId cannot be changed once set");
+	EntityManager::unlinkNetworkId(this);
 	m_networkId = networkId;
+
+	// Entities not yet instantiated are linked by EntityManager::instantiateEntity
+	if (isAlive())
+	{
+		EntityManager::linkNetworkId(this);
+	}
 }
 
 int32_t Entity::getNetworkId() const
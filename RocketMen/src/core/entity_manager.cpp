@@ -7,20 +7,18 @@
 #include <utility/buffer.h>
 #include <core/entity.h>
 #include <core/entity_factory.h>
+#include <core/room.h>
 #include <network/network.h>
 #include <utility/id_manager.h>
 #include <map>
 
+// Factories are stateless and shared by every room
 static IEntityFactory* s_factories[static_cast<int32_t>(EntityType::NUM_ENTITY_TYPES)];
-static std::vector<Entity*> s_entities;
-static std::vector<Entity*> s_newEntities;
-static IdManager s_entityIds(s_maxEntities);
-static Game* s_gameInstance;
 
 inline bool isReplicated(Entity* entity)
 {
 	ASSERT(entity != nullptr);
-	for (const auto& ent : s_entities)
+	for (const auto& ent : EntityManager::getEntities())
 	{
 		if (ent == entity)
 			return true;
@@ -44,10 +42,13 @@ void EntityManager::instantiateEntity(Entity* entity, bool enableReplication)
 {
 	ASSERT(entity != nullptr);
 	ASSERT(!isReplicated(entity));
-	ASSERT(s_entityIds.hasIdsAvailable(), "Ran out of Entity Ids");
 
-	entity->m_id = s_entityIds.getNext();
-	s_newEntities.push_back(entity);
+	Room* room = Room::getCurrent();
+	ASSERT(room->m_entityIds.hasIdsAvailable(), "Ran out of Entity Ids");
+
+	entity->m_id = room->m_entityIds.getNext();
+	room->m_newEntities.push_back(entity);
+	linkNetworkId(entity);
 
 	if (enableReplication && entity->getNetworkId() == INDEX_NONE)
 	{
@@ -157,12 +158,15 @@ bool EntityManager::serializeEntity(Entity* entity, MeasureStream& stream)
 
 void EntityManager::flushEntities()
 {
-	for (auto it = s_entities.begin(); it != s_entities.end();)
+	std::vector<Entity*>& entities    = Room::getCurrent()->m_entities;
+	std::vector<Entity*>& newEntities = Room::getCurrent()->m_newEntities;
+	for (auto it = entities.begin(); it != entities.end();)
 	{
 		if ((*it)->isAlive() == false)
 		{
+			unlinkNetworkId(*it);
 			delete (*it);
-			it = s_entities.erase(it);
+			it = entities.erase(it);
 		}
 		else
 		{
@@ -170,27 +174,36 @@ void EntityManager::flushEntities()
 		}
 	}
 
-	for (auto it : s_newEntities)
+	for (auto it : newEntities)
 	{
-		s_entities.push_back(it);
+		entities.push_back(it);
 	}
-	s_newEntities.clear();
+	newEntities.clear();
 }
 
 void EntityManager::killEntities()
 { 
-	for (auto it = s_entities.begin(); it != s_entities.end();)
+	Room* room = Room::getCurrent();
+	for (auto it = room->m_entities.begin(); it != room->m_entities.end();)
 	{
+		unlinkNetworkId(*it);
 		delete (*it);
-		it = s_entities.erase(it);
+		it = room->m_entities.erase(it);
 	}
 
-	s_entityIds.clear();
+	room->m_entityIds.clear();
 }
 
 Entity* EntityManager::findNetworkedEntity(int32_t networkId)
 {
-	for (Entity* entity : s_newEntities)
+	Room* room = Room::getCurrent();
+	if (networkId >= 0)
+	{
+		return (networkId < s_maxNetworkedEntities) ? room->m_networkedEntities[networkId] : nullptr;
+	}
+
+	// Spawn predictions use temporary negative ids and are few, search them
+	for (Entity* entity : room->m_newEntities)
 	{
 		if (entity->getNetworkId() == networkId)
 		{
@@ -198,7 +211,7 @@ Entity* EntityManager::findNetworkedEntity(int32_t networkId)
 		}
 	}
 
-	for (Entity* entity : s_entities)
+	for (Entity* entity : room->m_entities)
 	{
 		if (entity->getNetworkId() == networkId)
 		{
@@ -211,20 +224,44 @@ Entity* EntityManager::findNetworkedEntity(int32_t networkId)
 
 void EntityManager::freeEntityId(int32_t id)
 {
-	s_entityIds.remove(id);
+	Room::getCurrent()->m_entityIds.remove(id);
+}
+
+void EntityManager::linkNetworkId(Entity* entity)
+{
+	ASSERT(entity != nullptr);
+	const int32_t networkId = entity->getNetworkId();
+	if (networkId >= 0 && networkId < s_maxNetworkedEntities)
+	{
+		Room::getCurrent()->m_networkedEntities[networkId] = entity;
+	}
+}
+
+void EntityManager::unlinkNetworkId(Entity* entity)
+{
+	ASSERT(entity != nullptr);
+	const int32_t networkId = entity->getNetworkId();
+
+	// The id may already be reused by an entity spawned before this one was flushed
+	Entity** networkedEntities = Room::getCurrent()->m_networkedEntities;
+	if (networkId >= 0 && networkId < s_maxNetworkedEntities
+		&& networkedEntities[networkId] == entity)
+	{
+		networkedEntities[networkId] = nullptr;
+	}
 }
 
 void EntityManager::setGameInstance(Game* game)
 {
-	s_gameInstance = game;
+	Room::getCurrent()->m_game = game;
 }
 
 Game* EntityManager::getGame()
 {
-	return s_gameInstance;
+	return Room::getCurrent()->m_game;
 }
 
 std::vector<Entity*>& EntityManager::getEntities()
 {
-	return s_entities;
+	return Room::getCurrent()->m_entities;
 }
@@ -13,6 +13,7 @@ static const int16_t  s_firstTempNetworkId = -2; // Reserve -1 for INDEX_NONE
 //=============================================================================
 class Entity;
 
+/* Entities of the Room bound to the calling thread */
 class EntityManager
 {
 public:
@@ -40,12 +41,15 @@ public:
 	static void flushEntities();
 	static void killEntities();
 
+	/* @return entity with the given NetworkId, including entities not yet flushed */
 	static Entity* findNetworkedEntity(int32_t networkId);
 
 	static std::vector<Entity*>& getEntities();
 
 private:
 	static void freeEntityId(int32_t id);
+	static void linkNetworkId(Entity* entity);
+	static void unlinkNetworkId(Entity* entity);
 	static void setGameInstance(class Game* game);
 	static class Game* getGame();
 
@@ -62,12 +62,18 @@ void Game::tick(float fixedDeltaTime, Sequence frameCounter, Physics* physics)
 
 	if (m_server)
 	{
+		m_server->tick(frameCounter);
+
 		if (GameState* state = m_stateMachine.getState())
 		{
 			state->tick(this, fixedDeltaTime);
 		}
 		physics->step(fixedDeltaTime);
 	}
+	else if (m_client)
+	{
+		m_client->predict(fixedDeltaTime, physics);
+	}
 }
 
 void Game::terminate()
@@ -26,6 +26,14 @@ void Time::update()
 	m_tickCount++;
 }
 
+void Time::advance(uint64_t microseconds)
+{
+	m_deltaTimeMicroSeconds = microseconds;
+	m_deltaTimeSeconds = static_cast<float>(m_deltaTimeMicroSeconds * 0.000001f);
+	updateBy(m_deltaTimeMicroSeconds);
+	m_tickCount++;
+}
+
 void Time::updateBy(uint64_t time)
 {
 	m_runTimeMicroSeconds += time;
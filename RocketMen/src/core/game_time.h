@@ -17,6 +17,12 @@ public:
 	/** Update the game clock */
 	void update();
 
+	/** Update the game clock by a fixed step instead of the elapsed time,
+	*	for frames that must not depend on how fast they run
+	*	@param	microseconds	Step in microseconds
+	*/
+	void advance(uint64_t microseconds);
+
 	/** Returns the total elapsed time in seconds */
 	float getSeconds() const;
 
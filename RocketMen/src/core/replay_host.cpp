@@ -0,0 +1,96 @@
+#include "replay_host.h"
+
+#include <core/debug.h>
+#include <core/entity_manager.h>
+#include <core/game.h>
+#include <core/game_time.h>
+#include <core/room.h>
+#include <core/room_host.h>
+#include <physics/physics.h>
+
+#include <chrono>
+#include <thread>
+
+/* Frames run after the last datagram, so the game handles what it received */
+static const int32_t s_numFramesAfterEnd = 8;
+
+ReplayHost::ReplayHost(const std::string& path, bool isMaxSpeed) :
+	m_path(path),
+	m_isMaxSpeed(isMaxSpeed)
+{
+}
+
+bool ReplayHost::run(const CreateGameMethod& createGame, const CommandLineOptions& options)
+{
+	ASSERT(createGame);
+
+	Room room(0);
+	room.setSocketFactory([this]() -> network::Socket* {
+		return new network::ReplaySocket(m_path, &m_clock);
+	});
+	Room::bind(&room);
+
+	Physics physics;
+	physics.initialize();
+
+	Game* game = createGame();
+	const GameContext context = { options, nullptr };
+	game->initialize(context);
+
+	const bool isReplaying = m_clock.numOpened > 0;
+	if (!isReplaying)
+	{
+		LOG_ERROR("ReplayHost: The game opened no socket on %s, host or join a session to replay it", m_path.c_str());
+	}
+
+	Time time;
+	float accumulator = 0.0f;
+	Sequence frameCounter = 0;
+	uint64_t numFrames = 0;
+	int32_t numFramesAfterEnd = s_numFramesAfterEnd;
+	const auto startTime = std::chrono::steady_clock::now();
+
+	while (isReplaying && numFramesAfterEnd > 0)
+	{
+		if (m_isMaxSpeed)
+		{
+			time.advance(game->getTimestep());
+		}
+		else
+		{
+			time.update();
+		}
+		m_clock.time = time.getMicroSeconds();
+
+		const float timeToNextTick = RoomHost::runFrame(game, physics, time, accumulator, frameCounter);
+		numFrames++;
+
+		if (m_clock.numFinished >= m_clock.numOpened)
+		{
+			numFramesAfterEnd--;
+		}
+
+		if (!m_isMaxSpeed)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(timeToNextTick * 1000000.0f)));
+		}
+	}
+
+	if (isReplaying)
+	{
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+		LOG_INFO("ReplayHost: Replayed %.3f seconds of %s in %llu frames, %.3f seconds",
+			time.getMicroSeconds() / 1000000.0, m_path.c_str(),
+			static_cast<unsigned long long>(numFrames), elapsed.count());
+	}
+
+	game->leaveSession();
+	EntityManager::flushEntities();
+	EntityManager::killEntities();
+	physics.terminate();
+	game->terminate();
+	delete game;
+
+	Room::bind(nullptr);
+	return isReplaying;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <common.h>
+#include <network/replay_socket.h>
+
+#include <functional>
+#include <string>
+
+class CommandLineOptions;
+class Game;
+
+/* ReplayHost
+*  Runs one headless game in a Room whose sockets receive the datagrams of
+*  a capture instead of the network; its options decide whether the game 
+*  hosts or joins. At the recorded speed frames follow the wall clock. At
+*  maximum speed every frame moves the clock by one timestep without 
+*  waiting, so each run of a capture ticks through the same datagrams.
+*/
+class ReplayHost
+{
+public:
+	using CreateGameMethod = std::function<Game*()>;
+
+	ReplayHost(const std::string& path, bool isMaxSpeed);
+
+	/** Runs a game of createGame until every socket it opened on the capture is done
+	*   @return false when the game opened no socket on the capture */
+	bool run(const CreateGameMethod& createGame, const CommandLineOptions& options);
+
+private:
+	std::string          m_path;
+	bool                 m_isMaxSpeed;
+	network::ReplayClock m_clock;
+};
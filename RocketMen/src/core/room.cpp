@@ -0,0 +1,49 @@
+#include "room.h"
+
+#include <core/debug.h>
+
+#include <algorithm>
+
+static thread_local Room* s_currentRoom = nullptr;
+
+static Room& getProcessRoom()
+{
+	static Room processRoom;
+	return processRoom;
+}
+
+Room::Room(int32_t id) :
+	m_id(id),
+	m_entityIds(s_maxEntities),
+	m_game(nullptr),
+	m_physicsWorld(nullptr),
+	m_client(nullptr),
+	m_server(nullptr)
+{
+	std::fill(m_networkedEntities, m_networkedEntities + s_maxNetworkedEntities, nullptr);
+}
+
+Room::~Room()
+{
+	ASSERT(m_physicsWorld == nullptr, "Room destroyed before Physics::destroyWorld");
+}
+
+Room* Room::getCurrent()
+{
+	return s_currentRoom != nullptr ? s_currentRoom : &getProcessRoom();
+}
+
+void Room::bind(Room* room)
+{
+	s_currentRoom = room;
+}
+
+void Room::setSocketFactory(const CreateSocketMethod& createSocket)
+{
+	m_createSocket = createSocket;
+}
+
+network::Socket* Room::createSocket()
+{
+	return m_createSocket ? m_createSocket() : nullptr;
+}
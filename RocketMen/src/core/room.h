@@ -0,0 +1,82 @@
+#pragma once
+
+#include <common.h>
+#include <core/entity_manager.h>
+#include <utility/id_manager.h>
+
+#include <functional>
+#include <vector>
+
+class ActionListener;
+class Entity;
+class Game;
+struct PhysicsWorld;
+
+namespace network {
+	class LocalClient;
+	class Server;
+	class Socket;
+}; // namespace network
+
+/* Room
+*  State of one match: its entities, physics world, action listeners and
+*  network session. EntityManager, Physics, ActionListener and Network act
+*  on the room bound to the calling thread, which is the process room
+*  unless a room thread bound its own.
+*/
+class Room
+{
+public:
+	Room(int32_t id = 0);
+	~Room();
+
+	int32_t getId() const { return m_id; }
+
+	/** @return the room bound to the calling thread */
+	static Room* getCurrent();
+
+	/** Binds room to the calling thread, nullptr binds the process room */
+	static void bind(Room* room);
+
+	using CreateSocketMethod = std::function<network::Socket*()>;
+
+	/** The room's Server and LocalClient take their socket from createSocket
+	*   instead of opening their own, e.g. a socket shared by several rooms */
+	void setSocketFactory(const CreateSocketMethod& createSocket);
+
+	/** @return socket for the room's Server or LocalClient, nullptr when they open their own */
+	network::Socket* createSocket();
+
+	/* Box2D world and bodies, created by Physics::initialize */
+	PhysicsWorld* getPhysicsWorld() const { return m_physicsWorld; }
+
+private:
+	Room(const Room&) = delete;
+	Room& operator=(const Room&) = delete;
+
+	int32_t m_id;
+
+	// EntityManager
+	std::vector<Entity*> m_entities;
+	std::vector<Entity*> m_newEntities;
+	IdManager            m_entityIds;
+	Entity*              m_networkedEntities[s_maxNetworkedEntities];
+	Game*                m_game;
+
+	// Physics
+	PhysicsWorld* m_physicsWorld;
+
+	// ActionListener
+	std::vector<ActionListener*> m_actionListeners;
+
+	// Network
+	network::LocalClient*  m_client;
+	network::Server*       m_server;
+	CreateSocketMethod     m_createSocket;
+
+public:
+	friend class ActionListener;
+	friend class EntityManager;
+	friend class Network;
+	friend class Physics;
+};
@@ -0,0 +1,161 @@
+#include "room_host.h"
+
+#include <core/debug.h>
+#include <core/entity.h>
+#include <core/entity_manager.h>
+#include <core/game.h>
+#include <core/game_time.h>
+#include <core/room.h>
+#include <network/datagram_capture.h>
+#include <physics/physics.h>
+
+#include <algorithm>
+#include <chrono>
+
+/* Longest a room frame may catch up on, as in Core::run */
+static const float   s_maxFrameTime     = 0.25f;
+static const int32_t s_receiveTimeoutMs = 10;
+
+RoomHost::RoomHost(int32_t numRooms, const CreateGameMethod& createGame) :
+	m_createGame(createGame),
+	m_isRunning(false),
+	m_numRoomsStarted(0)
+{
+	ASSERT(numRooms > 0);
+	ASSERT(createGame);
+	for (int32_t i = 0; i < numRooms; i++)
+	{
+		Room* room = new Room(i);
+		room->setSocketFactory([this, i]() -> network::Socket* {
+			return new network::RoomSocket(&m_socket, i);
+		});
+		m_rooms.push_back(room);
+	}
+}
+
+RoomHost::~RoomHost()
+{
+	stop();
+	for (Room* room : m_rooms)
+	{
+		delete room;
+	}
+}
+
+bool RoomHost::start(uint16_t port, const CommandLineOptions& options)
+{
+	ASSERT(!m_isRunning, "RoomHost is already started");
+	if (!m_socket.initialize(port))
+	{
+		return false;
+	}
+
+	m_isRunning = true;
+	for (Room* room : m_rooms)
+	{
+		m_threads.emplace_back(&RoomHost::runRoom, this, room, std::cref(options));
+
+		const int32_t numStarted = static_cast<int32_t>(m_threads.size());
+		std::unique_lock<std::mutex> lock(m_startMutex);
+		m_startCondition.wait(lock, [this, numStarted]() { return m_numRoomsStarted == numStarted; });
+	}
+
+	LOG_INFO("RoomHost: %d rooms running on port %d", getNumRooms(), port);
+	if (getNumRooms() > 1 && network::DatagramCapture::getActive())
+	{
+		LOG_WARNING("RoomHost: The rooms share one socket, this capture cannot be replayed");
+	}
+	return true;
+}
+
+void RoomHost::run()
+{
+	while (m_isRunning)
+	{
+		m_socket.update(s_receiveTimeoutMs);
+	}
+}
+
+void RoomHost::stop()
+{
+	m_isRunning = false;
+	for (std::thread& thread : m_threads)
+	{
+		if (thread.joinable() && thread.get_id() != std::this_thread::get_id())
+		{
+			thread.join();
+		}
+	}
+	m_threads.clear();
+}
+
+float RoomHost::runFrame(Game* game, Physics& physics, const Time& time, float& accumulator, Sequence& frameCounter)
+{
+	const float deltaTime = time.getDeltaSeconds();
+	const float fixedDeltaTime = game->getTimestep() / 1000000.0f;
+	game->update(time);
+
+	for (Entity* entity : EntityManager::getEntities())
+	{
+		entity->update(deltaTime);
+	}
+
+	if (game->isSessionActive())
+	{
+		accumulator += std::min(deltaTime, s_maxFrameTime);
+		while (accumulator >= fixedDeltaTime)
+		{
+			game->tick(fixedDeltaTime, frameCounter, &physics);
+			accumulator -= fixedDeltaTime;
+			frameCounter++;
+		}
+	}
+	else
+	{
+		accumulator = 0.0f;
+	}
+
+	EntityManager::flushEntities();
+	return fixedDeltaTime - accumulator;
+}
+
+void RoomHost::runRoom(Room* room, const CommandLineOptions& options)
+{
+	Room::bind(room);
+
+	Physics physics;
+	physics.initialize();
+
+	Game* game = m_createGame();
+	const GameContext context = { options, nullptr };
+	game->initialize(context);
+
+	{
+		std::lock_guard<std::mutex> lock(m_startMutex);
+		m_numRoomsStarted++;
+	}
+	m_startCondition.notify_one();
+
+	Time time;
+	float accumulator = 0.0f;
+	Sequence frameCounter = 0;
+
+	while (m_isRunning)
+	{
+		time.update();
+
+		// Unlike a client a room has nothing to show between ticks, it sleeps until the next
+		const float timeToNextTick = runFrame(game, physics, time, accumulator, frameCounter);
+		std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(timeToNextTick * 1000000.0f)));
+	}
+
+	LOG_INFO("RoomHost: Stopping room %d", room->getId());
+	game->leaveSession();
+	EntityManager::flushEntities();
+	EntityManager::killEntities();
+	physics.terminate();
+	game->terminate();
+	delete game;
+
+	Room::bind(nullptr);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <common.h>
+#include <network/room_socket.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CommandLineOptions;
+class Game;
+class Physics;
+class Room;
+class Time;
+
+/* RoomHost
+*  Runs several headless games in one process, each in a Room of its own
+*  on a thread of its own, behind one SharedSocket. Rooms are started one
+*  at a time, so the resources they load are shared read-only once running.
+*/
+class RoomHost
+{
+public:
+	using CreateGameMethod = std::function<Game*()>;
+
+	RoomHost(int32_t numRooms, const CreateGameMethod& createGame);
+	~RoomHost();
+
+	/** Opens the shared socket on port and starts every room
+	*   @return false when the socket could not be opened */
+	bool start(uint16_t port, const CommandLineOptions& options);
+
+	/** Routes datagrams to the rooms until stop() is called */
+	void run();
+
+	/** Stops routing and joins the room threads, callable from any thread */
+	void stop();
+
+	int32_t getNumRooms() const { return static_cast<int32_t>(m_rooms.size()); }
+
+	/** Updates game and its entities by time and runs the ticks that are due
+	*   @return seconds until the next tick is due */
+	static float runFrame(Game* game, Physics& physics, const Time& time, float& accumulator, Sequence& frameCounter);
+
+private:
+	void runRoom(Room* room, const CommandLineOptions& options);
+
+	CreateGameMethod         m_createGame;
+	network::SharedSocket    m_socket;
+	std::vector<Room*>       m_rooms;
+	std::vector<std::thread> m_threads;
+	std::atomic<bool>        m_isRunning;
+
+	/* Rooms done with Game::initialize */
+	std::mutex               m_startMutex;
+	std::condition_variable  m_startCondition;
+	int32_t                  m_numRoomsStarted;
+};
@@ -150,6 +150,11 @@ void Transform2D::setRigidbody(Rigidbody* rigidbody)
 	}
 }
 
+Rigidbody* Transform2D::getRigidbody() const
+{
+	return m_rigidbody;
+}
+
 void Transform2D::updateLocalMatrix()
 {
 	m_isDirty = false;
@@ -3,6 +3,7 @@
 
 #include <common.h>
 #include <core/debug.h>
+#include <network/quantization.h>
 #include <physics/rigidbody.h>
 
 class Transform2D
@@ -32,6 +33,7 @@ public:
 	bool isDirty() const;
 
 	void setRigidbody(Rigidbody* rigidBody);
+	Rigidbody* getRigidbody() const;
 
 private:
 	void updateLocalMatrix();
@@ -48,24 +50,31 @@ private:
 public:
 	/** Serialize complete object */
 	template<typename Stream>
-	bool serializeFull(Stream& stream);
+	bool serializeFull(Stream& stream, const network::QuantizationPolicy& policy);
 
-	/** Serialize commonly updated variables */
+	/** Serialize commonly updated variables
+	*   @param policy  Fields to write and their precision, per EntityType */
 	template<typename Stream>
-	bool serialize(Stream& stream);
+	bool serialize(Stream& stream, const network::QuantizationPolicy& policy);
 };
 
 template<typename Stream>
-inline bool Transform2D::serializeFull(Stream& stream)
+inline bool Transform2D::serializeFull(Stream& stream, const network::QuantizationPolicy& policy)
 {
-	return serialize(stream);
+	return serialize(stream, policy);
 }
 
 template<typename Stream>
-inline bool Transform2D::serialize(Stream& stream)
+inline bool Transform2D::serialize(Stream& stream, const network::QuantizationPolicy& policy)
 {
 	Vector2 position = getLocalPosition();
-	if (!serializeVector2(stream, position))
+	if (!network::Quantization::serializePosition(stream, position, policy))
+	{
+		return false;
+	}
+
+	float angle = getLocalRotation();
+	if (!network::Quantization::serializeRotation(stream, angle, policy))
 	{
 		return false;
 	}
@@ -73,6 +82,10 @@ inline bool Transform2D::serialize(Stream& stream)
 	if (Stream::isReading)
 	{
 		setLocalPosition(position);
+		if (policy.rotation != network::FieldPolicy::Skip)
+		{
+			setLocalRotation(angle);
+		}
 	}
 	
 	//bool hasRigidbody = m_rigidbody != nullptr;
@@ -16,6 +16,7 @@
 #ifndef _crc_h
 #define _crc_h
 
+#include <stdint.h>
 
 #define FALSE	0
 #define TRUE	!FALSE
@@ -52,7 +53,8 @@ typedef unsigned short  crc;
 
 #elif defined(CRC32)
 
-typedef unsigned long  crc;
+/* unsigned long is 64 bits wide on LP64 platforms */
+typedef uint32_t  crc;
 
 #define CRC_NAME			"CRC-32"
 #define POLYNOMIAL			0x04C11DB7
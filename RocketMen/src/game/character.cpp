@@ -74,8 +74,25 @@ bool Character::Fire()
 
 	if (Network::isServer())
 	{
+		Vector2 pos = m_transform.getWorldPosition() + m_aimDirection * 0.20f;
+
+		// The player fired at a world they saw some time ago, the rocket covers that
+		// time at once against the world as it was then
+		const float lagCompensation = Network::getLagCompensation();
+		if (lagCompensation > 0.0f)
+		{
+			const Vector2 end = pos + m_aimDirection * power * lagCompensation;
+			Vector2 hitPoint;
+			Entity* hitEntity = nullptr;
+			if (Physics::raycast(pos, end, hitPoint, hitEntity, this))
+			{
+				Rocket::explode(hitPoint);
+				return false;
+			}
+			pos = end;
+		}
+
 		Rocket* rocket = new Rocket();
-		const Vector2 pos = m_transform.getWorldPosition() + m_aimDirection * 0.20f;
 		rocket->getTransform().setLocalPosition(pos);
 		rocket->initialize(this, m_aimDirection, power);
 		Entity::instantiate(rocket);
@@ -145,7 +162,13 @@ bool Character::serialize(Stream& stream)
 {
 	serializeCheck(stream, "begin_character");
 
-	if (!m_transform.serialize(stream))
+	if (!m_transform.serialize(stream, network::Quantization::getPolicy(s_type)))
+	{
+		return false;
+	}
+
+	// Clients replay their own Character from the server's velocity
+	if (!m_rigidbody->serialize(stream, network::Quantization::getPolicy(s_type)))
 	{
 		return false;
 	}
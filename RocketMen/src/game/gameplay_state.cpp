@@ -11,6 +11,7 @@
 #include <game/rocket.h>
 #include <game/rocketmen_game.h>
 #include <graphics/camera.h>
+#include <graphics/tilemap.h>
 #include <network/network.h>
 #include <physics/physics.h>
 
@@ -23,9 +24,20 @@ void GameplayState::initialize(Game* /*game*/)
 
 	ResourceManager::loadTexture("data/textures/square.png", "demoTexture");
 	ResourceManager::loadTexture("data/textures/tilesheet.png", "tilesheet");
-	ResourceManager::loadTilemap("data/testmap.16x16.csv", "tilesheet", defaultMapName);
+	Tilemap* tilemap = ResourceManager::loadTilemap("data/testmap.16x16.csv", "tilesheet", defaultMapName);
 	Physics::loadCollisionFromTilemap(defaultMapName);
 
+	// Both ends range replicated positions by the same map
+	if (tilemap != nullptr)
+	{
+		network::Quantization::setWorldBounds(tilemap->getMapWidth(), tilemap->getMapHeight());
+	}
+
+	if (Network::isServer() && tilemap != nullptr)
+	{
+		Network::setInterestArea(tilemap->getMapWidth(), tilemap->getMapHeight());
+	}
+
 	if (Network::isClient())
 	{
 		Network::addLocalPlayer(Controller::MouseAndKeyboard);
@@ -9,6 +9,8 @@
 #include <network/network.h>
 #include <utility/commandline_options.h>
 
+#include <algorithm>
+
 using namespace rm;
 using namespace std::placeholders;
 
@@ -85,6 +87,24 @@ void MenuState::parseCommandLineOptions(Game* game, const CommandLineOptions& op
 	else if (options.isSet("--dedicated"))
 	{
 		host(game);
+
+		auto args = options.getArgs("--max-clients");
+		if (args.size() == 1)
+		{
+			Network::setMaxClients(std::max(1, atoi(args[0].c_str())));
+		}
+	}
+	else if (options.isSet("--join"))
+	{
+		auto args = options.getArgs("--join");
+		if (args.empty() || args.size() > 2)
+		{
+			LOG_ERROR("--join requires an address and accepts a port");
+			return;
+		}
+
+		const uint16_t port = (args.size() == 2) ? static_cast<uint16_t>(atoi(args[1].c_str())) : s_defaultServerPort;
+		join(game, network::Address(args[0].c_str(), port));
 	}
 }
 
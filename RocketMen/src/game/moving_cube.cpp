@@ -70,7 +70,7 @@ template<typename Stream>
 inline bool MovingCube::serialize(Stream& stream)
 {
 	serializeCheck(stream, "begin_moving_cube");
-	if (!m_transform.serialize(stream))
+	if (!m_transform.serialize(stream, network::Quantization::getPolicy(s_type)))
 	{
 		return false;
 	}
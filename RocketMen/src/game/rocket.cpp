@@ -43,6 +43,11 @@ void Rocket::initialize(Entity* owner, const Vector2& direction, float power)
 	m_isInitialized = true;
 }
 
+void Rocket::explode(const Vector2& position)
+{
+	Physics::blastExplosion(position, 3.f, 200.f);
+}
+
 void Rocket::update(float /*deltaTime*/)
 {
 
@@ -92,7 +97,7 @@ void Rocket::startContact(Entity* other)
 	{
 		if (Network::isServer())
 		{
-			Physics::blastExplosion(m_rigidbody->getPosition(), 3.f, 200.f);
+			explode(m_rigidbody->getPosition());
 			kill();
 		}
 	}
@@ -123,9 +128,7 @@ bool Rocket::serializeFull(Stream& stream)
 		if (ownerId >= s_maxNetworkedEntities || ownerId < 0)
 			return false;
 
-		auto& entityList = EntityManager::getEntities();
-		m_owner = findPtrByPredicate(entityList.begin(), entityList.end(),
-			[ownerId](Entity* entity) -> bool { return entity->getNetworkId() == ownerId; });
+		m_owner = EntityManager::findNetworkedEntity(ownerId);
 	}
 	
 	if (!serializeFloat(stream, m_accelerationPower))
@@ -147,7 +150,7 @@ bool Rocket::serializeFull(Stream& stream)
 template<typename Stream>
 bool Rocket::serialize(Stream& stream)
 {	
-	if (!m_transform.serialize(stream))
+	if (!m_transform.serialize(stream, network::Quantization::getPolicy(s_type)))
 		return false;
 
 	return true;
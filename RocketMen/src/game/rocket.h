@@ -17,6 +17,9 @@ namespace rm
 
 		void initialize(Entity* owner, const Vector2& direction, float power);
 
+		/** Blast pushing nearby bodies away, what a Rocket does on impact */
+		static void explode(const Vector2& position);
+
 		virtual void update(float deltaTime)      override;
 		virtual void fixedUpdate(float deltaTime) override;
 
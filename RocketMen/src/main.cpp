@@ -2,12 +2,17 @@
 #define RM_RUN_TESTS 1
 
 #include <utility/bitstream.h>
+#include <core/bot_host.h>
 #include <core/core.h>
 #include <core/debug.h>
 #include <game/rocketmen_game.h>
 #include <network/address.h>
+#include <network/datagram_capture.h>
+#include <network/network.h>
+#include <network/packet_coder.h>
 #include <utility/utility.h>
 #include <utility/commandline_options.h>
+#include <utility/metrics.h>
 
 #include <algorithm>
 #include <cstring>
@@ -18,6 +23,10 @@ extern bool testSerialization();
 
 static void initializeVerbosityLevel(const CommandLineOptions& options);
 static void initializeLog(const CommandLineOptions& options);
+static int32_t getNumRooms(const CommandLineOptions& options);
+static void initializeMetrics(const CommandLineOptions& options);
+static void initializeCapture(const CommandLineOptions& options);
+static void runBots(Core& core, const CommandLineOptions& options);
 
 int main(int argc, char *argv[])
 {
@@ -26,6 +35,15 @@ int main(int argc, char *argv[])
 	options.registerOption("-l", "--listen");
 	options.registerOption("-v", "--verbosity");
 	options.registerOption("-o", "--output");
+	options.registerOption("-r", "--rooms");
+	options.registerOption("-c", "--max-clients");
+	options.registerOption("-m", "--metrics");
+	options.registerOption("-j", "--join");
+	options.registerOption("-p", "--capture");
+	options.registerOption("-y", "--replay");
+	options.registerOption("-b", "--bots");
+	options.registerOption("-i", "--bot-input");
+	options.registerOption("-z", "--packet-coding");
 	options.parse(argc, argv);
 
 	initializeLog(options);
@@ -42,14 +60,47 @@ int main(int argc, char *argv[])
 	}
 #endif
 
+	initializeMetrics(options);
+	initializeCapture(options);
+	network::PacketCoder::setEnabled(options.isSet("--packet-coding"));
+
 	Core core;
-	Game* game = new rm::RocketMenGame();
+	const int32_t numRooms = getNumRooms(options);
+	if (options.isSet("--replay"))
+	{
+		// Replays at the recorded speed unless max is passed after the file
+		auto args = options.getArgs("--replay");
+		if (args.empty() || args.size() > 2)
+		{
+			LOG_ERROR("--replay requires a capture file and accepts max");
+		}
+		else
+		{
+			const bool isMaxSpeed = args.size() == 2 && args[1] == "max";
+			core.runReplay(args[0], isMaxSpeed, []() -> Game* { return new rm::RocketMenGame(); }, options);
+		}
+	}
+	else if (options.isSet("--bots"))
+	{
+		runBots(core, options);
+	}
+	else if (numRooms > 1)
+	{
+		core.runRooms(numRooms, []() -> Game* { return new rm::RocketMenGame(); }, options);
+	}
+	else
+	{
+		Game* game = new rm::RocketMenGame();
 
-	core.initialize(game, options);
-	core.run();
-	core.destroy();
+		core.initialize(game, options);
+		core.run();
+		core.destroy();
+
+		delete game;
+	}
 
-	delete game;
+	network::DatagramCapture::stop();
+	Metrics::stopExport();
 
 	LOG_INFO("Application has ended succesfully, closing logfile..");
 	Debug::closeLog();
@@ -76,6 +127,107 @@ void initializeLog(const CommandLineOptions& options)
 	Debug::openLog(fileName.c_str());
 }
 
+int32_t getNumRooms(const CommandLineOptions& options)
+{
+	if (!options.isSet("--rooms"))
+	{
+		return 1;
+	}
+
+	auto args = options.getArgs("--rooms");
+	if (args.size() != 1 || !options.isSet("--dedicated"))
+	{
+		LOG_ERROR("--rooms requires --dedicated and accepts only 1 argument");
+		return 1;
+	}
+
+	return std::max(1, atoi(args[0].c_str()));
+}
+
+void initializeMetrics(const CommandLineOptions& options)
+{
+	if (!options.isSet("--metrics"))
+	{
+		return;
+	}
+
+	// Prometheus text unless the file is named .json
+	auto args = options.getArgs("--metrics");
+	if (args.empty() || args.size() > 2)
+	{
+		LOG_ERROR("--metrics requires a file and accepts an interval in seconds");
+		return;
+	}
+
+	const std::string& path = args[0];
+	const bool isJson = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+	const float interval = (args.size() == 2) ? std::max(1.0f, static_cast<float>(atof(args[1].c_str()))) : 10.0f;
+	Metrics::startExport(path, isJson ? MetricsFormat::Json : MetricsFormat::Prometheus, interval);
+}
+
+void initializeCapture(const CommandLineOptions& options)
+{
+	if (!options.isSet("--capture"))
+	{
+		return;
+	}
+
+	auto args = options.getArgs("--capture");
+	if (args.size() != 1 || options.isSet("--replay"))
+	{
+		LOG_ERROR("--capture requires and accepts only 1 argument, and cannot be used with --replay");
+		return;
+	}
+
+	network::DatagramCapture::start(args[0]);
+}
+
+void runBots(Core& core, const CommandLineOptions& options)
+{
+	// Ramps up by a tenth of the bots every 10 seconds unless told otherwise
+	auto args = options.getArgs("--bots");
+	if (args.empty() || args.size() > 3 || (!options.isSet("--dedicated") && !options.isSet("--join")))
+	{
+		LOG_ERROR("--bots requires a number of bots and --dedicated or --join, and accepts bots per step and seconds per step");
+		return;
+	}
+
+	const int32_t maxBots = std::max(1, atoi(args[0].c_str()));
+	const int32_t botsPerStep = (args.size() >= 2) ? std::max(1, atoi(args[1].c_str())) : std::max(1, maxBots / 10);
+	const float stepSeconds = (args.size() == 3) ? std::max(1.0f, static_cast<float>(atof(args[2].c_str()))) : 10.0f;
+
+	BotInput input = BotInput::Random;
+	auto inputArgs = options.getArgs("--bot-input");
+	if (inputArgs.size() == 1)
+	{
+		if (inputArgs[0] == "idle")
+		{
+			input = BotInput::Idle;
+		}
+		else if (inputArgs[0] == "scripted")
+		{
+			input = BotInput::Scripted;
+		}
+		else if (inputArgs[0] != "random")
+		{
+			LOG_ERROR("--bot-input accepts idle, scripted or random");
+		}
+	}
+
+	auto createGame = []() -> Game* { return new rm::RocketMenGame(); };
+	auto joinArgs = options.getArgs("--join");
+	if (options.isSet("--join") && !joinArgs.empty())
+	{
+		const uint16_t port = (joinArgs.size() == 2) ? static_cast<uint16_t>(atoi(joinArgs[1].c_str())) : s_defaultServerPort;
+		const network::Address address(joinArgs[0].c_str(), port);
+		core.runBots(maxBots, botsPerStep, stepSeconds, input, &address, createGame, options);
+	}
+	else
+	{
+		core.runBots(maxBots, botsPerStep, stepSeconds, input, nullptr, createGame, options);
+	}
+}
+
 #ifdef _DEBUG
 void initializeVerbosityLevel(const CommandLineOptions& /*options*/)
 #else
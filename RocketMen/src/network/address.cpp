@@ -1,6 +1,14 @@
 
 #include "address.h"
 
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+	#define _strdup strdup
+	#define strtok_s strtok_r
+#endif
+
 using namespace network;
 
 Address::Address() :
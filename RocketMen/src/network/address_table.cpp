@@ -0,0 +1,129 @@
+#include "address_table.h"
+
+#include <core/debug.h>
+
+using namespace network;
+
+/* Keys hold a 32-bit address and a 16-bit port, all ones is never a valid key */
+static const uint64_t s_emptyKey = ~0ULL;
+
+AddressTable::AddressTable(int32_t capacity) :
+	m_capacity(capacity),
+	m_count(0)
+{
+	ASSERT(capacity > 0);
+
+	uint32_t size = 2;
+	while (size < static_cast<uint32_t>(capacity) * 2)
+	{
+		size <<= 1;
+	}
+
+	m_entries = new Entry[size];
+	m_mask    = size - 1;
+	clear();
+}
+
+AddressTable::~AddressTable()
+{
+	delete[] m_entries;
+}
+
+bool AddressTable::insert(const Address& address, int32_t value)
+{
+	if (m_count >= m_capacity)
+	{
+		return false;
+	}
+
+	const uint64_t key = getKey(address);
+	uint32_t index = getHomeIndex(key);
+	while (m_entries[index].key != s_emptyKey)
+	{
+		if (m_entries[index].key == key)
+		{
+			return false;
+		}
+		index = (index + 1) & m_mask;
+	}
+
+	m_entries[index].key   = key;
+	m_entries[index].value = value;
+	m_count++;
+	return true;
+}
+
+int32_t AddressTable::find(const Address& address) const
+{
+	const int32_t index = findIndex(getKey(address));
+	return index != INDEX_NONE ? m_entries[index].value : INDEX_NONE;
+}
+
+bool AddressTable::remove(const Address& address)
+{
+	int32_t index = findIndex(getKey(address));
+	if (index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// Move later entries of the probe sequence into the hole, unless that 
+	// would put them before their home index
+	uint32_t hole = static_cast<uint32_t>(index);
+	uint32_t next = (hole + 1) & m_mask;
+	while (m_entries[next].key != s_emptyKey)
+	{
+		const uint32_t home = getHomeIndex(m_entries[next].key);
+		if (((next - home) & m_mask) >= ((next - hole) & m_mask))
+		{
+			m_entries[hole] = m_entries[next];
+			hole = next;
+		}
+		next = (next + 1) & m_mask;
+	}
+
+	m_entries[hole].key = s_emptyKey;
+	m_count--;
+	return true;
+}
+
+void AddressTable::clear()
+{
+	for (uint32_t i = 0; i <= m_mask; i++)
+	{
+		m_entries[i].key   = s_emptyKey;
+		m_entries[i].value = INDEX_NONE;
+	}
+	m_count = 0;
+}
+
+uint64_t AddressTable::getKey(const Address& address)
+{
+	return (static_cast<uint64_t>(address.getAddress()) << 16) | address.getPort();
+}
+
+uint32_t AddressTable::getHomeIndex(uint64_t key) const
+{
+	// Finalizer of MurmurHash3, spreads ports of one host over the table
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return static_cast<uint32_t>(key) & m_mask;
+}
+
+int32_t AddressTable::findIndex(uint64_t key) const
+{
+	uint32_t index = getHomeIndex(key);
+	while (m_entries[index].key != s_emptyKey)
+	{
+		if (m_entries[index].key == key)
+		{
+			return static_cast<int32_t>(index);
+		}
+		index = (index + 1) & m_mask;
+	}
+
+	return INDEX_NONE;
+}
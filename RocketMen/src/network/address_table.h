@@ -0,0 +1,52 @@
+#pragma once
+
+#include <common.h>
+#include <network/address.h>
+
+namespace network
+{
+	/* AddressTable
+	*  Open addressing hash table from Address to an index. Probes linearly
+	*  and shifts entries back on removal, so lookups never walk over
+	*  deleted entries. Sized for capacity entries at half load at most.
+	*/
+	class AddressTable
+	{
+	public:
+		AddressTable(int32_t capacity);
+		~AddressTable();
+
+		/** @return false when address is already in the table or it is full */
+		bool insert(const Address& address, int32_t value);
+
+		/** @return value of address, INDEX_NONE if it is not in the table */
+		int32_t find(const Address& address) const;
+
+		/** @return false if address was not in the table */
+		bool remove(const Address& address);
+
+		void    clear();
+		int32_t getCount()    const { return m_count; }
+		int32_t getCapacity() const { return m_capacity; }
+
+	private:
+		struct Entry
+		{
+			uint64_t key;
+			int32_t  value;
+		};
+
+		static uint64_t getKey(const Address& address);
+		uint32_t getHomeIndex(uint64_t key) const;
+		int32_t  findIndex(uint64_t key) const;
+
+		AddressTable(const AddressTable&) = delete;
+		AddressTable& operator=(const AddressTable&) = delete;
+
+		Entry*   m_entries;
+		uint32_t m_mask;
+		int32_t  m_capacity;
+		int32_t  m_count;
+	};
+
+}; // namespace network
@@ -0,0 +1,312 @@
+#include "bot_client.h"
+
+#include <core/debug.h>
+#include <core/entity.h>
+#include <core/entity_manager.h>
+#include <core/game_time.h>
+#include <network/connection_stats.h>
+#include <network/packet.h>
+#include <network/packet_receiver.h>
+#include <network/socket.h>
+#include <utility/utility.h>
+
+using namespace network;
+
+/* Interval between input messages, as LocalClient */
+static const float s_inputMessageInterval = 0.05f;
+
+/* Upper bound of one frame of encoded input for one player, see LocalClient */
+static const int32_t s_maxInputFrameBytes = (1 + 5 + s_maxActions * (6 + 1 + 10) + 7) / 8;
+
+BotClient::BotClient() :
+	m_socket(Socket::create()),
+	m_connection(nullptr),
+	m_packetReceiver(new PacketReceiver(64)),
+	m_state(State::Disconnected),
+	m_playerId(INDEX_NONE),
+	m_timeSinceLastInputMessage(0.0f),
+	m_lastFrameSent(0),
+	m_lastFrameSimulated(0),
+	m_numActionsRegistered(0)
+{
+	ASSERT(m_socket != nullptr, "Failed to create valid socket instance");
+}
+
+BotClient::~BotClient()
+{
+	if (m_connection != nullptr)
+	{
+		m_connection->close();
+		delete m_connection;
+	}
+	delete m_packetReceiver;
+	delete m_socket;
+}
+
+bool BotClient::connect(const Address& address)
+{
+	using namespace std::placeholders;
+	ASSERT(m_state == State::Disconnected);
+
+	if (!m_socket->isInitialized() && !m_socket->initialize(0))
+	{
+		LOG_ERROR("BotClient: Failed to initialize socket");
+		return false;
+	}
+
+	if (m_connection != nullptr)
+	{
+		m_connection->close();
+		delete m_connection;
+	}
+	m_connection = new Connection(m_socket, address,
+		std::bind(&BotClient::onConnectionCallback, this, _1, _2), m_messageFactory);
+
+	m_connection->tryConnect();
+	m_state = State::Connecting;
+	return true;
+}
+
+void BotClient::disconnect()
+{
+	if (m_state != State::Connected)
+	{
+		return;
+	}
+
+	m_connection->sendMessage(m_messageFactory.createMessage(MessageType::Disconnect));
+	m_state = State::Disconnected;
+	m_connection->close();
+}
+
+void BotClient::update(const Time& time)
+{
+	if (m_connection == nullptr)
+	{
+		return;
+	}
+
+	m_packetReceiver->receivePackets(m_socket, &m_receiveMessageFactory);
+	Buffer<Packet*>& packets = m_packetReceiver->getPackets();
+	for (Packet* packet : packets)
+	{
+		if (packet->address == m_connection->getAddress())
+		{
+			m_connection->receivePacket(*packet, time);
+		}
+	}
+	m_packetReceiver->clearPackets();
+
+	while (Message* message = m_connection->getNextMessage())
+	{
+		readMessage(*message);
+		message->releaseRef();
+	}
+
+	m_timeSinceLastInputMessage += time.getDeltaSeconds();
+	if (m_state == State::Connected && m_timeSinceLastInputMessage >= s_inputMessageInterval)
+	{
+		m_timeSinceLastInputMessage = 0.0f;
+		sendPlayerActions();
+	}
+
+	m_connection->sendPendingMessages(time);
+	m_socket->flush();
+	m_connection->update(time);
+
+	if (m_connection->isClosed())
+	{
+		delete m_connection;
+		m_connection = nullptr;
+	}
+}
+
+void BotClient::tick(Sequence frameId, const ActionBuffer& actions)
+{
+	Frame* frame = m_clientHistory.insertFrame(frameId);
+	ASSERT(frame != nullptr);
+
+	frame->actions[0].clear();
+	frame->actions[0].insert(actions);
+	m_lastFrameSimulated = frameId;
+}
+
+float BotClient::getRtt() const
+{
+	return (m_state == State::Connected) ? m_connection->getStats().getRtt() : 0.0f;
+}
+
+uint64_t BotClient::getBytesReceived() const
+{
+	return m_socket->getBytesReceived();
+}
+
+uint64_t BotClient::getBytesSent() const
+{
+	return m_socket->getBytesSent();
+}
+
+void BotClient::readMessage(const Message& message)
+{
+	switch (message.getType())
+	{
+		case MessageType::ConnectionChallenge:
+		{
+			m_connection->onChallenge(static_cast<const message::ConnectionChallenge&>(message).cookie);
+			break;
+		}
+		case MessageType::AcceptConnection:
+		{
+			m_state = State::Connected;
+			m_connection->setState(Connection::State::Connected);
+			m_connection->setPacketCoding(static_cast<const message::AcceptConnection&>(message).usePacketCoding);
+			m_lastFrameSent = m_lastFrameSimulated;
+
+			message::IntroducePlayer* outMessage = static_cast<message::IntroducePlayer*>(m_messageFactory.createMessage(MessageType::IntroducePlayer));
+			outMessage->numPlayers = 1;
+			m_connection->sendMessage(outMessage);
+			break;
+		}
+		case MessageType::AcceptPlayer:
+		{
+			m_playerId = static_cast<const message::AcceptPlayer&>(message).playerIds[0];
+			break;
+		}
+		case MessageType::Snapshot:
+		{
+			// Acknowledged so the server sends deltas, as it would to a player
+			message::AckSnapshot* outMessage = static_cast<message::AckSnapshot*>(m_messageFactory.createMessage(MessageType::AckSnapshot));
+			outMessage->sequence = static_cast<const message::Snapshot&>(message).sequence;
+			m_connection->sendMessage(outMessage);
+			break;
+		}
+		case MessageType::DestroyEntity:
+		{
+			if (Entity* entity = EntityManager::findNetworkedEntity(static_cast<const message::DestroyEntity&>(message).entityNetworkId))
+			{
+				entity->kill();
+			}
+			break;
+		}
+		case MessageType::Disconnect:
+		{
+			m_state = State::Disconnected;
+			m_connection->close();
+			break;
+		}
+		case MessageType::SpawnEntity:
+		case MessageType::ServerTime:
+		case MessageType::KeepAlive:
+		{
+			break;
+		}
+
+		case MessageType::RequestEntity:
+		case MessageType::IntroducePlayer:
+		case MessageType::PlayerInput:
+		case MessageType::None:
+		case MessageType::RequestConnection:
+		case MessageType::GameEvent:
+		case MessageType::RequestTime:
+		case MessageType::AckSnapshot:
+		case MessageType::RegisterActions:
+		case MessageType::NUM_MESSAGE_TYPES:
+		{
+			ASSERT(false, "Illegal MessageType received");
+			break;
+		}
+	}
+}
+
+void BotClient::sendPlayerActions()
+{
+	const int32_t numFramesToSend = sequenceDifference(m_lastFrameSimulated, m_lastFrameSent);
+	if (m_playerId == INDEX_NONE || numFramesToSend <= 0)
+	{
+		return;
+	}
+
+	message::PlayerInput* message = static_cast<message::PlayerInput*>(m_messageFactory.createMessage(MessageType::PlayerInput));
+	const Sequence startFrame = static_cast<Sequence>(m_lastFrameSent + 1);
+	message->startFrame = startFrame;
+	message->numPlayers = 1;
+
+	registerActions(startFrame, numFramesToSend);
+
+	WriteStream stream(message::PlayerInput::maxDataLength);
+	const Frame* previousFrame = nullptr;
+	for (int16_t i = 0; i < numFramesToSend; i++)
+	{
+		const Sequence frameId = static_cast<Sequence>(startFrame + i);
+		Frame* frame = m_clientHistory.getFrame(frameId);
+		ASSERT(frame != nullptr);
+		frame->actions[0].serialize(stream, m_actionDictionary,
+			(previousFrame != nullptr) ? &previousFrame->actions[0] : nullptr);
+
+		previousFrame = frame;
+		m_lastFrameSent = frameId;
+		message->numFrames = i + 1;
+		if (stream.getBufferSize() - stream.getDataLength() < s_maxInputFrameBytes)
+		{
+			break;
+		}
+	}
+
+	stream.flush();
+	message->dataLength = roundTo(stream.getDataLength(), 4);
+	ASSERT(message->dataLength <= message::PlayerInput::maxDataLength);
+	memcpy(message->data, stream.getData(), message->dataLength);
+
+	m_connection->sendMessage(message);
+}
+
+void BotClient::registerActions(Sequence fromFrame, int32_t numFrames)
+{
+	for (int32_t i = 0; i < numFrames; i++)
+	{
+		const Frame* frame = m_clientHistory.getFrame(static_cast<Sequence>(fromFrame + i));
+		ASSERT(frame != nullptr);
+		for (const input::Action& action : frame->actions[0])
+		{
+			m_actionDictionary.add(action.getHash());
+		}
+	}
+
+	if (m_actionDictionary.getCount() == m_numActionsRegistered)
+	{
+		return;
+	}
+
+	// Same reliable channel as PlayerInput, so it arrives before the input using it
+	message::RegisterActions* message = static_cast<message::RegisterActions*>(m_messageFactory.createMessage(MessageType::RegisterActions));
+	message->dictionary = m_actionDictionary;
+	m_connection->sendMessage(message);
+
+	m_numActionsRegistered = m_actionDictionary.getCount();
+}
+
+void BotClient::onConnectionCallback(ConnectionCallback type, Connection* connection)
+{
+	ASSERT(connection == m_connection);
+
+	switch (type)
+	{
+		case ConnectionCallback::ConnectionFailed:
+		{
+			LOG_INFO("BotClient: Failed to connect to the server");
+			m_state = State::Disconnected;
+			connection->close();
+			break;
+		}
+		case ConnectionCallback::ConnectionLost:
+		{
+			m_state = State::Connecting;
+			break;
+		}
+		case ConnectionCallback::ConnectionEstablished:
+		case ConnectionCallback::ConnectionReceived:
+		{
+			break;
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <common.h>
+#include <core/action_buffer.h>
+#include <core/action_dictionary.h>
+#include <core/entity.h>
+#include <network/client_history.h>
+#include <network/connection.h>
+#include <network/connection_callback.h>
+#include <network/message.h>
+#include <network/client/message_factory_client.h>
+#include <network/server/message_factory_server.h>
+
+class Time;
+
+namespace network
+{
+	class PacketReceiver;
+	class Socket;
+
+	/* BotClient
+	*  Connects one player to a server the way LocalClient does, through the
+	*  same Connection, channels and messages, without a Game behind it. Its
+	*  input is handed to tick, snapshots are acknowledged but not decoded.
+	*  Spawned entities are created in the room bound while it is updated.
+	*/
+	class BotClient
+	{
+	public:
+		enum class State
+		{
+			Disconnected,
+			Connecting,
+			Connected
+		};
+
+		BotClient();
+		~BotClient();
+
+		/** @return false when no socket could be opened */
+		bool connect(const Address& address);
+		void disconnect();
+
+		/** Receives and reads messages, sends the input of the frames ticked since */
+		void update(const Time& time);
+
+		/** Stores the input of frameId, sent with the next update */
+		void tick(Sequence frameId, const ActionBuffer& actions);
+
+		State   getState()    const { return m_state; }
+		int16_t getPlayerId() const { return m_playerId; }
+
+		/** @return round trip time in seconds, 0 until connected */
+		float getRtt() const;
+
+		uint64_t getBytesReceived() const;
+		uint64_t getBytesSent()     const;
+
+	private:
+		void readMessage(const Message& message);
+		void sendPlayerActions();
+		void registerActions(Sequence fromFrame, int32_t numFrames);
+		void onConnectionCallback(ConnectionCallback type, Connection* connection);
+
+		Socket*         m_socket;
+		Connection*     m_connection;
+		PacketReceiver* m_packetReceiver;
+		State           m_state;
+		int16_t         m_playerId;
+		float           m_timeSinceLastInputMessage;
+		Sequence        m_lastFrameSent;
+		Sequence        m_lastFrameSimulated;
+
+		ClientHistory    m_clientHistory;
+		ActionDictionary m_actionDictionary;
+		int32_t          m_numActionsRegistered;
+
+		MessageFactoryClient m_messageFactory;
+		MessageFactoryServer m_receiveMessageFactory;
+	};
+
+}; // namespace network
@@ -0,0 +1,110 @@
+#include "capture_socket.h"
+
+#include <core/debug.h>
+#include <network/datagram_capture.h>
+
+using namespace network;
+
+CaptureSocket::CaptureSocket(Socket* socket, const std::shared_ptr<DatagramCapture>& capture) :
+	m_socket(socket),
+	m_port(0),
+	m_capture(capture)
+{
+	ASSERT(socket != nullptr);
+	ASSERT(capture != nullptr);
+}
+
+CaptureSocket::~CaptureSocket()
+{
+	delete m_socket;
+}
+
+bool CaptureSocket::initialize(uint16_t port)
+{
+	if (!m_socket->initialize(port))
+	{
+		return false;
+	}
+
+	// The port bound, sockets opened on port 0 get one of the system
+	m_port = static_cast<uint16_t>(m_socket->getPort());
+	return true;
+}
+
+bool CaptureSocket::isInitialized() const
+{
+	return m_socket->isInitialized();
+}
+
+bool CaptureSocket::receive(Address& address, char* buffer, int32_t& length)
+{
+	if (!m_socket->receive(address, buffer, length))
+	{
+		return false;
+	}
+
+	m_capture->write(m_port, CaptureDirection::Received, address, buffer, length);
+	return true;
+}
+
+bool CaptureSocket::send(const Address& address, const void* buffer, const size_t length)
+{
+	m_capture->write(m_port, CaptureDirection::Sent, address, static_cast<const char*>(buffer), static_cast<int32_t>(length));
+	return m_socket->send(address, buffer, length);
+}
+
+int32_t CaptureSocket::receiveBatch(Datagram* datagrams, int32_t maxDatagrams)
+{
+	const int32_t numReceived = m_socket->receiveBatch(datagrams, maxDatagrams);
+	for (int32_t i = 0; i < numReceived; i++)
+	{
+		const Datagram& datagram = datagrams[i];
+		m_capture->write(m_port, CaptureDirection::Received, datagram.address, datagram.data, datagram.length);
+	}
+	return numReceived;
+}
+
+bool CaptureSocket::sendBatch(const Datagram* datagrams, int32_t numDatagrams)
+{
+	for (int32_t i = 0; i < numDatagrams; i++)
+	{
+		const Datagram& datagram = datagrams[i];
+		m_capture->write(m_port, CaptureDirection::Sent, datagram.address, datagram.data, datagram.length);
+	}
+	return m_socket->sendBatch(datagrams, numDatagrams);
+}
+
+bool CaptureSocket::waitForData(int32_t timeoutMilliseconds)
+{
+	return m_socket->waitForData(timeoutMilliseconds);
+}
+
+void CaptureSocket::flush()
+{
+	m_socket->flush();
+}
+
+uint32_t CaptureSocket::getPort() const
+{
+	return m_socket->getPort();
+}
+
+uint64_t CaptureSocket::getBytesReceived() const
+{
+	return m_socket->getBytesReceived();
+}
+
+uint64_t CaptureSocket::getBytesSent() const
+{
+	return m_socket->getBytesSent();
+}
+
+uint64_t CaptureSocket::getPacketsReceived() const
+{
+	return m_socket->getPacketsReceived();
+}
+
+uint64_t CaptureSocket::getPacketsSent() const
+{
+	return m_socket->getPacketsSent();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <network/socket.h>
+
+#include <memory>
+
+namespace network
+{
+	class DatagramCapture;
+
+	/* CaptureSocket
+	*  Passes everything to a wrapped socket and writes the datagrams it 
+	*  receives and sends to a DatagramCapture.
+	*/
+	class CaptureSocket : public Socket
+	{
+	public:
+		/** @param Socket* socket  Socket to capture, ownership is taken */
+		CaptureSocket(Socket* socket, const std::shared_ptr<DatagramCapture>& capture);
+		~CaptureSocket();
+
+		bool initialize(uint16_t port) override;
+		bool isInitialized()     const override;
+
+		bool receive(Address& address, char* buffer, int32_t& length) override;
+		bool send(const Address& address, const void* buffer, const size_t length) override;
+
+		int32_t receiveBatch(Datagram* datagrams, int32_t maxDatagrams) override;
+		bool    sendBatch(const Datagram* datagrams, int32_t numDatagrams) override;
+		bool    waitForData(int32_t timeoutMilliseconds) override;
+		void    flush() override;
+
+		uint32_t getPort()            const override;
+		uint64_t getBytesReceived()   const override;
+		uint64_t getBytesSent()       const override;
+		uint64_t getPacketsReceived() const override;
+		uint64_t getPacketsSent()     const override;
+
+	private:
+		Socket*  m_socket;
+		uint16_t m_port;
+		std::shared_ptr<DatagramCapture> m_capture;
+	};
+
+}; // namespace network
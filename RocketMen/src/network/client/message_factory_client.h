@@ -3,10 +3,12 @@
 
 #include <network/message_factory.h>
 
+#include <network/message/ack_snapshot.h>
 #include <network/message/disconnect.h>
 #include <network/message/introduce_player.h>
 #include <network/message/keep_alive.h>
 #include <network/message/player_input.h>
+#include <network/message/register_actions.h>
 #include <network/message/request_connection.h>
 #include <network/message/request_entity.h>
 #include <network/message/request_time.h>
@@ -51,6 +53,14 @@ namespace network {
 				{
 					return new message::RequestTime();
 				}
+				case MessageType::AckSnapshot:
+				{
+					return new message::AckSnapshot();
+				}
+				case MessageType::RegisterActions:
+				{
+					return new message::RegisterActions();
+				}
 
 				case MessageType::None:
 				case MessageType::AcceptConnection:
@@ -60,6 +70,7 @@ namespace network {
 				case MessageType::DestroyEntity:
 				case MessageType::GameEvent:
 				case MessageType::ServerTime:
+				case MessageType::ConnectionChallenge:
 				case MessageType::NUM_MESSAGE_TYPES:
 				{
 					ASSERT(false, "Illegal MessageType passed");
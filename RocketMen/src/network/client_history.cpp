@@ -20,6 +20,7 @@ Frame* ClientHistory::insertFrame(Sequence frameId)
 	for (int32_t i = 0; i < s_maxPlayersPerClient; i++)
 	{
 		frame->actions[i].clear();
+		frame->states[i] = PredictedState();
 	}
 	return frame;
 }
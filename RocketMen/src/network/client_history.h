@@ -7,9 +7,18 @@
 
 namespace network
 {
+	/* Body of a local player's entity after a predicted frame */
+	struct PredictedState
+	{
+		int32_t networkId = INDEX_NONE;
+		Vector2 position;
+		Vector2 velocity;
+	};
+
 	struct Frame
 	{
-		ActionBuffer actions[s_maxPlayersPerClient];
+		ActionBuffer   actions[s_maxPlayersPerClient];
+		PredictedState states[s_maxPlayersPerClient];
 	};
 
 	class ClientHistory
@@ -0,0 +1,178 @@
+#include "clock_sync.h"
+
+#include <core/debug.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace network;
+
+static const int32_t  s_minSamples       = 5;
+static const uint64_t s_burstInterval    = 100000;
+static const uint64_t s_resyncInterval   = 2000000;
+
+/* Larger corrections are applied at once instead of slewed */
+static const int64_t  s_maxSlew          = 50000;
+static const double   s_slewGain         = 0.1;
+
+/* Drift is only measured over a long enough span, and clamped to 1000 ppm */
+static const uint64_t s_minDriftSpan     = 1000000;
+static const double   s_maxDrift         = 0.001;
+
+ClockSync::ClockSync()
+{
+	reset();
+}
+
+void ClockSync::reset()
+{
+	m_numSamples      = 0;
+	m_nextSample      = 0;
+	m_offset          = 0;
+	m_offsetTime      = 0;
+	m_drift           = 0.0;
+	m_roundTrip       = 0;
+	m_serverFrame     = 0;
+	m_serverFrameTime = 0;
+	m_lastRequestTime = 0;
+}
+
+void ClockSync::addSample(uint64_t requestTime, uint64_t serverTime, Sequence serverFrame, uint64_t receiveTime)
+{
+	if (receiveTime < requestTime)
+	{
+		return;
+	}
+
+	// The server answered halfway through the round trip
+	Sample& sample   = m_samples[m_nextSample];
+	sample.localTime = receiveTime;
+	sample.roundTrip = receiveTime - requestTime;
+	sample.offset    = static_cast<int64_t>(serverTime + sample.roundTrip / 2) - static_cast<int64_t>(receiveTime);
+
+	m_nextSample = (m_nextSample + 1) % s_maxClockSamples;
+	m_numSamples = std::min(m_numSamples + 1, s_maxClockSamples);
+
+	m_serverFrame = (m_numSamples == 1) ? serverFrame
+		: m_serverFrame + sequenceDifference(serverFrame, static_cast<Sequence>(m_serverFrame));
+	m_serverFrameTime = serverTime;
+
+	// Round trips more than one standard deviation above the median hit a queue somewhere
+	Sample sorted[s_maxClockSamples];
+	std::copy(m_samples, m_samples + m_numSamples, sorted);
+	std::sort(sorted, sorted + m_numSamples, [](const Sample& a, const Sample& b) -> bool {
+		return a.roundTrip < b.roundTrip;
+	});
+
+	const double median = static_cast<double>(sorted[m_numSamples / 2].roundTrip);
+	double variance = 0.0;
+	for (int32_t i = 0; i < m_numSamples; i++)
+	{
+		const double difference = sorted[i].roundTrip - median;
+		variance += difference * difference;
+	}
+	const double maxRoundTrip = median + std::sqrt(variance / m_numSamples);
+
+	int32_t numAccepted = 0;
+	double  offsetSum = 0.0;
+	double  roundTripSum = 0.0;
+	while (numAccepted < m_numSamples && sorted[numAccepted].roundTrip <= maxRoundTrip)
+	{
+		offsetSum    += static_cast<double>(sorted[numAccepted].offset);
+		roundTripSum += static_cast<double>(sorted[numAccepted].roundTrip);
+		numAccepted++;
+	}
+	ASSERT(numAccepted > 0, "The median sample is always accepted");
+
+	updateDrift(sorted, numAccepted);
+
+	const int64_t targetOffset = static_cast<int64_t>(offsetSum / numAccepted);
+	const int64_t currentOffset = getOffsetAt(receiveTime);
+	m_roundTrip = static_cast<uint64_t>(roundTripSum / numAccepted);
+
+	// Slew small corrections so the estimated server clock keeps moving forward smoothly
+	if (m_numSamples == 1 || std::abs(targetOffset - currentOffset) > s_maxSlew)
+	{
+		m_offset = targetOffset;
+	}
+	else
+	{
+		m_offset = currentOffset + static_cast<int64_t>((targetOffset - currentOffset) * s_slewGain);
+	}
+	m_offsetTime = receiveTime;
+}
+
+bool ClockSync::needsSample(uint64_t localTime) const
+{
+	const uint64_t interval = isSynchronized() ? s_resyncInterval : s_burstInterval;
+	return m_lastRequestTime == 0 || localTime - m_lastRequestTime >= interval;
+}
+
+void ClockSync::onRequestSent(uint64_t localTime)
+{
+	m_lastRequestTime = localTime;
+}
+
+bool ClockSync::isSynchronized() const
+{
+	return m_numSamples >= s_minSamples;
+}
+
+uint64_t ClockSync::getServerTime(uint64_t localTime) const
+{
+	return static_cast<uint64_t>(static_cast<int64_t>(localTime) + getOffsetAt(localTime));
+}
+
+double ClockSync::getServerFrame(uint64_t localTime, uint64_t timestep) const
+{
+	ASSERT(timestep > 0);
+	const double elapsed = static_cast<double>(static_cast<int64_t>(getServerTime(localTime) - m_serverFrameTime));
+	return static_cast<double>(m_serverFrame) + elapsed / static_cast<double>(timestep);
+}
+
+int64_t ClockSync::getOffsetAt(uint64_t localTime) const
+{
+	const double elapsed = static_cast<double>(static_cast<int64_t>(localTime - m_offsetTime));
+	return m_offset + static_cast<int64_t>(elapsed * m_drift);
+}
+
+void ClockSync::updateDrift(const Sample* samples, int32_t numSamples)
+{
+	// Least squares slope of the offset over local time
+	uint64_t firstTime = samples[0].localTime;
+	uint64_t lastTime  = samples[0].localTime;
+	for (int32_t i = 1; i < numSamples; i++)
+	{
+		firstTime = std::min(firstTime, samples[i].localTime);
+		lastTime  = std::max(lastTime, samples[i].localTime);
+	}
+
+	if (numSamples < 2 || lastTime - firstTime < s_minDriftSpan)
+	{
+		return;
+	}
+
+	double meanTime = 0.0;
+	double meanOffset = 0.0;
+	for (int32_t i = 0; i < numSamples; i++)
+	{
+		meanTime   += static_cast<double>(samples[i].localTime - firstTime);
+		meanOffset += static_cast<double>(samples[i].offset);
+	}
+	meanTime   /= numSamples;
+	meanOffset /= numSamples;
+
+	double covariance = 0.0;
+	double variance = 0.0;
+	for (int32_t i = 0; i < numSamples; i++)
+	{
+		const double time = static_cast<double>(samples[i].localTime - firstTime) - meanTime;
+		covariance += time * (static_cast<double>(samples[i].offset) - meanOffset);
+		variance   += time * time;
+	}
+
+	if (variance > 0.0)
+	{
+		m_drift = std::min(std::max(covariance / variance, -s_maxDrift), s_maxDrift);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <common.h>
+
+namespace network
+{
+	static const int32_t s_maxClockSamples = 16;
+
+	/* ClockSync
+	*  Estimates the server clock from RequestTime/ServerTime round trips, as
+	*  in http://www.mine-control.com/zack/timesync/timesync.html. Samples
+	*  whose round trip is more than a standard deviation above the median are
+	*  discarded, the rest give the clock offset. The offset is slewed towards
+	*  new estimates and extrapolated with the drift measured between samples.
+	*  All times are in microseconds.
+	*/
+	class ClockSync
+	{
+	public:
+		ClockSync();
+
+		void reset();
+
+		/** @param requestTime  Local time the RequestTime was sent
+		*   @param serverTime   Server time it was answered
+		*   @param serverFrame  Last frame the server simulated at serverTime
+		*   @param receiveTime  Local time the ServerTime arrived */
+		void addSample(uint64_t requestTime, uint64_t serverTime, Sequence serverFrame, uint64_t receiveTime);
+
+		/** @return true when a RequestTime should be sent: quickly until
+		*   synchronized, then at a slow rate to follow drift */
+		bool needsSample(uint64_t localTime) const;
+		void onRequestSent(uint64_t localTime);
+
+		bool     isSynchronized()                            const;
+		uint64_t getServerTime(uint64_t localTime)           const;
+
+		/** @return server frame estimated at localTime, with the fraction of
+		*   the frame that has passed. Not wrapped like a Sequence. */
+		double   getServerFrame(uint64_t localTime, uint64_t timestep) const;
+
+		int64_t  getOffset()     const { return m_offset; }
+		double   getDrift()      const { return m_drift; }
+		uint64_t getRoundTrip()  const { return m_roundTrip; }
+		int32_t  getNumSamples() const { return m_numSamples; }
+
+	private:
+		struct Sample
+		{
+			uint64_t localTime;
+			uint64_t roundTrip;
+			int64_t  offset;
+		};
+
+		int64_t getOffsetAt(uint64_t localTime) const;
+		void    updateDrift(const Sample* samples, int32_t numSamples);
+
+		Sample   m_samples[s_maxClockSamples];
+		int32_t  m_numSamples;
+		int32_t  m_nextSample;
+
+		/* Offset of the server clock at m_offsetTime, and its drift since */
+		int64_t  m_offset;
+		uint64_t m_offsetTime;
+		double   m_drift;
+		uint64_t m_roundTrip;
+
+		/* Last sample's server frame, unwrapped, and the server time it ran at */
+		int64_t  m_serverFrame;
+		uint64_t m_serverFrameTime;
+
+		uint64_t m_lastRequestTime;
+	};
+
+}; // namespace network
@@ -5,9 +5,19 @@
 
 namespace network
 {
+	static const uint32_t s_maxConnectedClients       = 32;
 	static const uint32_t s_maxPlayersPerClient       = 4;
 	static const float    s_snapshotCreationRate      = 1 / 20.f;
 	static const uint32_t s_sentPacketsBufferSize     = 1024;
 	static const uint32_t s_receivedPacketsBufferSize = 1024;
 	static const uint32_t s_maxSnapshotSize           = 512;
+	static const int32_t  s_snapshotHistorySize       = 32;
+	static const int32_t  s_inputBufferSize           = 64;
+	static const float    s_interestCellSize          = 8.0f;
+	static const float    s_defaultInterestRadius     = 24.0f;
+	static const int32_t  s_lagCompensationFrames     = 64;
+	static const bool     s_loopbackPassMessages      = true;
+	static const bool     s_dedicatedReceiveThread    = true;
+	static const int32_t  s_maxSendWorkers            = 4;
+	static const int32_t  s_minParallelSendClients    = 8;
 }; // namespace network
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include <core/debug.h>
 #include <core/game_time.h>
 #include <network/message_factory.h>
+#include <network/network_metrics.h>
+#include <network/packet_coder.h>
+#include <network/message/request_connection.h>
 #include <network/reliable_ordered_channel.h>
 #include <network/socket.h>
 #include <network/unreliable_channel.h>
@@ -13,12 +16,19 @@ using namespace network;
 static const uint32_t s_maxConnectionAttemptDuration = 10;
 static const float    s_timeout = 20.f;
 
+/* Seconds between connection requests while the server has not accepted */
+static const float    s_connectionRequestInterval = 0.25f;
+
 Connection::Connection(Socket* socket, const Address& address, ConnectionCallbackMethod callback, MessageFactory& messageFactory) :
 	m_address(address),
 	m_connectionAttempt(0),
 	m_timeSinceLastPacketReceived(0.f),
 	m_state(State::Disconnected),
 	m_connectionAttemptDuration(0.f),
+	m_timeSinceLastRequest(0.f),
+	m_cookie(0),
+	m_hasCookie(false),
+	m_isRequesting(false),
 	m_unreliableChannel(new UnreliableChannel()),
 	m_reliableOrderedChannel(new ReliableOrderedChannel()),
 	m_connectionCallback(callback),
@@ -47,6 +57,7 @@ void Connection::update(const Time& time)
 		if (m_timeSinceLastPacketReceived > 2.f)
 		{
 			LOG_INFO("Connection: Connection lost, reconnecting..");
+			NetworkMetrics::get().connectionsLost.add();
 			setState(State::Connecting);
 			m_connectionCallback(ConnectionCallback::ConnectionLost, this);
 		}
@@ -58,7 +69,16 @@ void Connection::update(const Time& time)
 		if (m_connectionAttemptDuration > static_cast<float>(s_maxConnectionAttemptDuration))
 		{
 			LOG_INFO("Connection: Connection attempt failed after %d seconds", s_maxConnectionAttemptDuration);
+			NetworkMetrics::get().connectionsFailed.add();
 			m_connectionCallback(ConnectionCallback::ConnectionFailed, this);
+			break;
+		}
+
+		// Requests are unreliable, repeat them until the server accepts
+		m_timeSinceLastRequest += time.getDeltaSeconds();
+		if (m_isRequesting && m_timeSinceLastRequest >= s_connectionRequestInterval)
+		{
+			sendConnectionRequest();
 		}
 		break;
 	}
@@ -84,11 +104,17 @@ void Connection::sendMessage(Message* message)
 
 void Connection::sendPendingMessages(const Time& time)
 {
-	m_reliableOrderedChannel->sendPendingMessages(m_socket, m_address, time, &m_messageFactory);
-	m_unreliableChannel->sendPendingMessages(m_socket, m_address, time, &m_messageFactory);
+	sendPendingMessages(time, m_socket);
+}
+
+void Connection::sendPendingMessages(const Time& time, Socket* socket)
+{
+	ASSERT(socket != nullptr);
+	m_reliableOrderedChannel->sendPendingMessages(socket, m_address, time, &m_messageFactory);
+	m_unreliableChannel->sendPendingMessages(socket, m_address, time, &m_messageFactory);
 }
 
-void Connection::receivePacket(Packet& packet)
+void Connection::receivePacket(Packet& packet, const Time& time)
 {
 	m_timeSinceLastPacketReceived = 0.f;
 
@@ -100,15 +126,16 @@ void Connection::receivePacket(Packet& packet)
 
 	if (channel == ChannelType::UnreliableUnordered)
 	{
-		m_unreliableChannel->receivePacket(packet);
+		m_unreliableChannel->receivePacket(packet, time);
 	}
 	else
 	{
 		ASSERT(channel == ChannelType::ReliableOrdered);
-		m_reliableOrderedChannel->receivePacket(packet);
+		m_reliableOrderedChannel->receivePacket(packet, time);
 	}
 
-	if (m_state == State::Connecting)
+	// While requesting only the acceptance of the server completes the handshake
+	if (m_state == State::Connecting && !m_isRequesting)
 	{
 		setState(State::Connected);
 	}
@@ -139,6 +166,22 @@ const Address& Connection::getAddress() const
 	return m_address;
 }
 
+Socket* Connection::getSocket() const
+{
+	return m_socket;
+}
+
+void Connection::setPacketCoding(bool isPacketCoding)
+{
+	m_unreliableChannel->setPacketCoding(isPacketCoding);
+	m_reliableOrderedChannel->setPacketCoding(isPacketCoding);
+}
+
+const ConnectionStats& Connection::getStats() const
+{
+	return m_reliableOrderedChannel->getStats();
+}
+
 void Connection::setState(State state)
 {
 	m_state = state;
@@ -146,6 +189,10 @@ void Connection::setState(State state)
 	{
 		m_connectionAttemptDuration = 0.f;
 	}
+	else
+	{
+		m_isRequesting = false;
+	}
 }
 
 Connection::State Connection::getState() const
@@ -157,10 +204,47 @@ void Connection::tryConnect()
 {
 	ASSERT(m_state == State::Disconnected);
 
-	Message* message = m_messageFactory.createMessage(MessageType::RequestConnection);
+	setState(State::Connecting);
+	m_hasCookie    = false;
+	m_isRequesting = true;
+	sendConnectionRequest();
+}
+
+void Connection::onChallenge(uint64_t cookie)
+{
+	if (!m_isRequesting)
+	{
+		return;
+	}
+
+	const bool isNewCookie = !m_hasCookie || m_cookie != cookie;
+	m_cookie    = cookie;
+	m_hasCookie = true;
+
+	// Challenges to requests still in flight carry the same cookie
+	if (isNewCookie)
+	{
+		sendConnectionRequest();
+	}
+}
+
+bool Connection::isRequesting() const
+{
+	return m_isRequesting;
+}
+
+void Connection::sendConnectionRequest()
+{
+	message::RequestConnection* message = 
+		static_cast<message::RequestConnection*>(m_messageFactory.createMessage(MessageType::RequestConnection));
+	ASSERT(message != nullptr);
+
+	message->hasCookie = m_hasCookie;
+	message->cookie    = m_cookie;
+	message->supportsPacketCoding = PacketCoder::isEnabled();
 	sendMessage(message);
 
-	setState(State::Connecting);
+	m_timeSinceLastRequest = 0.f;
 }
 
 bool Connection::isClosed() const
@@ -9,6 +9,7 @@ namespace network
 {
 	struct Message;
 	struct Packet;
+	class  ConnectionStats;
 	class  MessageFactory;
 	class  ReliableOrderedChannel;
 	class  Socket;
@@ -36,25 +37,49 @@ namespace network
 
 		void sendMessage(Message* message);
 		void sendPendingMessages(const Time& time);
-		void receivePacket(Packet& packet);
+
+		/** Sends through socket instead of the socket of the connection, so 
+		*   the datagrams of a send worker can be queued for the game thread */
+		void sendPendingMessages(const Time& time, Socket* socket);
+		void receivePacket(Packet& packet, const Time& time);
 		void close();
 
 		Message* getNextMessage();
 		
 		const Address& getAddress() const;
+		Socket* getSocket() const;
+
+		/** Round trip time, jitter and loss of the reliable channel */
+		const ConnectionStats& getStats() const;
 		State getState() const;
 		void setState(State state);
 		void tryConnect();
 
+		/** Answers the challenge of the server with its cookie, the request
+		*   is repeated with the cookie until the server accepts */
+		void onChallenge(uint64_t cookie);
+
+		/** @return true until the server accepted the connection request */
+		bool isRequesting() const;
+
 		bool isClosed() const;
 
+		/** Codes the packets of both channels, once the handshake agreed to it */
+		void setPacketCoding(bool isPacketCoding);
+
 	private:
+		void sendConnectionRequest();
+
 		Address  m_address;
 		Socket*  m_socket;
 		uint32_t m_connectionAttempt;
 		float    m_timeSinceLastPacketReceived;
 		State    m_state;
 		float    m_connectionAttemptDuration;
+		float    m_timeSinceLastRequest;
+		uint64_t m_cookie;
+		bool     m_hasCookie;
+		bool     m_isRequesting;
 
 		UnreliableChannel*      m_unreliableChannel;
 		ReliableOrderedChannel* m_reliableOrderedChannel;
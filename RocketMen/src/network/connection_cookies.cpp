@@ -0,0 +1,96 @@
+#include "connection_cookies.h"
+
+#include <random>
+
+using namespace network;
+
+/* Seconds before the secret is replaced */
+static const float s_cookieSecretLifetime = 15.0f;
+
+static inline uint64_t rotl(uint64_t value, int32_t bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+static inline void sipRound(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3)
+{
+	v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+	v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+	v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+	v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+}
+
+ConnectionCookies::ConnectionCookies()
+{
+	reset();
+}
+
+void ConnectionCookies::update(float deltaTime)
+{
+	m_secretAge += deltaTime;
+	if (m_secretAge >= s_cookieSecretLifetime)
+	{
+		m_previous  = m_current;
+		m_current   = createSecret();
+		m_secretAge = 0.0f;
+	}
+}
+
+uint64_t ConnectionCookies::generate(const Address& address) const
+{
+	return hash(m_current, address);
+}
+
+bool ConnectionCookies::verify(const Address& address, uint64_t cookie) const
+{
+	return cookie == hash(m_current, address) || cookie == hash(m_previous, address);
+}
+
+void ConnectionCookies::reset()
+{
+	m_current   = createSecret();
+	m_previous  = createSecret();
+	m_secretAge = 0.0f;
+}
+
+uint64_t ConnectionCookies::hash(const Secret& secret, const Address& address)
+{
+	// SipHash-2-4 of the 8 byte message address:port
+	const uint64_t message = (static_cast<uint64_t>(address.getAddress()) << 16) | address.getPort();
+
+	uint64_t v0 = secret.k0 ^ 0x736f6d6570736575ULL;
+	uint64_t v1 = secret.k1 ^ 0x646f72616e646f6dULL;
+	uint64_t v2 = secret.k0 ^ 0x6c7967656e657261ULL;
+	uint64_t v3 = secret.k1 ^ 0x7465646279746573ULL;
+
+	v3 ^= message;
+	sipRound(v0, v1, v2, v3);
+	sipRound(v0, v1, v2, v3);
+	v0 ^= message;
+
+	// Final block holds only the message length
+	const uint64_t last = 8ULL << 56;
+	v3 ^= last;
+	sipRound(v0, v1, v2, v3);
+	sipRound(v0, v1, v2, v3);
+	v0 ^= last;
+
+	v2 ^= 0xff;
+	for (int32_t i = 0; i < 4; i++)
+	{
+		sipRound(v0, v1, v2, v3);
+	}
+
+	return v0 ^ v1 ^ v2 ^ v3;
+}
+
+ConnectionCookies::Secret ConnectionCookies::createSecret()
+{
+	std::random_device device;
+	std::uniform_int_distribution<uint64_t> distribution;
+
+	Secret secret;
+	secret.k0 = distribution(device);
+	secret.k1 = distribution(device);
+	return secret;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <common.h>
+#include <network/address.h>
+
+namespace network
+{
+	/* ConnectionCookies
+	*  Stateless proof that a client receives at the address it sends from.
+	*  A cookie is a keyed hash (SipHash-2-4) of the address under a random
+	*  secret. The secret rotates every s_cookieSecretLifetime seconds and
+	*  cookies of the previous secret are still accepted, so a cookie lives
+	*  between one and two lifetimes.
+	*/
+	class ConnectionCookies
+	{
+	public:
+		ConnectionCookies();
+
+		/** Rotates the secret once its lifetime has passed */
+		void update(float deltaTime);
+
+		uint64_t generate(const Address& address) const;
+		bool     verify(const Address& address, uint64_t cookie) const;
+
+		/** Forgets every secret, all cookies handed out so far become invalid */
+		void reset();
+
+	private:
+		struct Secret
+		{
+			uint64_t k0;
+			uint64_t k1;
+		};
+
+		static uint64_t hash(const Secret& secret, const Address& address);
+		static Secret   createSecret();
+
+		Secret m_current;
+		Secret m_previous;
+		float  m_secretAge;
+	};
+
+}; // namespace network
@@ -0,0 +1,89 @@
+#include "connection_stats.h"
+
+#include <core/debug.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace network;
+
+/* Used until the first RTT sample arrives */
+static const float s_initialResendTimeout = 0.1f;
+static const float s_minResendTimeout     = 0.03f;
+static const float s_maxResendTimeout     = 1.0f;
+
+/* Acks are read once per frame, which bounds the precision of a sample */
+static const float s_clockGranularity     = 1 / 60.f;
+
+static const float s_rttGain              = 1 / 8.f;
+static const float s_rttVarianceGain      = 1 / 4.f;
+static const float s_jitterGain           = 1 / 16.f;
+static const float s_packetLossGain       = 1 / 32.f;
+
+ConnectionStats::ConnectionStats()
+{
+	reset();
+}
+
+void ConnectionStats::reset()
+{
+	m_hasRttSample    = false;
+	m_rtt             = 0.0f;
+	m_rttVariance     = 0.0f;
+	m_lastRtt         = 0.0f;
+	m_jitter          = 0.0f;
+	m_packetLoss      = 0.0f;
+	m_resendTimeout   = s_initialResendTimeout;
+	m_numPacketsSent  = 0;
+	m_numPacketsAcked = 0;
+	m_numPacketsLost  = 0;
+}
+
+void ConnectionStats::addPacketSent()
+{
+	m_numPacketsSent++;
+}
+
+void ConnectionStats::addPacketAcked(float rtt)
+{
+	ASSERT(rtt >= 0.0f);
+	m_numPacketsAcked++;
+	addLossSample(0.0f);
+
+	if (!m_hasRttSample)
+	{
+		m_rtt          = rtt;
+		m_rttVariance  = rtt / 2;
+		m_lastRtt      = rtt;
+		m_hasRttSample = true;
+	}
+	else
+	{
+		m_rttVariance += s_rttVarianceGain * (std::abs(m_rtt - rtt) - m_rttVariance);
+		m_rtt         += s_rttGain * (rtt - m_rtt);
+
+		// Interarrival jitter as in RFC 3550, applied to consecutive samples
+		m_jitter      += s_jitterGain * (std::abs(rtt - m_lastRtt) - m_jitter);
+		m_lastRtt      = rtt;
+	}
+
+	const float resendTimeout = m_rtt + std::max(s_clockGranularity, 4 * m_rttVariance);
+	m_resendTimeout = std::min(std::max(resendTimeout, s_minResendTimeout), s_maxResendTimeout);
+}
+
+void ConnectionStats::addPacketAcked()
+{
+	m_numPacketsAcked++;
+	addLossSample(0.0f);
+}
+
+void ConnectionStats::addPacketLost()
+{
+	m_numPacketsLost++;
+	addLossSample(1.0f);
+}
+
+void ConnectionStats::addLossSample(float sample)
+{
+	m_packetLoss += s_packetLossGain * (sample - m_packetLoss);
+}
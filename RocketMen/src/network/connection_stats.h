@@ -0,0 +1,55 @@
+#pragma once
+
+#include <common.h>
+
+namespace network
+{
+	/* ConnectionStats
+	*  Round trip time, jitter and packet loss of a connection, measured from
+	*  the acks of reliable packets. The resend timeout follows RFC 6298:
+	*  smoothed RTT plus four times its variance.
+	*/
+	class ConnectionStats
+	{
+	public:
+		ConnectionStats();
+
+		void reset();
+
+		void addPacketSent();
+
+		/** @param rtt  Seconds between sending a packet and reading its ack */
+		void addPacketAcked(float rtt);
+
+		/** The ack of a packet which may have been delayed, it only counts towards loss */
+		void addPacketAcked();
+
+		/** A packet fell out of the ack window without being acked */
+		void addPacketLost();
+
+		float    getRtt()            const { return m_rtt; }
+		float    getRttVariance()    const { return m_rttVariance; }
+		float    getJitter()         const { return m_jitter; }
+		float    getPacketLoss()     const { return m_packetLoss; }
+		float    getResendTimeout()  const { return m_resendTimeout; }
+		uint32_t getPacketsSent()    const { return m_numPacketsSent; }
+		uint32_t getPacketsAcked()   const { return m_numPacketsAcked; }
+		uint32_t getPacketsLost()    const { return m_numPacketsLost; }
+
+	private:
+		void addLossSample(float sample);
+
+		bool  m_hasRttSample;
+		float m_rtt;
+		float m_rttVariance;
+		float m_lastRtt;
+		float m_jitter;
+		float m_packetLoss;
+		float m_resendTimeout;
+
+		uint32_t m_numPacketsSent;
+		uint32_t m_numPacketsAcked;
+		uint32_t m_numPacketsLost;
+	};
+
+}; // namespace network
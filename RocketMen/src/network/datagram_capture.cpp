@@ -0,0 +1,162 @@
+#include "datagram_capture.h"
+
+#include <core/debug.h>
+
+#include <algorithm>
+
+using namespace network;
+
+static const char     s_captureTag[4]    = { 'R', 'M', 'D', 'C' };
+static const uint32_t s_captureVersion   = 1;
+static const int32_t  s_recordHeaderSize = 19;
+
+static std::mutex                       s_activeMutex;
+static std::shared_ptr<DatagramCapture> s_activeCapture;
+
+static void writeValue(char*& buffer, uint64_t value, int32_t numBytes)
+{
+	for (int32_t i = 0; i < numBytes; i++)
+	{
+		*buffer++ = static_cast<char>((value >> (i * 8)) & 0xff);
+	}
+}
+
+static uint64_t readValue(const char*& buffer, int32_t numBytes)
+{
+	uint64_t value = 0;
+	for (int32_t i = 0; i < numBytes; i++)
+	{
+		value |= static_cast<uint64_t>(static_cast<uint8_t>(*buffer++)) << (i * 8);
+	}
+	return value;
+}
+
+//=============================================================================
+
+DatagramCapture::DatagramCapture() :
+	m_numRecords(0),
+	m_startTime(std::chrono::steady_clock::now())
+{
+}
+
+DatagramCapture::~DatagramCapture()
+{
+	LOG_INFO("DatagramCapture: %llu datagrams captured", static_cast<unsigned long long>(m_numRecords));
+}
+
+bool DatagramCapture::start(const std::string& path)
+{
+	std::shared_ptr<DatagramCapture> capture(new DatagramCapture());
+	capture->m_file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!capture->m_file.is_open())
+	{
+		LOG_ERROR("DatagramCapture: cannot create %s", path.c_str());
+		return false;
+	}
+
+	char header[8];
+	char* writer = header + sizeof(s_captureTag);
+	std::copy(s_captureTag, s_captureTag + sizeof(s_captureTag), header);
+	writeValue(writer, s_captureVersion, 4);
+	capture->m_file.write(header, sizeof(header));
+
+	std::lock_guard<std::mutex> lock(s_activeMutex);
+	s_activeCapture = capture;
+	LOG_INFO("DatagramCapture: capturing to %s", path.c_str());
+	return true;
+}
+
+void DatagramCapture::stop()
+{
+	std::lock_guard<std::mutex> lock(s_activeMutex);
+	s_activeCapture.reset();
+}
+
+std::shared_ptr<DatagramCapture> DatagramCapture::getActive()
+{
+	std::lock_guard<std::mutex> lock(s_activeMutex);
+	return s_activeCapture;
+}
+
+void DatagramCapture::write(uint16_t localPort, CaptureDirection direction, const Address& address,
+	const char* data, int32_t length)
+{
+	ASSERT(length >= 0 && length <= g_maxDatagramSize);
+
+	// Timed under the lock, so records are in the order of their timestamps
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - m_startTime).count();
+
+	char header[s_recordHeaderSize];
+	char* writer = header;
+	writeValue(writer, timestamp, 8);
+	writeValue(writer, localPort, 2);
+	writeValue(writer, static_cast<uint8_t>(direction), 1);
+	writeValue(writer, address.getAddress(), 4);
+	writeValue(writer, address.getPort(), 2);
+	writeValue(writer, static_cast<uint16_t>(length), 2);
+
+	m_file.write(header, s_recordHeaderSize);
+	m_file.write(data, length);
+	m_numRecords++;
+}
+
+//=============================================================================
+
+CaptureReader::CaptureReader()
+{
+}
+
+bool CaptureReader::open(const std::string& path)
+{
+	m_file.open(path, std::ios::in | std::ios::binary);
+	if (!m_file.is_open())
+	{
+		return false;
+	}
+
+	char header[8];
+	if (!m_file.read(header, sizeof(header)) || !std::equal(s_captureTag, s_captureTag + sizeof(s_captureTag), header))
+	{
+		m_file.close();
+		return false;
+	}
+
+	const char* reader = header + sizeof(s_captureTag);
+	if (readValue(reader, 4) != s_captureVersion)
+	{
+		m_file.close();
+		return false;
+	}
+
+	return true;
+}
+
+bool CaptureReader::read(CaptureRecord& record)
+{
+	char header[s_recordHeaderSize];
+	if (!m_file.read(header, s_recordHeaderSize))
+	{
+		return false;
+	}
+
+	const char* reader = header;
+	record.timestamp  = readValue(reader, 8);
+	record.localPort  = static_cast<uint16_t>(readValue(reader, 2));
+	record.direction  = static_cast<CaptureDirection>(readValue(reader, 1));
+
+	const uint32_t address = static_cast<uint32_t>(readValue(reader, 4));
+	const uint16_t port    = static_cast<uint16_t>(readValue(reader, 2));
+	record.datagram.address = Address(address, port);
+	record.datagram.length  = static_cast<int32_t>(readValue(reader, 2));
+
+	if (record.direction > CaptureDirection::Sent || record.datagram.length > g_maxDatagramSize 
+		|| !m_file.read(record.datagram.data, record.datagram.length))
+	{
+		LOG_WARNING("CaptureReader: damaged record, the capture ends here");
+		return false;
+	}
+
+	return true;
+}
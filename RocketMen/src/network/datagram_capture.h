@@ -0,0 +1,90 @@
+#pragma once
+
+#include <common.h>
+#include <network/address.h>
+#include <network/socket.h>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace network
+{
+	enum class CaptureDirection : uint8_t
+	{
+		Received = 0,
+		Sent
+	};
+
+	/* One datagram of a capture */
+	struct CaptureRecord
+	{
+		/* Microseconds since the capture started */
+		uint64_t         timestamp;
+
+		/* Port the capturing socket was bound to */
+		uint16_t         localPort;
+		CaptureDirection direction;
+		Datagram         datagram;
+	};
+
+	/* DatagramCapture
+	*  Records the datagrams of every socket created while it is active in
+	*  one binary file. The file starts with a 4 byte tag and a 32-bit
+	*  version, each record is a 19 byte little endian header followed by 
+	*  the datagram: timestamp (8), local port (2), direction (1), address (4),
+	*  remote port (2), length (2). Sockets write from the receive thread, 
+	*  the game thread and room threads, so writes are serialized.
+	*  Rooms share one socket, so the datagrams of all rooms are recorded
+	*  on its port and a capture of several rooms cannot be replayed.
+	*/
+	class DatagramCapture
+	{
+	public:
+		~DatagramCapture();
+
+		/** Sockets created by Socket::create from now on are captured to path
+		*   @return false when the file could not be created */
+		static bool start(const std::string& path);
+
+		/** Sockets created from now on are not captured, the file is closed
+		*   once the last captured socket is destroyed */
+		static void stop();
+
+		/** @return the capture new sockets write to, nullptr when stopped */
+		static std::shared_ptr<DatagramCapture> getActive();
+
+		void write(uint16_t localPort, CaptureDirection direction, const Address& address,
+			const char* data, int32_t length);
+
+	private:
+		DatagramCapture();
+
+		std::mutex    m_mutex;
+		std::ofstream m_file;
+		uint64_t      m_numRecords;
+		std::chrono::steady_clock::time_point m_startTime;
+	};
+
+	/* CaptureReader
+	*  Reads the records of a file written by DatagramCapture in order.
+	*/
+	class CaptureReader
+	{
+	public:
+		CaptureReader();
+
+		/** @return false when path is not a capture file */
+		bool open(const std::string& path);
+		bool isOpen() const { return m_file.is_open(); }
+
+		/** @return false at the end of the file or on a damaged record */
+		bool read(CaptureRecord& record);
+
+	private:
+		std::ifstream m_file;
+	};
+
+}; // namespace network
@@ -0,0 +1,89 @@
+#include "datagram_queue.h"
+
+#include <core/debug.h>
+
+#include <cstring>
+
+using namespace network;
+
+DatagramQueue::DatagramQueue() :
+	m_numDatagrams(0),
+	m_bytesSent(0),
+	m_packetsSent(0)
+{
+}
+
+DatagramQueue::~DatagramQueue()
+{
+	ASSERT(m_numDatagrams == 0, "DatagramQueue destroyed before it was flushed");
+}
+
+void DatagramQueue::flushTo(Socket* socket)
+{
+	ASSERT(socket != nullptr);
+	if (m_numDatagrams > 0)
+	{
+		socket->sendBatch(m_datagrams.data(), m_numDatagrams);
+		m_numDatagrams = 0;
+	}
+}
+
+bool DatagramQueue::initialize(uint16_t /*port*/)
+{
+	return true;
+}
+
+bool DatagramQueue::isInitialized() const
+{
+	return true;
+}
+
+bool DatagramQueue::receive(Address& /*address*/, char* /*buffer*/, int32_t& /*length*/)
+{
+	ASSERT(false, "DatagramQueue only sends");
+	return false;
+}
+
+bool DatagramQueue::send(const Address& address, const void* buffer, const size_t length)
+{
+	ASSERT(length <= static_cast<size_t>(g_maxDatagramSize), "Datagram exceeds g_maxDatagramSize");
+
+	if (m_numDatagrams == static_cast<int32_t>(m_datagrams.size()))
+	{
+		m_datagrams.emplace_back();
+	}
+
+	Datagram& datagram = m_datagrams[m_numDatagrams++];
+	datagram.address = address;
+	datagram.length  = static_cast<int32_t>(length);
+	memcpy(datagram.data, buffer, length);
+
+	m_bytesSent += length;
+	m_packetsSent++;
+	return true;
+}
+
+uint32_t DatagramQueue::getPort() const
+{
+	return 0;
+}
+
+uint64_t DatagramQueue::getBytesReceived() const
+{
+	return 0;
+}
+
+uint64_t DatagramQueue::getBytesSent() const
+{
+	return m_bytesSent;
+}
+
+uint64_t DatagramQueue::getPacketsReceived() const
+{
+	return 0;
+}
+
+uint64_t DatagramQueue::getPacketsSent() const
+{
+	return m_packetsSent;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <network/socket.h>
+
+#include <vector>
+
+namespace network
+{
+	/* DatagramQueue
+	*  Socket that keeps what is sent through it, so a connection can build
+	*  and encode its packets on a send worker while the real socket is only
+	*  used by the game thread, which hands the datagrams over with flushTo().
+	*/
+	class DatagramQueue : public Socket
+	{
+	public:
+		DatagramQueue();
+		~DatagramQueue();
+
+		/** Sends the queued datagrams through socket in the order they were queued */
+		void flushTo(Socket* socket);
+
+		int32_t getCount() const { return m_numDatagrams; }
+
+		bool initialize(uint16_t port) override;
+		bool isInitialized()     const override;
+
+		bool receive(Address& address, char* buffer, int32_t& length) override;
+		bool send(const Address& address, const void* buffer, const size_t length) override;
+
+		uint32_t getPort()            const override;
+		uint64_t getBytesReceived()   const override;
+		uint64_t getBytesSent()       const override;
+		uint64_t getPacketsReceived() const override;
+		uint64_t getPacketsSent()     const override;
+
+	private:
+		/* Grows to the most datagrams one connection sent in a frame, and stays */
+		std::vector<Datagram> m_datagrams;
+		int32_t               m_numDatagrams;
+		uint64_t              m_bytesSent;
+		uint64_t              m_packetsSent;
+	};
+
+}; // namespace network
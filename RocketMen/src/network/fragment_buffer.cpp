@@ -0,0 +1,143 @@
+#include "fragment_buffer.h"
+
+#include <core/debug.h>
+#include <network/network_metrics.h>
+#include <network/packet.h>
+
+#include <cstring>
+
+using namespace network;
+
+static_assert(g_maxFragmentsPerPacket <= 32, "Received fragments are tracked in a 32-bit mask");
+
+FragmentBuffer::FragmentBuffer(int32_t numSets) :
+	m_sets(new FragmentSet[numSets]),
+	m_numSets(numSets),
+	m_numDropped(0)
+{
+	ASSERT(numSets > 0);
+	for (int32_t i = 0; i < m_numSets; i++)
+	{
+		m_sets[i].isUsed = false;
+		m_sets[i].data   = new char[g_maxPacketSize];
+	}
+}
+
+FragmentBuffer::~FragmentBuffer()
+{
+	for (int32_t i = 0; i < m_numSets; i++)
+	{
+		delete[] m_sets[i].data;
+	}
+	delete[] m_sets;
+}
+
+bool FragmentBuffer::addFragment(const Address& address, Sequence sequence, int32_t fragmentId, int32_t numFragments,
+	const char* data, int32_t length, const char*& packetData, int32_t& packetLength)
+{
+	ASSERT(data != nullptr);
+
+	// Every fragment but the last is full, so its offset follows from its id
+	const bool isLast = fragmentId == numFragments - 1;
+	if (numFragments < 2 || numFragments > g_maxFragmentsPerPacket
+		|| fragmentId < 0 || fragmentId >= numFragments
+		|| length <= 0 || length > g_fragmentSize
+		|| (!isLast && length != g_fragmentSize))
+	{
+		return false;
+	}
+
+	FragmentSet* set = findSet(address, sequence);
+	if (set == nullptr)
+	{
+		set = allocateSet(address, sequence, numFragments);
+	}
+
+	const uint32_t fragmentBit = 1u << fragmentId;
+	if (set->numFragments != numFragments || (set->receivedMask & fragmentBit) != 0)
+	{
+		return false;
+	}
+
+	memcpy(set->data + fragmentId * g_fragmentSize, data, length);
+	set->receivedMask |= fragmentBit;
+	set->numReceived++;
+	if (isLast)
+	{
+		set->length = fragmentId * g_fragmentSize + length;
+	}
+
+	if (set->numReceived < set->numFragments)
+	{
+		return false;
+	}
+
+	set->isUsed  = false;
+	packetData   = set->data;
+	packetLength = set->length;
+	return true;
+}
+
+void FragmentBuffer::update(int32_t maxAge)
+{
+	for (int32_t i = 0; i < m_numSets; i++)
+	{
+		FragmentSet& set = m_sets[i];
+		if (set.isUsed && ++set.age > maxAge)
+		{
+			LOG_DEBUG("FragmentBuffer: dropped packet %d from %s, %d/%d fragments received",
+				set.sequence, set.address.toString().c_str(), set.numReceived, set.numFragments);
+			set.isUsed = false;
+			m_numDropped++;
+			NetworkMetrics::get().droppedFragmentedPackets.add();
+		}
+	}
+}
+
+FragmentBuffer::FragmentSet* FragmentBuffer::findSet(const Address& address, Sequence sequence)
+{
+	for (int32_t i = 0; i < m_numSets; i++)
+	{
+		FragmentSet& set = m_sets[i];
+		if (set.isUsed && set.sequence == sequence && set.address == address)
+		{
+			return &set;
+		}
+	}
+	return nullptr;
+}
+
+FragmentBuffer::FragmentSet* FragmentBuffer::allocateSet(const Address& address, Sequence sequence, int32_t numFragments)
+{
+	// Take a free set, or make room by dropping the oldest partial packet
+	FragmentSet* set = &m_sets[0];
+	for (int32_t i = 0; i < m_numSets; i++)
+	{
+		if (!m_sets[i].isUsed)
+		{
+			set = &m_sets[i];
+			break;
+		}
+
+		if (m_sets[i].age > set->age)
+		{
+			set = &m_sets[i];
+		}
+	}
+
+	if (set->isUsed)
+	{
+		m_numDropped++;
+		NetworkMetrics::get().droppedFragmentedPackets.add();
+	}
+
+	set->address      = address;
+	set->sequence     = sequence;
+	set->numFragments = numFragments;
+	set->numReceived  = 0;
+	set->receivedMask = 0;
+	set->length       = 0;
+	set->age          = 0;
+	set->isUsed       = true;
+	return set;
+}
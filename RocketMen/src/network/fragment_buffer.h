@@ -0,0 +1,53 @@
+#pragma once
+
+#include <common.h>
+#include <network/address.h>
+
+namespace network
+{
+	/* FragmentBuffer
+	*  Reassembles packets that were split in fragments by NetworkChannel.
+	*  Holds a bounded number of partial packets; sets that stay incomplete
+	*  for too long, or are the oldest when a new set needs room, are dropped.
+	*/
+	class FragmentBuffer
+	{
+	public:
+		FragmentBuffer(int32_t numSets);
+		~FragmentBuffer();
+
+		/** Stores one fragment of the packet sequence sent from address
+		*   @param packetData    Points to the reassembled packet once complete,
+		*                        valid until the next call
+		*   @return true when this fragment completed its packet */
+		bool addFragment(const Address& address, Sequence sequence, int32_t fragmentId, int32_t numFragments,
+			const char* data, int32_t length, const char*& packetData, int32_t& packetLength);
+
+		/** Ages partial packets, dropping the ones older than maxAge updates */
+		void update(int32_t maxAge);
+
+		int32_t getNumDropped() const { return m_numDropped; }
+
+	private:
+		struct FragmentSet
+		{
+			Address  address;
+			Sequence sequence;
+			int32_t  numFragments;
+			int32_t  numReceived;
+			uint32_t receivedMask;
+			int32_t  length;
+			int32_t  age;
+			bool     isUsed;
+			char*    data;
+		};
+
+		FragmentSet* findSet(const Address& address, Sequence sequence);
+		FragmentSet* allocateSet(const Address& address, Sequence sequence, int32_t numFragments);
+
+		FragmentSet* m_sets;
+		int32_t      m_numSets;
+		int32_t      m_numDropped;
+	};
+
+}; // namespace network
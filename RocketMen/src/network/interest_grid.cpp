@@ -0,0 +1,119 @@
+#include "interest_grid.h"
+
+#include <core/debug.h>
+#include <core/entity.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace network;
+
+InterestGrid::InterestGrid() :
+	m_origin(0.0f, 0.0f),
+	m_cellSize(0.0f),
+	m_numCellsX(0),
+	m_numCellsY(0)
+{
+}
+
+InterestGrid::~InterestGrid()
+{
+}
+
+void InterestGrid::initialize(uint32_t width, uint32_t height, float cellSize)
+{
+	ASSERT(width > 0 && height > 0, "Interest area cannot be empty");
+	ASSERT(cellSize > 0.0f, "Cell size must be positive");
+
+	m_origin    = Vector2(-0.5f * width, -0.5f * height);
+	m_cellSize  = cellSize;
+	m_numCellsX = std::max(1, static_cast<int32_t>(ceil(width / cellSize)));
+	m_numCellsY = std::max(1, static_cast<int32_t>(ceil(height / cellSize)));
+
+	m_cellStarts.assign(m_numCellsX * m_numCellsY + 1, 0);
+	m_cellEntities.clear();
+}
+
+bool InterestGrid::isInitialized() const
+{
+	return m_numCellsX > 0;
+}
+
+void InterestGrid::update()
+{
+	ASSERT(isInitialized());
+
+	// Counting sort of entities into their cells
+	std::fill(m_cellStarts.begin(), m_cellStarts.end(), 0);
+	m_cellEntities.clear();
+
+	std::vector<int32_t> entityCells;
+	auto& entities = EntityManager::getEntities();
+	for (Entity* entity : entities)
+	{
+		if (entity->isReplicated())
+		{
+			const int32_t networkId = entity->getNetworkId();
+			const Vector2 position = entity->getTransform().getWorldPosition();
+			const int32_t cell = getCellX(position.x) + getCellY(position.y) * m_numCellsX;
+
+			m_positions[networkId] = position;
+			m_cellStarts[cell + 1]++;
+			m_cellEntities.push_back(networkId);
+			entityCells.push_back(cell);
+		}
+	}
+
+	for (size_t i = 1; i < m_cellStarts.size(); i++)
+	{
+		m_cellStarts[i] += m_cellStarts[i - 1];
+	}
+
+	std::vector<int32_t> cellFill(m_cellStarts.begin(), m_cellStarts.end() - 1);
+	std::vector<int32_t> sorted(m_cellEntities.size());
+	for (size_t i = 0; i < m_cellEntities.size(); i++)
+	{
+		sorted[cellFill[entityCells[i]]++] = m_cellEntities[i];
+	}
+	m_cellEntities.swap(sorted);
+}
+
+void InterestGrid::query(const Vector2& position, float radius, RelevanceMask& mask) const
+{
+	ASSERT(isInitialized());
+
+	const int32_t minX = getCellX(position.x - radius);
+	const int32_t maxX = getCellX(position.x + radius);
+	const int32_t minY = getCellY(position.y - radius);
+	const int32_t maxY = getCellY(position.y + radius);
+	const float radiusSquared = radius * radius;
+
+	for (int32_t y = minY; y <= maxY; y++)
+	{
+		for (int32_t x = minX; x <= maxX; x++)
+		{
+			const int32_t cell = x + y * m_numCellsX;
+			for (int32_t i = m_cellStarts[cell]; i < m_cellStarts[cell + 1]; i++)
+			{
+				const int32_t networkId = m_cellEntities[i];
+				const Vector2 delta = m_positions[networkId] - position;
+				if (delta.x * delta.x + delta.y * delta.y <= radiusSquared)
+				{
+					mask.set(networkId);
+				}
+			}
+		}
+	}
+}
+
+int32_t InterestGrid::getCellX(float x) const
+{
+	const int32_t cell = static_cast<int32_t>(floor((x - m_origin.x) / m_cellSize));
+	return std::max(0, std::min(cell, m_numCellsX - 1));
+}
+
+int32_t InterestGrid::getCellY(float y) const
+{
+	const int32_t cell = static_cast<int32_t>(floor((y - m_origin.y) / m_cellSize));
+	return std::max(0, std::min(cell, m_numCellsY - 1));
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <common.h>
+#include <core/entity_manager.h>
+#include <network/world_state.h>
+
+#include <vector>
+
+namespace network
+{
+	/* InterestGrid
+	*  Buckets replicated entities into uniform cells covering the loaded map,
+	*  so the entities around a position are found without visiting the rest
+	*  of the world.
+	*/
+	class InterestGrid
+	{
+	public:
+		InterestGrid();
+		~InterestGrid();
+
+		/** Covers a map of width x height tiles centered on the origin, laid out
+		*   the way Physics::loadCollisionFromTilemap places tiles */
+		void initialize(uint32_t width, uint32_t height, float cellSize);
+		bool isInitialized() const;
+
+		/** Rebuilds the cells from the replicated entities in EntityManager */
+		void update();
+
+		/** Marks every entity within radius of position in mask */
+		void query(const Vector2& position, float radius, RelevanceMask& mask) const;
+
+	private:
+		int32_t getCellX(float x) const;
+		int32_t getCellY(float y) const;
+
+		Vector2 m_origin;
+		float   m_cellSize;
+		int32_t m_numCellsX;
+		int32_t m_numCellsY;
+
+		/* Entities sorted by cell, cell i spans [m_cellStarts[i], m_cellStarts[i + 1]) */
+		std::vector<int32_t> m_cellStarts;
+		std::vector<int32_t> m_cellEntities;
+		Vector2              m_positions[s_maxNetworkedEntities];
+	};
+
+}; // namespace network
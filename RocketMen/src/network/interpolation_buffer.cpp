@@ -0,0 +1,200 @@
+#include "interpolation_buffer.h"
+
+#include <core/debug.h>
+#include <utility/utility.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace network;
+
+static const double s_ageGain       = 1.0 / 8.0;
+static const double s_deviationGain = 1.0 / 4.0;
+static const double s_intervalGain  = 1.0 / 8.0;
+
+/* Delay kept as margin against jitter, in deviations */
+static const double s_jitterMargin  = 2.0;
+
+/* Playback runs at most this much faster or slower to reach the target delay,
+*  further off than s_maxDelayError frames the delay is reset at once */
+static const double s_maxTimeScale  = 0.05;
+static const double s_maxDelayError = 30.0;
+
+InterpolationBuffer::InterpolationBuffer() :
+	m_snapshots(new Snapshot[s_maxInterpolationSnapshots])
+{
+	clear();
+}
+
+InterpolationBuffer::~InterpolationBuffer()
+{
+	delete[] m_snapshots;
+}
+
+void InterpolationBuffer::clear()
+{
+	m_numSnapshots = 0;
+	m_lastAdded    = INDEX_NONE;
+	m_age          = 0.0;
+	m_ageDeviation = 0.0;
+	m_interval     = 0.0;
+	m_delay        = 0.0;
+	m_hasAge       = false;
+	m_hasDelay     = false;
+	m_numLate      = 0;
+}
+
+bool InterpolationBuffer::addSnapshot(Sequence frame, double serverFrame)
+{
+	m_lastAdded = INDEX_NONE;
+
+	// Snapshot frames wrap, place them next to the server frame they arrived at
+	const Sequence currentFrame = static_cast<Sequence>(static_cast<int64_t>(std::floor(serverFrame)));
+	const double snapshotFrame = std::floor(serverFrame) + sequenceDifference(frame, currentFrame);
+
+	if (snapshotFrame < getRenderFrame(serverFrame))
+	{
+		m_numLate++;
+	}
+
+	// Smoothed like a round trip time, RFC 6298
+	const double age = serverFrame - snapshotFrame;
+	if (!m_hasAge)
+	{
+		m_age = age;
+		m_ageDeviation = age / 2.0;
+		m_hasAge = true;
+	}
+	else
+	{
+		m_ageDeviation += (std::abs(age - m_age) - m_ageDeviation) * s_deviationGain;
+		m_age += (age - m_age) * s_ageGain;
+	}
+
+	if (m_numSnapshots > 0)
+	{
+		const double newest = m_snapshots[m_numSnapshots - 1].frame;
+		if (snapshotFrame > newest)
+		{
+			const double interval = snapshotFrame - newest;
+			m_interval = (m_interval == 0.0) ? interval : m_interval + (interval - m_interval) * s_intervalGain;
+		}
+	}
+
+	int32_t index = m_numSnapshots;
+	while (index > 0 && m_snapshots[index - 1].frame >= snapshotFrame)
+	{
+		if (m_snapshots[index - 1].frame == snapshotFrame)
+		{
+			return false;
+		}
+		index--;
+	}
+
+	if (m_numSnapshots == s_maxInterpolationSnapshots)
+	{
+		if (index == 0)
+		{
+			return false;
+		}
+
+		// Drop the oldest snapshot
+		std::rotate(m_snapshots, m_snapshots + 1, m_snapshots + index);
+		index--;
+	}
+	else
+	{
+		std::rotate(m_snapshots + index, m_snapshots + m_numSnapshots, m_snapshots + m_numSnapshots + 1);
+		m_numSnapshots++;
+	}
+
+	Snapshot& snapshot = m_snapshots[index];
+	snapshot.frame = snapshotFrame;
+	snapshot.entities.reset();
+	m_lastAdded = index;
+	return true;
+}
+
+void InterpolationBuffer::setEntity(int32_t networkId, const Vector2& position, float rotation)
+{
+	ASSERT(networkId >= 0 && networkId < s_maxNetworkedEntities);
+	if (m_lastAdded == INDEX_NONE)
+	{
+		return;
+	}
+
+	Snapshot& snapshot = m_snapshots[m_lastAdded];
+	snapshot.entities.set(networkId);
+	snapshot.positions[networkId] = position;
+	snapshot.rotations[networkId] = rotation;
+}
+
+void InterpolationBuffer::update(double deltaFrames)
+{
+	if (m_numSnapshots < 2)
+	{
+		return;
+	}
+
+	const double target = getTargetDelay();
+	if (!m_hasDelay || std::abs(target - m_delay) > s_maxDelayError)
+	{
+		m_delay = target;
+		m_hasDelay = true;
+		return;
+	}
+
+	const double maxStep = deltaFrames * s_maxTimeScale;
+	m_delay += std::min(std::max(target - m_delay, -maxStep), maxStep);
+}
+
+bool InterpolationBuffer::sample(double frame, int32_t networkId, Vector2& position, float& rotation) const
+{
+	ASSERT(networkId >= 0 && networkId < s_maxNetworkedEntities);
+
+	const Snapshot* from = nullptr;
+	const Snapshot* to = nullptr;
+	for (int32_t i = 0; i < m_numSnapshots; i++)
+	{
+		const Snapshot& snapshot = m_snapshots[i];
+		if (!snapshot.entities.test(networkId))
+		{
+			continue;
+		}
+
+		if (snapshot.frame <= frame)
+		{
+			from = &snapshot;
+		}
+		else
+		{
+			to = &snapshot;
+			break;
+		}
+	}
+
+	// Hold the nearest state when frame is outside the buffered snapshots
+	if (from == nullptr || to == nullptr)
+	{
+		const Snapshot* nearest = (from != nullptr) ? from : to;
+		if (nearest == nullptr)
+		{
+			return false;
+		}
+
+		position = nearest->positions[networkId];
+		rotation = nearest->rotations[networkId];
+		return true;
+	}
+
+	const float alpha = static_cast<float>((frame - from->frame) / (to->frame - from->frame));
+	position = glm::mix(from->positions[networkId], to->positions[networkId], alpha);
+	rotation = lerpAngle(from->rotations[networkId], to->rotations[networkId], alpha);
+	return true;
+}
+
+double InterpolationBuffer::getTargetDelay() const
+{
+	// The snapshot after the render frame has to have arrived, which takes its age plus a snapshot interval
+	return m_age + m_interval + m_ageDeviation * s_jitterMargin;
+}
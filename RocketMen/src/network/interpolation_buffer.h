@@ -0,0 +1,76 @@
+#pragma once
+
+#include <common.h>
+#include <core/entity_manager.h>
+
+#include <bitset>
+
+namespace network
+{
+	static const int32_t s_maxInterpolationSnapshots = 16;
+
+	/* InterpolationBuffer
+	*  Transforms of the replicated entities at each received snapshot, by the
+	*  server frame the snapshot was taken at. Entities are drawn at a frame
+	*  some delay behind the estimated server frame, interpolated between the
+	*  two snapshots around it. The delay follows how late and how irregular
+	*  snapshots arrive, so late snapshots still land before they are needed.
+	*  Frames are unwrapped, see ClockSync::getServerFrame.
+	*/
+	class InterpolationBuffer
+	{
+	public:
+		InterpolationBuffer();
+		~InterpolationBuffer();
+
+		void clear();
+
+		/** Adds the snapshot taken at frame, received at serverFrame
+		*   @return false if the snapshot is a duplicate or older than all
+		*   buffered ones, its entities are not stored */
+		bool addSnapshot(Sequence frame, double serverFrame);
+
+		/** Stores the transform networkId has in the snapshot last added */
+		void setEntity(int32_t networkId, const Vector2& position, float rotation);
+
+		/** Moves the interpolation delay towards its target, speeding up or
+		*   slowing down playback by a few percent at most
+		*   @param deltaFrames  Frames passed since the last update */
+		void update(double deltaFrames);
+
+		/** Interpolated transform of networkId at frame
+		*   @return false if no snapshot holds networkId */
+		bool sample(double frame, int32_t networkId, Vector2& position, float& rotation) const;
+
+		double  getRenderFrame(double serverFrame) const { return serverFrame - m_delay; }
+		double  getDelay()                         const { return m_delay; }
+		double  getTargetDelay()                   const;
+		int32_t getNumSnapshots()                  const { return m_numSnapshots; }
+		int32_t getNumLate()                       const { return m_numLate; }
+
+	private:
+		struct Snapshot
+		{
+			double frame;
+			std::bitset<s_maxNetworkedEntities> entities;
+			Vector2 positions[s_maxNetworkedEntities];
+			float   rotations[s_maxNetworkedEntities];
+		};
+
+		/* Snapshots ordered by frame, oldest first */
+		Snapshot* m_snapshots;
+		int32_t   m_numSnapshots;
+		int32_t   m_lastAdded;
+
+		/* Smoothed age of snapshots on arrival, its deviation, and the spacing
+		*  between snapshots, in frames */
+		double    m_age;
+		double    m_ageDeviation;
+		double    m_interval;
+		double    m_delay;
+		bool      m_hasAge;
+		bool      m_hasDelay;
+		int32_t   m_numLate;
+	};
+
+}; // namespace network
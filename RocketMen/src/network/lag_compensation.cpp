@@ -0,0 +1,137 @@
+#include "lag_compensation.h"
+
+#include <core/debug.h>
+#include <core/entity.h>
+#include <core/entity_manager.h>
+#include <utility/utility.h>
+
+using namespace network;
+
+LagCompensation::LagCompensation(int32_t numFrames) :
+	m_frames(numFrames),
+	m_isRewound(false)
+{
+	clear();
+}
+
+void LagCompensation::clear()
+{
+	ASSERT(!m_isRewound, "LagCompensation cleared while rewound");
+
+	m_lastFrame    = 0;
+	m_hasFrame     = false;
+	m_isRewound    = false;
+	m_rewindFrames = 0.0f;
+	m_rewound.reset();
+}
+
+void LagCompensation::record(Sequence frame)
+{
+	ASSERT(!m_isRewound, "Poses recorded while rewound");
+
+	FramePoses* entry = m_frames.insert(frame);
+	if (entry == nullptr)
+	{
+		return;
+	}
+
+	entry->entities.reset();
+	for (Entity* entity : EntityManager::getEntities())
+	{
+		if (!entity->isReplicated() || !entity->isAlive())
+		{
+			continue;
+		}
+
+		const int32_t networkId = entity->getNetworkId();
+		Transform2D& transform = entity->getTransform();
+		entry->entities.set(networkId);
+		entry->poses[networkId].position = transform.getLocalPosition();
+		entry->poses[networkId].rotation = transform.getLocalRotation();
+	}
+
+	m_lastFrame = frame;
+	m_hasFrame  = true;
+}
+
+bool LagCompensation::rewind(Sequence frame, float fraction, const std::function<bool(Entity*)>& exclude)
+{
+	ASSERT(!m_isRewound, "LagCompensation is already rewound");
+
+	if (!m_hasFrame || sequenceGreaterThan(frame, m_lastFrame))
+	{
+		return false;
+	}
+
+	const FramePoses* from = m_frames.getEntry(frame);
+	const FramePoses* to = (frame != m_lastFrame) ? m_frames.getEntry(static_cast<Sequence>(frame + 1)) : nullptr;
+	if (from == nullptr || sequenceDifference(m_lastFrame, frame) >= m_frames.getSize())
+	{
+		return false;
+	}
+
+	if (to == nullptr)
+	{
+		fraction = 0.0f;
+	}
+
+	m_rewound.reset();
+	for (Entity* entity : EntityManager::getEntities())
+	{
+		if (!entity->isReplicated() || exclude(entity))
+		{
+			continue;
+		}
+
+		const int32_t networkId = entity->getNetworkId();
+		if (!from->entities.test(networkId))
+		{
+			continue;
+		}
+
+		Pose pose = from->poses[networkId];
+		if (to != nullptr && to->entities.test(networkId))
+		{
+			pose.position = glm::mix(pose.position, to->poses[networkId].position, fraction);
+			pose.rotation = lerpAngle(pose.rotation, to->poses[networkId].rotation, fraction);
+		}
+
+		Transform2D& transform = entity->getTransform();
+		m_current[networkId].position = transform.getLocalPosition();
+		m_current[networkId].rotation = transform.getLocalRotation();
+		m_rewound.set(networkId);
+
+		transform.setLocalPosition(pose.position);
+		transform.setLocalRotation(pose.rotation);
+	}
+
+	m_isRewound    = true;
+	m_rewindFrames = sequenceDifference(m_lastFrame, frame) - fraction;
+	return true;
+}
+
+void LagCompensation::restore()
+{
+	ASSERT(m_isRewound, "LagCompensation is not rewound");
+
+	for (int32_t networkId = 0; networkId < s_maxNetworkedEntities; networkId++)
+	{
+		if (!m_rewound.test(networkId))
+		{
+			continue;
+		}
+
+		// Entities can be destroyed by the input that was executed
+		Entity* entity = EntityManager::findNetworkedEntity(networkId);
+		if (entity != nullptr)
+		{
+			Transform2D& transform = entity->getTransform();
+			transform.setLocalPosition(m_current[networkId].position);
+			transform.setLocalRotation(m_current[networkId].rotation);
+		}
+	}
+
+	m_rewound.reset();
+	m_isRewound    = false;
+	m_rewindFrames = 0.0f;
+}
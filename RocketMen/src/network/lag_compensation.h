@@ -0,0 +1,68 @@
+#pragma once
+
+#include <common.h>
+#include <core/entity_manager.h>
+#include <network/sequence_buffer.h>
+
+#include <bitset>
+#include <functional>
+
+namespace network
+{
+	/* LagCompensation
+	*  Poses of the replicated entities at each recent server frame. Input of
+	*  a player is executed with the world rewound to the frame that player was
+	*  looking at, so hit tests match what was on their screen. Recording only
+	*  copies a position and angle per entity.
+	*/
+	class LagCompensation
+	{
+	public:
+		/** @param numFrames  Frames of history, the furthest a world is rewound */
+		LagCompensation(int32_t numFrames);
+
+		void clear();
+
+		/** Records the poses entities ended frame with */
+		void record(Sequence frame);
+
+		/** Moves entities to their poses at frame, interpolated between the
+		*   recorded frames around it, until restore
+		*   @param frame    Server frame with the fraction of the next one
+		*   @param exclude  Entities that stay where they are, e.g. the player's own
+		*   @return false if frame is not within the history */
+		bool rewind(Sequence frame, float fraction, const std::function<bool(Entity*)>& exclude);
+
+		/** Moves the rewound entities back to their current poses */
+		void restore();
+
+		bool  isRewound()       const { return m_isRewound; }
+
+		/** @return frames between the rewound and the current poses */
+		float getRewindFrames() const { return m_rewindFrames; }
+
+	private:
+		struct Pose
+		{
+			Vector2 position;
+			float   rotation;
+		};
+
+		struct FramePoses
+		{
+			std::bitset<s_maxNetworkedEntities> entities;
+			Pose poses[s_maxNetworkedEntities];
+		};
+
+		SequenceBuffer<FramePoses> m_frames;
+		Sequence m_lastFrame;
+		bool     m_hasFrame;
+
+		/* Current poses of the rewound entities */
+		std::bitset<s_maxNetworkedEntities> m_rewound;
+		Pose     m_current[s_maxNetworkedEntities];
+		bool     m_isRewound;
+		float    m_rewindFrames;
+	};
+
+}; // namespace network
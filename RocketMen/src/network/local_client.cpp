@@ -8,18 +8,31 @@
 #include <core/input.h>
 #include <core/debug.h>
 #include <core/game_time.h>
+#include <core/room.h>
 #include <network/network.h>
 #include <network/address.h>
+#include <network/loopback_socket.h>
 #include <network/packet_receiver.h>
 #include <network/server.h>
 #include <network/socket.h>
 #include <network/server/message_factory_server.h>
+#include <physics/physics.h>
 #include <utility/utility.h>
 
+#include <cmath>
+
 using namespace network;
 
 static ActionBuffer s_playerActions[s_maxPlayersPerClient];
 
+/* Prediction errors below these are left alone instead of replayed */
+static const float s_maxPositionError = 0.05f;
+static const float s_maxVelocityError = 0.5f;
+
+/* Upper bound of one frame of encoded input for all players: the unchanged bit,
+*  the action count, and an index, axis bit and 10-bit value per action */
+static const int32_t s_maxInputFrameBytes = (s_maxPlayersPerClient * (1 + 5 + s_maxActions * (6 + 1 + 10)) + 7) / 8;
+
 //=============================================================================
 
 LocalClient::LocalClient(Game* game) :
@@ -32,15 +45,35 @@ LocalClient::LocalClient(Game* game) :
 	m_state(State::Disconnected),
 	m_timeSinceLastInputMessage(0.0f),
 	m_maxInputMessageSentTime(0.05f),
-	m_timeSinceLastClockSync(0.f),
-	m_clockResyncTime(5.f),
 	m_packetReceiver(new PacketReceiver(64)),
 	m_requestedEntities(s_maxSpawnPredictedEntities),
 	m_localPlayers(s_maxPlayersPerClient),
+	m_numActionsRegistered(0),
+	m_correctionFrame(0),
+	m_hasCorrection(false),
+	m_numReplays(0),
+	m_localTime(0),
+	m_worldStates(s_snapshotHistorySize),
 	m_tempNetworkIdManager(s_maxSpawnPredictedEntities)
 {
 	clearSession();
-	m_socket = Socket::create();
+
+	// A room replaying a capture provides the socket
+	if (Socket* roomSocket = Room::getCurrent()->createSocket())
+	{
+		m_socket = roomSocket;
+	}
+	else if (Network::getLocalServer() != nullptr)
+	{
+		// Listen server in this process, talk to it through memory
+		LoopbackSocket* socket = new LoopbackSocket(Socket::create());
+		socket->setPassMessages(s_loopbackPassMessages);
+		m_socket = socket;
+	}
+	else
+	{
+		m_socket = Socket::create();
+	}
 	ASSERT(m_socket != nullptr, "Failed to create valid socket instance");
 }
 
@@ -66,9 +99,10 @@ void LocalClient::update(const Time& time)
 
 	ASSERT(m_connection != nullptr);
 	m_timeSinceLastInputMessage += deltaTime;
+	m_localTime = time.getMicroSeconds();
 
 	const State prevState = m_state;
-	receivePackets();
+	receivePackets(time);
 	if (m_state != prevState)
 	{
 		return;
@@ -78,6 +112,7 @@ void LocalClient::update(const Time& time)
 
 	if (m_state == State::Connected)
 	{
+		interpolateEntities(time);
 		readInput();
 
 		if (m_timeSinceLastInputMessage >= m_maxInputMessageSentTime)
@@ -90,10 +125,10 @@ void LocalClient::update(const Time& time)
 			}
 		}
 
-		if (m_timeSinceLastClockSync > m_clockResyncTime)
+		if (m_clockSync.needsSample(m_localTime))
 		{
 			requestServerTime(time);
-		}		
+		}
 	}
 
 	sendPendingMessages(time);
@@ -128,6 +163,41 @@ void LocalClient::tick(Sequence frameCounter)
 	m_lastFrameSimulated = frameCounter;
 }
 
+void LocalClient::predict(float fixedDeltaTime, Physics* physics)
+{
+	ASSERT(physics != nullptr);
+
+	if (!isPredicting())
+	{
+		return;
+	}
+
+	// Only the predicted bodies move, the others are placed by snapshots
+	for (Entity* entity : EntityManager::getEntities())
+	{
+		Rigidbody* rigidbody = entity->getTransform().getRigidbody();
+		if (rigidbody == nullptr || !entity->isReplicated())
+		{
+			continue;
+		}
+
+		const bool isPredicted = Network::isLocalPlayer(entity->getOwnerPlayerId());
+		rigidbody->setKinematic(!isPredicted);
+		if (!isPredicted)
+		{
+			rigidbody->setLinearVelocity(Vector2(0.0f));
+		}
+	}
+
+	reconcile(fixedDeltaTime, physics);
+	physics->step(fixedDeltaTime);
+
+	if (Frame* frame = m_clientHistory.getFrame(m_lastFrameSimulated))
+	{
+		recordPrediction(*frame);
+	}
+}
+
 void LocalClient::sendPlayerActions()
 {
 	const int32_t numFramesToSend = sequenceDifference(m_lastFrameSimulated, m_lastFrameSent);
@@ -136,11 +206,23 @@ void LocalClient::sendPlayerActions()
 		message::PlayerInput* message = dynamic_cast<message::PlayerInput*>(m_messageFactory.createMessage(MessageType::PlayerInput));
 		const int32_t startFromFrame = static_cast<int32_t>(m_lastFrameSent + 1);
 
-		message->numFrames = numFramesToSend;
 		message->startFrame = startFromFrame;
 		message->numPlayers = m_localPlayers.getCount();
 
+		// Lets the server execute the actions against the world we are drawing
+		if (m_clockSync.isSynchronized() && m_interpolation.getNumSnapshots() > 0)
+		{
+			const double viewFrame = m_interpolation.getRenderFrame(
+				m_clockSync.getServerFrame(m_localTime, m_game->getTimestep()));
+			message->hasViewFrame = true;
+			message->viewFrame    = static_cast<Sequence>(static_cast<int64_t>(std::floor(viewFrame)));
+			message->viewFraction = static_cast<float>(viewFrame - std::floor(viewFrame));
+		}
+
+		registerActions(static_cast<Sequence>(startFromFrame), numFramesToSend);
+
 		WriteStream stream(message::PlayerInput::maxDataLength);
+		const Frame* previousFrame = nullptr;
 		for (int16_t i = 0; i < numFramesToSend; i++)
 		{
 			const Sequence frameId = static_cast<Sequence>(startFromFrame) + i;
@@ -148,30 +230,62 @@ void LocalClient::sendPlayerActions()
 			ASSERT(frame != nullptr);
 			for (int32_t j = 0; j < message->numPlayers; j++)
 			{
-				frame->actions[j].serialize(stream);
-				frame->actions[j].clear();
+				frame->actions[j].serialize(stream, m_actionDictionary,
+					(previousFrame != nullptr) ? &previousFrame->actions[j] : nullptr);
 			}
+			previousFrame = frame;
 			m_lastFrameSent = frameId;
-			if (stream.getBufferSize() - stream.getDataLength() < 32)
+			message->numFrames = i + 1;
+			if (stream.getBufferSize() - stream.getDataLength() < s_maxInputFrameBytes)
 			{
 				break;
 			}
 		}
 
 		stream.flush();
-		ASSERT(stream.getDataLength() < message::PlayerInput::maxDataLength);
-		memcpy(message->data, stream.getData(), stream.getDataLength());
-		message->dataLength = stream.getDataLength();
+		message->dataLength = roundTo(stream.getDataLength(), 4);
+		ASSERT(message->dataLength <= message::PlayerInput::maxDataLength);
+		memcpy(message->data, stream.getData(), message->dataLength);
 
 		sendMessage(message);
 	}
 }
 
+void LocalClient::registerActions(Sequence fromFrame, int32_t numFrames)
+{
+	for (int32_t i = 0; i < numFrames; i++)
+	{
+		const Frame* frame = m_clientHistory.getFrame(static_cast<Sequence>(fromFrame + i));
+		ASSERT(frame != nullptr);
+		for (uint32_t j = 0; j < m_localPlayers.getCount(); j++)
+		{
+			for (const input::Action& action : frame->actions[j])
+			{
+				m_actionDictionary.add(action.getHash());
+			}
+		}
+	}
+
+	if (m_actionDictionary.getCount() == m_numActionsRegistered)
+	{
+		return;
+	}
+
+	// Same reliable channel as PlayerInput, so it arrives before the input using it
+	message::RegisterActions* message = static_cast<message::RegisterActions*>(m_messageFactory.createMessage(MessageType::RegisterActions));
+	message->dictionary = m_actionDictionary;
+	sendMessage(message);
+
+	m_numActionsRegistered = m_actionDictionary.getCount();
+}
+
 void LocalClient::requestServerTime(const Time& localTime)
 {
 	message::RequestTime* message = dynamic_cast<message::RequestTime*>(m_messageFactory.createMessage(MessageType::RequestTime));
-	message->clientTimestamp = localTime.getMilliSeconds();
+	message->clientTimestamp = localTime.getMicroSeconds();
 	sendMessage(message);
+
+	m_clockSync.onRequestSent(message->clientTimestamp);
 }
 
 void LocalClient::readInput()
@@ -267,19 +381,32 @@ LocalClient::State LocalClient::getState() const
 	return m_state;
 }
 
+double LocalClient::getServerFrame() const
+{
+	if (!m_clockSync.isSynchronized())
+	{
+		return static_cast<double>(m_lastFrameSimulated);
+	}
+
+	// Wrap like a Sequence, keeping the fraction of the current frame
+	const double frame = m_clockSync.getServerFrame(m_localTime, m_game->getTimestep());
+	return frame - std::floor(frame / 65536.0) * 65536.0;
+}
+
 void LocalClient::readMessage(const Message& message, const Time& localTime)
 {
 	switch (message.getType())
 	{
 		case MessageType::Snapshot:
 		{
-			if (sequenceLessThan(message.getId(), m_lastReceivedSnapshotId))
+			const message::Snapshot& snapshot = static_cast<const message::Snapshot&>(message);
+			if (sequenceLessThan(snapshot.sequence, m_lastReceivedSnapshotId))
 			{ // old, discard
 				break;
 			}
 			
-			m_lastReceivedSnapshotId = message.getId();
-			onSnapshot(static_cast<const message::Snapshot&>(message));
+			m_lastReceivedSnapshotId = snapshot.sequence;
+			onSnapshot(snapshot);
 			break;
 		}
 
@@ -293,6 +420,11 @@ void LocalClient::readMessage(const Message& message, const Time& localTime)
 			onDestroyEntity(static_cast<const message::DestroyEntity&>(message));
 			break;
 		}
+		case MessageType::ConnectionChallenge:
+		{
+			m_connection->onChallenge(static_cast<const message::ConnectionChallenge&>(message).cookie);
+			break;
+		}
 		case MessageType::AcceptConnection:
 		{
 			onConnectionAccepted(static_cast<const message::AcceptConnection&>(message));
@@ -325,6 +457,8 @@ void LocalClient::readMessage(const Message& message, const Time& localTime)
 		case MessageType::RequestConnection:
 		case MessageType::GameEvent:
 		case MessageType::RequestTime:
+		case MessageType::AckSnapshot:
+		case MessageType::RegisterActions:
 		case MessageType::NUM_MESSAGE_TYPES:
 		{
 			ASSERT(false, "Illegal MessageType received");
@@ -338,6 +472,8 @@ void LocalClient::onConnectionAccepted(const message::AcceptConnection& inMessag
 	ASSERT(m_state == State::Connecting);
 
 	setState(State::Connected);
+	m_connection->setState(Connection::State::Connected);
+	m_connection->setPacketCoding(inMessage.usePacketCoding);
 	LOG_INFO("Client: Connection established with the server. My ID: %d", inMessage.clientId);
 	m_lastFrameSent = m_lastFrameSimulated;
 
@@ -400,9 +536,7 @@ void LocalClient::onDestroyEntity(const message::DestroyEntity& inMessage)
 		return;
 	}
 
-	auto entityList = EntityManager::getEntities();
-	if (Entity* netEntity = findPtrByPredicate(entityList.begin(), entityList.end(),
-		[networkId](Entity* entity) -> bool { return entity->getNetworkId() == networkId; }))
+	if (Entity* netEntity = EntityManager::findNetworkedEntity(networkId))
 	{
 		netEntity->kill();
 	}
@@ -410,24 +544,285 @@ void LocalClient::onDestroyEntity(const message::DestroyEntity& inMessage)
 
 void LocalClient::onSnapshot(const message::Snapshot& inMessage)
 {
-	if(inMessage.numMissingEntities > 0)
+	static const int32_t maxMissingEntities = 8;
+
+	// Snapshots handed over in-process by a listen server carry no decoded data
+	if (inMessage.numDataBits == 0)
+	{
+		return;
+	}
+
+	const WorldState* baseline = nullptr;
+	if (inMessage.hasBaseline)
+	{
+		baseline = m_worldStates.getEntry(inMessage.baselineSequence);
+		if (baseline == nullptr 
+			|| sequenceDifference(inMessage.sequence, inMessage.baselineSequence) >= s_snapshotHistorySize)
+		{
+			LOG_DEBUG("Client::onSnapshot: baseline %d of snapshot %d is not available", 
+				inMessage.baselineSequence, inMessage.sequence);
+			return;
+		}
+	}
+
+	WorldState* state = m_worldStates.insert(inMessage.sequence);
+	if (state == nullptr)
+	{
+		return;
+	}
+
+	const int32_t numBytes = roundTo((inMessage.numDataBits + 7) / 8, 4);
+	ReadStream stream(reinterpret_cast<const char*>(inMessage.data), numBytes);
+	if (!state->readDelta(stream, inMessage.sequence, baseline))
+	{
+		LOG_WARNING("Client::onSnapshot: failed to decode snapshot %d", inMessage.sequence);
+		m_worldStates.remove(inMessage.sequence);
+		return;
+	}
+
+	// Entities that left our area of interest are dropped, the server spawns them again on re-entry
+	for (int32_t networkId = 0; baseline != nullptr && networkId < s_maxNetworkedEntities; networkId++)
+	{
+		if (!baseline->hasEntity(networkId) || state->hasEntity(networkId))
+		{
+			continue;
+		}
+
+		Entity* entity = EntityManager::findNetworkedEntity(networkId);
+		if (entity != nullptr && !Network::isLocalPlayer(entity->getOwnerPlayerId()))
+		{
+			LOG_DEBUG("Client::onSnapshot: entity netId %d left the area of interest", networkId);
+			entity->kill();
+		}
+	}
+
+	// The server's state of our own entities is compared with what we predicted for the input frame it processed last
+	const bool predicting = isPredicting() && inMessage.hasInputFrame;
+	if (predicting)
+	{
+		for (PredictedState& correction : m_corrections)
+		{
+			correction = PredictedState();
+		}
+		m_correctionFrame = inMessage.inputFrame;
+		m_hasCorrection = true;
+	}
+
+	// Interpolation starts once snapshots can be placed on the server's timeline
+	if (m_clockSync.isSynchronized())
+	{
+		m_interpolation.addSnapshot(inMessage.frame, m_clockSync.getServerFrame(m_localTime, m_game->getTimestep()));
+	}
+
+	int32_t numMissingEntities = 0;
+	for (int32_t networkId = 0; networkId < s_maxNetworkedEntities; networkId++)
+	{
+		if (!state->hasEntity(networkId))
+		{
+			continue;
+		}
+
+		Entity* entity = EntityManager::findNetworkedEntity(networkId);
+		if (entity != nullptr && predicting && Network::isLocalPlayer(entity->getOwnerPlayerId()))
+		{
+			// Keep the prediction, the server's state is reconciled with it at the next frame
+			Rigidbody* rigidbody = entity->getTransform().getRigidbody();
+			if (rigidbody != nullptr)
+			{
+				const Vector2 position = rigidbody->getPosition();
+				const Vector2 velocity = rigidbody->getLinearVelocity();
+				state->readEntity(networkId, entity);
+
+				for (int32_t i = 0; i < s_maxPlayersPerClient; i++)
+				{
+					PredictedState& correction = m_corrections[i];
+					if (correction.networkId == INDEX_NONE || correction.networkId == networkId)
+					{
+						correction.networkId = networkId;
+						correction.position  = rigidbody->getPosition();
+						correction.velocity  = rigidbody->getLinearVelocity();
+						break;
+					}
+				}
+
+				rigidbody->setPosition(position);
+				rigidbody->setLinearVelocity(velocity);
+				continue;
+			}
+		}
+
+		if (entity != nullptr)
+		{
+			state->readEntity(networkId, entity);
+
+			Transform2D& transform = entity->getTransform();
+			m_interpolation.setEntity(networkId, transform.getLocalPosition(), transform.getLocalRotation());
+		}
+		else if (numMissingEntities < maxMissingEntities)
+		{
+			requestEntity(networkId);
+			numMissingEntities++;
+		}
+	}
+
+	message::AckSnapshot* message = static_cast<message::AckSnapshot*>(m_messageFactory.createMessage(MessageType::AckSnapshot));
+	message->sequence = inMessage.sequence;
+	m_connection->sendMessage(message);
+}
+
+void LocalClient::interpolateEntities(const Time& localTime)
+{
+	if (!m_clockSync.isSynchronized())
 	{
-		for (int32_t i = 0; i < inMessage.numMissingEntities; i++)
+		return;
+	}
+
+	const uint64_t timestep = m_game->getTimestep();
+	m_interpolation.update(static_cast<double>(localTime.getDeltaMicroSeconds()) / timestep);
+
+	const double renderFrame = m_interpolation.getRenderFrame(m_clockSync.getServerFrame(m_localTime, timestep));
+	for (Entity* entity : EntityManager::getEntities())
+	{
+		// Entities of local players are not drawn in the past
+		if (!entity->isReplicated() || Network::isLocalPlayer(entity->getOwnerPlayerId()))
+		{
+			continue;
+		}
+
+		Vector2 position;
+		float rotation = 0.0f;
+		if (m_interpolation.sample(renderFrame, entity->getNetworkId(), position, rotation))
 		{
-			ASSERT(inMessage.missingEntityIds[i] != INDEX_NONE, "Entity must have a valid NetworkId");
-			requestEntity(inMessage.missingEntityIds[i]);
+			Transform2D& transform = entity->getTransform();
+			transform.setLocalPosition(position);
+			transform.setLocalRotation(rotation);
 		}
 	}
 }
 
-void LocalClient::onServerTime(const message::ServerTime& inMessage, const Time& localTime)
+void LocalClient::reconcile(float fixedDeltaTime, Physics* physics)
 {
-	const uint64_t originalTime = inMessage.clientTimestamp;
-	const uint64_t serverTime = inMessage.serverTimestamp;
-	const uint64_t currentTime = localTime.getMilliSeconds();
-	const uint64_t latency = currentTime - originalTime;
+	if (!m_hasCorrection)
+	{
+		return;
+	}
+	m_hasCorrection = false;
+
+	// Frames the server has not processed yet, the last one is simulated by the caller
+	const int32_t numFrames = sequenceDifference(m_lastFrameSimulated, m_correctionFrame);
+	const Frame* correctionFrame = m_clientHistory.getFrame(m_correctionFrame);
+	if (numFrames <= 0 || correctionFrame == nullptr)
+	{
+		return;
+	}
+
+	bool isMispredicted = false;
+	for (const PredictedState& correction : m_corrections)
+	{
+		if (correction.networkId == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const PredictedState* predicted = nullptr;
+		for (const PredictedState& state : correctionFrame->states)
+		{
+			if (state.networkId == correction.networkId)
+			{
+				predicted = &state;
+			}
+		}
 
+		if (predicted == nullptr 
+			|| glm::distance(predicted->position, correction.position) > s_maxPositionError
+			|| glm::distance(predicted->velocity, correction.velocity) > s_maxVelocityError)
+		{
+			isMispredicted = true;
+		}
+	}
+
+	if (!isMispredicted)
+	{
+		return;
+	}
+
+	// Rewind to the server's state and replay the frames since
+	for (const PredictedState& correction : m_corrections)
+	{
+		Entity* entity = (correction.networkId != INDEX_NONE) ? EntityManager::findNetworkedEntity(correction.networkId) : nullptr;
+		if (Rigidbody* rigidbody = entity ? entity->getTransform().getRigidbody() : nullptr)
+		{
+			rigidbody->setPosition(correction.position);
+			rigidbody->setLinearVelocity(correction.velocity);
+		}
+	}
+
+	ActionBuffer actions;
+	for (int32_t i = 1; i < numFrames; i++)
+	{
+		Frame* frame = m_clientHistory.getFrame(static_cast<Sequence>(m_correctionFrame + i));
+		if (frame == nullptr)
+		{
+			continue;
+		}
+
+		for (const LocalPlayer& player : m_localPlayers)
+		{
+			actions.clear();
+			actions.insert(frame->actions[player.playerId]);
+			m_game->processPlayerActions(actions, player.playerId);
+		}
+
+		physics->step(fixedDeltaTime);
+		recordPrediction(*frame);
+	}
+
+	m_numReplays++;
+}
+
+void LocalClient::recordPrediction(Frame& frame)
+{
+	for (uint32_t i = 0; i < m_localPlayers.getCount(); i++)
+	{
+		PredictedState& state = frame.states[i];
+		state = PredictedState();
+
+		if (Entity* entity = findPredictedEntity(m_localPlayers[i].playerId))
+		{
+			Rigidbody* rigidbody = entity->getTransform().getRigidbody();
+			state.networkId = entity->getNetworkId();
+			state.position  = rigidbody->getPosition();
+			state.velocity  = rigidbody->getLinearVelocity();
+		}
+	}
+}
+
+Entity* LocalClient::findPredictedEntity(int16_t playerId) const
+{
+	for (Entity* entity : EntityManager::getEntities())
+	{
+		if (entity->isReplicated() && entity->getOwnerPlayerId() == playerId 
+			&& entity->getTransform().getRigidbody() != nullptr)
+		{
+			return entity;
+		}
+	}
+
+	return nullptr;
+}
+
+bool LocalClient::isPredicting() const
+{
+	// A listen server in this process simulates the shared entities itself
+	return m_state == State::Connected && Network::getLocalServer() == nullptr
+		&& m_game->getSessionType() != GameSessionType::Offline;
+}
+
+void LocalClient::onServerTime(const message::ServerTime& inMessage, const Time& localTime)
+{
 	// http://www.mine-control.com/zack/timesync/timesync.html
+	m_clockSync.addSample(inMessage.clientTimestamp, inMessage.serverTimestamp, 
+		inMessage.serverFrame, localTime.getMicroSeconds());
 }
 
 void LocalClient::onDisconnected()
@@ -447,6 +842,7 @@ void LocalClient::sendPendingMessages(const Time& localTime)
 	ASSERT(m_connection != nullptr);
 
 	m_connection->sendPendingMessages(localTime);
+	m_socket->flush();
 }
 
 void LocalClient::setState(State state)
@@ -456,8 +852,14 @@ void LocalClient::setState(State state)
 
 void LocalClient::clearSession()
 {
+	m_lastReceivedSnapshotId = (Sequence)INDEX_NONE;
 	m_localPlayers.clear();
 	m_requestedEntities.fill(INDEX_NONE);
+	m_clockSync.reset();
+	m_interpolation.clear();
+	m_hasCorrection = false;
+	m_actionDictionary.clear();
+	m_numActionsRegistered = 0;
 	
 	delete m_connection;
 	m_connection = nullptr;
@@ -465,7 +867,7 @@ void LocalClient::clearSession()
 	EntityManager::killEntities();
 }
 
-void LocalClient::receivePackets()
+void LocalClient::receivePackets(const Time& time)
 {
 	m_packetReceiver->receivePackets(m_socket, &m_receiveMessageFactory);
 
@@ -477,7 +879,7 @@ void LocalClient::receivePackets()
 		Packet* packet = packets[i];
 		if (packet->address == m_connection->getAddress())
 		{
-			m_connection->receivePacket(*packet);
+			m_connection->receivePacket(*packet, time);
 		}
 	}
 
@@ -489,7 +891,8 @@ void LocalClient::readMessages(const Time& localTime)
 	while (Message* message = m_connection->getNextMessage())
 	{
 		readMessage(*message, localTime);
-		ASSERT(message->getRefCount() == 1, "Message had dangling references at the end of their lifetime");
+		ASSERT(message->getRefCount() == 1 || m_socket->sharesMessagesWith(m_connection->getAddress()),
+			   "Message had dangling references at the end of their lifetime");
 		message->releaseRef();
 	}
 }
@@ -1,17 +1,22 @@
 
 #pragma once
 
+#include <core/action_dictionary.h>
 #include <core/entity.h>
 #include <core/keys.h>
 #include <core/entity_manager.h>
 #include <network/client_history.h>
+#include <network/clock_sync.h>
 #include <network/common_network.h>
 #include <network/connection.h>
 #include <network/connection_callback.h>
+#include <network/interpolation_buffer.h>
 #include <network/message.h>
 #include <network/client/message_factory_client.h>
 #include <network/server/message_factory_server.h>
+#include <network/sequence_buffer.h>
 #include <network/session.h>
+#include <network/world_state.h>
 #include <utility/buffer.h>
 #include <utility/circular_buffer.h>
 #include <utility/id_manager.h>
@@ -23,6 +28,7 @@
 class Game;
 class Time;
 class ActionBuffer;
+class Physics;
 //=============================================================================
 
 namespace network 
@@ -63,6 +69,11 @@ namespace network
 		void update(const Time& time);
 		void tick(Sequence frameId);
 
+		/** Simulates the entities of local players for the frame last ticked,
+		*   after rewinding and replaying them from the server's state when it
+		*   disagrees with the prediction. Only done against a remote server */
+		void predict(float fixedDeltaTime, Physics* physics);
+
 		void requestServerTime(const Time& localTime);
 		void readInput();
 		void connect(const Address& address, 
@@ -82,14 +93,29 @@ namespace network
 		LocalPlayer* getLocalPlayer(int16_t playerId) const;
 		State getState() const;
 
+		/** @return the frame the server is simulating now, estimated from the
+		*   synchronized clock, or the last simulated frame until synchronized */
+		double getServerFrame() const;
+		const ClockSync& getClockSync() const { return m_clockSync; }
+		const InterpolationBuffer& getInterpolation() const { return m_interpolation; }
+
+		/** @return number of times the prediction was rewound and replayed */
+		int32_t getNumReplays() const { return m_numReplays; }
+
 	private:
 		void sendPlayerActions();
+		void registerActions(Sequence fromFrame, int32_t numFrames);
 		void readMessage(const Message& message, const Time& localTime);
 		void onConnectionAccepted(const message::AcceptConnection& inMessage);
 		void onAcceptPlayer(const message::AcceptPlayer& inMessage);
 		void onSpawnEntity(const message::SpawnEntity& inMessage);
 		void onDestroyEntity(const message::DestroyEntity& inMessage);
 		void onSnapshot(const message::Snapshot& inMessage);
+		void interpolateEntities(const Time& localTime);
+		void reconcile(float fixedDeltaTime, Physics* physics);
+		void recordPrediction(Frame& frame);
+		Entity* findPredictedEntity(int16_t playerId) const;
+		bool isPredicting() const;
 		void onServerTime(const message::ServerTime& inMessage, const Time& localTime);
 		void onDisconnected();
 
@@ -98,7 +124,7 @@ namespace network
 		void setState(State state);
 		void clearSession();
 
-		void receivePackets();
+		void receivePackets(const Time& time);
 		void readMessages(const Time& localTime);
 		void onConnectionCallback(ConnectionCallback type, Connection* connection);
 		bool shouldSendInput() const;
@@ -113,8 +139,6 @@ namespace network
 		State           m_state;
 		float           m_timeSinceLastInputMessage;
 		float           m_maxInputMessageSentTime;
-		float           m_timeSinceLastClockSync;
-		float           m_clockResyncTime;
 		uint16_t        m_port;
 		PacketReceiver* m_packetReceiver;
 
@@ -122,6 +146,28 @@ namespace network
 		Buffer<LocalPlayer>	m_localPlayers;	
 
 		ClientHistory m_clientHistory;
+
+		/* Actions the input is encoded against, the server has the first
+		*  m_numActionsRegistered of them */
+		ActionDictionary m_actionDictionary;
+		int32_t          m_numActionsRegistered;
+
+		/* Server's state of the predicted entities after input frame m_correctionFrame,
+		*  applied at the next predicted frame */
+		PredictedState m_corrections[s_maxPlayersPerClient];
+		Sequence       m_correctionFrame;
+		bool           m_hasCorrection;
+		int32_t        m_numReplays;
+
+		/* Server clock estimate, m_localTime is the time of the last update in microseconds */
+		ClockSync m_clockSync;
+		uint64_t  m_localTime;
+
+		/* Decoded snapshots, baselines for the server's delta snapshots */
+		SequenceBuffer<WorldState> m_worldStates;
+
+		/* Transforms remote entities are drawn with, behind the server */
+		InterpolationBuffer m_interpolation;
 		std::function<void(Game*, JoinSessionResult)> m_sessionCallback;
 
 		MessageFactoryClient m_messageFactory;
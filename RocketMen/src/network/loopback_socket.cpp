@@ -0,0 +1,333 @@
+#include "loopback_socket.h"
+
+#include <core/debug.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+using namespace network;
+
+static const int32_t  s_datagramRingSize   = 256;
+static const int32_t  s_packetRingSize     = 256;
+static const uint16_t s_firstEphemeralPort = 49152;
+
+/* Sockets are created and destroyed while others send and receive threads read,
+*  s_localSocketsMutex guards the registry and the rings of every socket in it */
+static std::vector<LoopbackSocket*> s_localSockets;
+static std::mutex                   s_localSocketsMutex;
+
+LoopbackSocket::LoopbackSocket(Socket* socket) :
+	m_socket(socket),
+	m_isInitialized(false),
+	m_passMessages(false),
+	m_port(0),
+	m_datagrams(new Datagram[s_datagramRingSize]),
+	m_datagramHead(0),
+	m_numDatagrams(0),
+	m_packets(new Packet*[s_packetRingSize]),
+	m_packetHead(0),
+	m_numPackets(0),
+	m_bytesReceived(0),
+	m_bytesSent(0),
+	m_packetsReceived(0),
+	m_packetsSent(0)
+{
+}
+
+LoopbackSocket::~LoopbackSocket()
+{
+	{
+		std::lock_guard<std::mutex> lock(s_localSocketsMutex);
+		auto it = std::find(s_localSockets.begin(), s_localSockets.end(), this);
+		if (it != s_localSockets.end())
+		{
+			s_localSockets.erase(it);
+		}
+	}
+
+	while (Packet* packet = receivePacket())
+	{
+		delete packet;
+	}
+
+#ifdef _DEBUG
+	LOG_DEBUG("~LoopbackSocket: bytes received: %d, bytes sent: %d, packets received: %d, packets sent: %d",
+		m_bytesReceived, m_bytesSent, m_packetsReceived, m_packetsSent);
+#endif
+
+	delete[] m_datagrams;
+	delete[] m_packets;
+	delete m_socket;
+}
+
+bool LoopbackSocket::initialize(uint16_t port)
+{
+	ASSERT(!m_isInitialized);
+
+	if (m_socket != nullptr && !m_socket->initialize(port))
+	{
+		return false;
+	}
+
+	// A real socket is known under the port the OS bound
+	if (m_socket != nullptr)
+	{
+		port = static_cast<uint16_t>(m_socket->getPort());
+	}
+
+	// Without a real socket there is no OS to hand out a port, pick our own
+	std::lock_guard<std::mutex> lock(s_localSocketsMutex);
+	if (m_socket == nullptr && port == 0)
+	{
+		port = s_firstEphemeralPort;
+		while (findLocal(Address(127, 0, 0, 1, port)) != nullptr)
+		{
+			port++;
+		}
+	}
+
+	if (findLocal(Address(127, 0, 0, 1, port)) != nullptr)
+	{
+		LOG_ERROR("LoopbackSocket: local port %d is already in use", port);
+		return false;
+	}
+
+	m_port = port;
+	m_address = Address(127, 0, 0, 1, port);
+	s_localSockets.push_back(this);
+
+	m_isInitialized = true;
+	return m_isInitialized;
+}
+
+bool LoopbackSocket::isInitialized() const
+{
+	return m_isInitialized;
+}
+
+bool LoopbackSocket::receive(Address& address, char* buffer, int32_t& length)
+{
+	if (receiveLocal(address, buffer, length))
+	{
+		return true;
+	}
+
+	if (m_socket != nullptr)
+	{
+		return m_socket->receive(address, buffer, length);
+	}
+
+	return false;
+}
+
+bool LoopbackSocket::send(const Address& address, const void* buffer, const size_t length)
+{
+	{
+		std::lock_guard<std::mutex> lock(s_localSocketsMutex);
+		if (LoopbackSocket* destination = findLocal(address))
+		{
+			ASSERT(length <= static_cast<size_t>(g_maxDatagramSize), "Datagram exceeds g_maxDatagramSize");
+
+			if (destination->m_numDatagrams == s_datagramRingSize)
+			{
+				LOG_WARNING("LoopbackSocket: ring of port %d is full, datagram dropped", destination->m_port);
+				return false;
+			}
+
+			const int32_t tail = (destination->m_datagramHead + destination->m_numDatagrams) % s_datagramRingSize;
+			Datagram& datagram = destination->m_datagrams[tail];
+			datagram.address = m_address;
+			datagram.length  = static_cast<int32_t>(length);
+			memcpy(datagram.data, buffer, length);
+			destination->m_numDatagrams++;
+
+			destination->m_bytesReceived += length;
+			destination->m_packetsReceived++;
+			m_bytesSent += length;
+			m_packetsSent++;
+			return true;
+		}
+	}
+
+	if (m_socket != nullptr)
+	{
+		return m_socket->send(address, buffer, length);
+	}
+
+	LOG_WARNING("LoopbackSocket: no local socket bound to %s", address.toString().c_str());
+	return false;
+}
+
+int32_t LoopbackSocket::receiveBatch(Datagram* datagrams, int32_t maxDatagrams)
+{
+	ASSERT(datagrams != nullptr);
+
+	int32_t numReceived = 0;
+	while (numReceived < maxDatagrams)
+	{
+		Datagram& datagram = datagrams[numReceived];
+		if (!receiveLocal(datagram.address, datagram.data, datagram.length))
+		{
+			break;
+		}
+		numReceived++;
+	}
+
+	if (m_socket != nullptr && numReceived < maxDatagrams)
+	{
+		numReceived += m_socket->receiveBatch(datagrams + numReceived, maxDatagrams - numReceived);
+	}
+
+	return numReceived;
+}
+
+bool LoopbackSocket::waitForData(int32_t timeoutMilliseconds)
+{
+	// The ring is filled by the game thread, only a socket without local peers can block here
+	{
+		std::lock_guard<std::mutex> lock(s_localSocketsMutex);
+		if (m_numDatagrams > 0)
+		{
+			return true;
+		}
+	}
+
+	if (m_socket != nullptr)
+	{
+		return m_socket->waitForData(timeoutMilliseconds);
+	}
+
+	return Socket::waitForData(timeoutMilliseconds);
+}
+
+void LoopbackSocket::flush()
+{
+	if (m_socket != nullptr)
+	{
+		m_socket->flush();
+	}
+}
+
+bool LoopbackSocket::sendPacket(const Address& address, const Packet& packet)
+{
+	if (!m_passMessages)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(s_localSocketsMutex);
+	LoopbackSocket* destination = findLocal(address);
+	if (destination == nullptr)
+	{
+		return false;
+	}
+
+	if (destination->m_numPackets == s_packetRingSize)
+	{
+		LOG_WARNING("LoopbackSocket: packet ring of port %d is full, packet dropped", destination->m_port);
+		return true;
+	}
+
+	Packet* copy = new Packet();
+	copy->header  = packet.header;
+	copy->address = m_address;
+	for (int32_t i = 0; i < packet.header.numMessages; i++)
+	{
+		copy->messageIds[i]   = packet.messageIds[i];
+		copy->messageTypes[i] = packet.messageTypes[i];
+		copy->messages[i]     = packet.messages[i]->addRef();
+	}
+
+	const int32_t tail = (destination->m_packetHead + destination->m_numPackets) % s_packetRingSize;
+	destination->m_packets[tail] = copy;
+	destination->m_numPackets++;
+
+	destination->m_packetsReceived++;
+	m_packetsSent++;
+	return true;
+}
+
+Packet* LoopbackSocket::receivePacket()
+{
+	std::lock_guard<std::mutex> lock(s_localSocketsMutex);
+	if (m_numPackets == 0)
+	{
+		return nullptr;
+	}
+
+	Packet* packet = m_packets[m_packetHead];
+	m_packetHead = (m_packetHead + 1) % s_packetRingSize;
+	m_numPackets--;
+	return packet;
+}
+
+bool LoopbackSocket::sharesMessagesWith(const Address& address) const
+{
+	std::lock_guard<std::mutex> lock(s_localSocketsMutex);
+	const LoopbackSocket* peer = findLocal(address);
+	return (peer != nullptr) && (m_passMessages || peer->m_passMessages);
+}
+
+void LoopbackSocket::setPassMessages(bool passMessages)
+{
+	m_passMessages = passMessages;
+}
+
+uint32_t LoopbackSocket::getPort() const
+{
+	return m_port;
+}
+
+uint64_t LoopbackSocket::getBytesReceived() const
+{
+	return m_bytesReceived + (m_socket ? m_socket->getBytesReceived() : 0);
+}
+
+uint64_t LoopbackSocket::getBytesSent() const
+{
+	return m_bytesSent + (m_socket ? m_socket->getBytesSent() : 0);
+}
+
+uint64_t LoopbackSocket::getPacketsReceived() const
+{
+	return m_packetsReceived + (m_socket ? m_socket->getPacketsReceived() : 0);
+}
+
+uint64_t LoopbackSocket::getPacketsSent() const
+{
+	return m_packetsSent + (m_socket ? m_socket->getPacketsSent() : 0);
+}
+
+bool LoopbackSocket::receiveLocal(Address& address, char* buffer, int32_t& length)
+{
+	std::lock_guard<std::mutex> lock(s_localSocketsMutex);
+	if (m_numDatagrams == 0)
+	{
+		return false;
+	}
+
+	const Datagram& datagram = m_datagrams[m_datagramHead];
+	address = datagram.address;
+	length  = datagram.length;
+	memcpy(buffer, datagram.data, datagram.length);
+
+	m_datagramHead = (m_datagramHead + 1) % s_datagramRingSize;
+	m_numDatagrams--;
+	return true;
+}
+
+LoopbackSocket* LoopbackSocket::findLocal(const Address& address)
+{
+	// Only the exact address a local socket is bound to, other hosts may use the same port
+	for (LoopbackSocket* socket : s_localSockets)
+	{
+		if (socket->m_address == address)
+		{
+			return socket;
+		}
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <network/socket.h>
+
+namespace network
+{
+	/* LoopbackSocket
+	*  Passes datagrams between sockets living in the same process through an
+	*  in-memory ring instead of the kernel. Used by listen servers so the host
+	*  player's LocalClient and the Server skip the UDP round-trip. Datagrams
+	*  for addresses outside the process are forwarded to an optional wrapped
+	*  socket.
+	*/
+	class LoopbackSocket : public Socket
+	{
+	public:
+		/** @param Socket* socket  Socket used for non-local addresses, may be
+		*   nullptr. Ownership is taken. */
+		LoopbackSocket(Socket* socket = nullptr);
+		~LoopbackSocket();
+
+		bool initialize(uint16_t port) override;
+		bool isInitialized()     const override;
+
+		bool receive(Address& address, char* buffer, int32_t& length) override;
+		bool send(const Address& address, const void* buffer, const size_t length) override;
+
+		int32_t receiveBatch(Datagram* datagrams, int32_t maxDatagrams) override;
+		bool    waitForData(int32_t timeoutMilliseconds) override;
+		void    flush() override;
+
+		bool    sendPacket(const Address& address, const Packet& packet) override;
+		Packet* receivePacket() override;
+		bool    sharesMessagesWith(const Address& address) const override;
+
+		/** When enabled, packets to local sockets hand their Message objects
+		*   across by reference, skipping bitstream encoding and decoding */
+		void setPassMessages(bool passMessages);
+
+		uint32_t getPort()            const override;
+		uint64_t getBytesReceived()   const override;
+		uint64_t getBytesSent()       const override;
+		uint64_t getPacketsReceived() const override;
+		uint64_t getPacketsSent()     const override;
+
+	private:
+		/** Call with the registry's mutex held, see loopback_socket.cpp */
+		static LoopbackSocket* findLocal(const Address& address);
+
+		/** Pops a datagram sent by a local socket */
+		bool receiveLocal(Address& address, char* buffer, int32_t& length);
+
+		Socket*   m_socket;
+		bool      m_isInitialized;
+		bool      m_passMessages;
+		uint16_t  m_port;
+		Address   m_address;
+
+		Datagram* m_datagrams;
+		int32_t   m_datagramHead;
+		int32_t   m_numDatagrams;
+
+		Packet**  m_packets;
+		int32_t   m_packetHead;
+		int32_t   m_numPackets;
+
+		uint64_t  m_bytesReceived;
+		uint64_t  m_bytesSent;
+		uint64_t  m_packetsReceived;
+		uint64_t  m_packetsSent;
+	};
+
+}; // namespace network
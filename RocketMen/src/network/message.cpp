@@ -16,16 +16,17 @@ Message::~Message()
 
 Message* Message::addRef()
 {
-	m_refCount++;
+	m_refCount.fetch_add(1, std::memory_order_relaxed);
 	return this;
 }
 
 void Message::releaseRef()
 {
-	ASSERT(m_refCount > 0);
+	// The last owner must see every write the other owners made before releasing
+	const int32_t refCount = m_refCount.fetch_sub(1, std::memory_order_acq_rel);
+	ASSERT(refCount > 0);
 
-	m_refCount--;
-	if (m_refCount == 0)
+	if (refCount == 1)
 	{
 		delete this;
 	}
@@ -6,6 +6,8 @@
 #include <network/address.h>
 #include <network/message_type.h>
 
+#include <atomic>
+
 #define DECLARE_MESSAGE( name, channel ) \
 	MessageType getType() const override { return MessageType::name; } \
 	ChannelType getChannel() const override { return ChannelType::channel; } \
@@ -24,7 +26,7 @@ namespace network
 		Message* addRef();
 		void releaseRef();
 
-		int32_t getRefCount() const { return m_refCount; }
+		int32_t getRefCount() const { return m_refCount.load(std::memory_order_relaxed); }
 		virtual MessageType getType() const = 0;
 		virtual ChannelType getChannel() const = 0;
 
@@ -35,7 +37,8 @@ namespace network
 		virtual ~Message();
 	private: 
 
-		int32_t     m_refCount;
+		/* Messages decoded on the receive thread are shared with the game thread */
+		std::atomic<int32_t> m_refCount;
 		Sequence    m_id;
 	};
 
@@ -48,10 +51,17 @@ namespace network
 
 	struct OutgoingMessageEntry
 	{
-		OutgoingMessageEntry() : message(nullptr) {}
+		OutgoingMessageEntry() : message(nullptr), messageId(0), prevPending(INDEX_NONE), nextPending(INDEX_NONE) {}
 
 		Message* message;
+
+		/* Id in this channel, a message sent to several connections has one per connection */
+		Sequence messageId;
 		float timeLastSent;
+
+		/* Links of the pending list the entry is on, as send queue indices */
+		int32_t prevPending;
+		int32_t nextPending;
 	};
 
 }; // namespace network
\ No newline at end of file
@@ -15,7 +15,11 @@ namespace message {
 		{
 			serializeCheck(stream, "begin_accept_connection");
 
-			serializeInt(stream, clientId, 0, s_maxPlayersPerClient);
+			// Ids are not reused, so they are not bounded by the capacity of the server
+			serializeInt(stream, clientId);
+
+			// Both ends code the packets they send from now on
+			serializeBool(stream, usePacketCoding);
 
 			serializeCheck(stream, "end_accept_connection");
 
@@ -23,6 +27,7 @@ namespace message {
 		}
 
 		int32_t clientId;
+		bool    usePacketCoding = false;
 	};
 
 }; // namespace message
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <network/message.h>
+
+namespace network {
+namespace message {
+
+	struct AckSnapshot : public Message
+	{
+		DECLARE_MESSAGE(AckSnapshot, UnreliableUnordered);
+
+		template<typename Stream>
+		bool serialize_impl(Stream& stream)
+		{
+			if (!serializeCheck(stream, "begin_ack_snapshot"))
+			{
+				return false;
+			}
+
+			serializeBits(stream, sequence, 16);
+
+			if (!serializeCheck(stream, "end_ack_snapshot"))
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+		/* Latest snapshot the client decoded and keeps as a baseline */
+		Sequence sequence;
+	};
+
+}; // namespace message
+};// namespace network
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <network/message.h>
+
+namespace network {
+namespace message {
+
+	/* Answer to a RequestConnection without a valid cookie, the client 
+	*  echoes the cookie in its next request */
+	struct ConnectionChallenge : public Message
+	{
+		DECLARE_MESSAGE(ConnectionChallenge, UnreliableUnordered);
+
+		template<typename Stream>
+		bool serialize_impl(Stream& stream)
+		{
+			if (!serializeCheck(stream, "begin_connection_challenge"))
+			{
+				return false;
+			}
+
+			serializeUint64(stream, cookie);
+
+			if (!serializeCheck(stream, "end_connection_challenge"))
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+		uint64_t cookie = 0;
+	};
+
+}; // namespace message
+};// namespace network
@@ -30,6 +30,25 @@ namespace message {
 				}
 				serializeInt(stream, startFrame);
 				serializeInt(stream, numPlayers);
+
+				// Actions encoded by ActionBuffer against the client's ActionDictionary,
+				// whole words as ReadStream expects
+				int32_t numWords = dataLength / 4;
+				serializeInt(stream, numWords, 0, maxDataLength / 4);
+				dataLength = numWords * 4;
+				for (int32_t i = 0; i < dataLength; i++)
+				{
+					uint32_t byte = static_cast<uint8_t>(data[i]);
+					serializeBits(stream, byte, 8);
+					data[i] = static_cast<char>(byte);
+				}
+
+				serializeBool(stream, hasViewFrame);
+				if (hasViewFrame)
+				{
+					serializeBits(stream, viewFrame, 16);
+					serializeFloat(stream, viewFraction, 0.0f, 1.0f, 1.0f / 255.0f);
+				}
 			
 				serializeCheck(stream, "end_player_input");
 
@@ -37,10 +56,15 @@ namespace message {
 			}
 
 			char    data[maxDataLength];
-			int32_t dataLength;
+			int32_t dataLength = 0;
 			int32_t numFrames;
 			int32_t startFrame;
 			int32_t numPlayers;
+
+			/* Server frame the client was drawing remote entities at */
+			bool     hasViewFrame = false;
+			Sequence viewFrame    = 0;
+			float    viewFraction = 0.0f;
 		};
 
 }; // namespace message
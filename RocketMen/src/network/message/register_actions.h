@@ -0,0 +1,41 @@
+
+#pragma once
+
+#include <core/action_dictionary.h>
+#include <network/message.h>
+
+namespace network {
+namespace message {
+
+		/* Actions the client refers to by index in PlayerInput, sent before
+		*  the first input that uses a new action */
+		struct RegisterActions : public Message
+		{
+			DECLARE_MESSAGE(RegisterActions, ReliableOrdered);
+
+			template<typename Stream>
+			bool serialize_impl(Stream& stream)
+			{
+				if (!serializeCheck(stream, "begin_register_actions"))
+				{
+					return false;
+				}
+
+				if (!dictionary.serialize(stream))
+				{
+					return false;
+				}
+
+				if (!serializeCheck(stream, "end_register_actions"))
+				{
+					return false;
+				}
+
+				return true;
+			}
+
+			::ActionDictionary dictionary;
+		};
+
+}; // namespace message
+};// namespace network
@@ -1,4 +1,3 @@
-
 #pragma once
 
 #include  <network/message.h>
@@ -6,17 +5,31 @@
 namespace network {
 namespace message {
 
+	/* Sent unreliably until the server accepts, the server only allocates
+	*  a client once the request carries the cookie of its challenge.
+	*  The cookie is written even when there is none, so a request is never
+	*  smaller than the challenge it causes. The client advertises whether
+	*  it can take packets coded by PacketCoder */
 	struct RequestConnection : public Message
 	{
-		DECLARE_MESSAGE(RequestConnection, ReliableOrdered);
+		DECLARE_MESSAGE(RequestConnection, UnreliableUnordered);
 
 		template<typename Stream>
 		bool serialize_impl(Stream& stream)
 		{
 			serializeCheck(stream, "request_connection");
+
+			serializeBool(stream, hasCookie);
+			serializeUint64(stream, cookie);
+			serializeBool(stream, supportsPacketCoding);
+
 			return true;
 		}
+
+		uint64_t cookie               = 0;
+		bool     hasCookie            = false;
+		bool     supportsPacketCoding = false;
 	};
 
 }; // namespace message
-};// namespace network
\ No newline at end of file
+};// namespace network
@@ -18,7 +18,7 @@ namespace message {
 					return false;
 				}
 
-				serializeBits(stream, clientTimestamp, 64);
+				serializeUint64(stream, clientTimestamp);
 
 				if (!serializeCheck(stream, "end_request_time"))
 				{
@@ -28,6 +28,7 @@ namespace message {
 				return true;
 			}
 
+			/* Microseconds */
 			uint64_t clientTimestamp;
 		};
 
@@ -18,9 +18,11 @@ namespace message {
 				return false;
 			}
 
-			serializeBits(stream, clientTimestamp, 64);
+			serializeUint64(stream, clientTimestamp);
 
-			serializeBits(stream, serverTimestamp, 64);
+			serializeUint64(stream, serverTimestamp);
+
+			serializeBits(stream, serverFrame, 16);
 
 			if (!serializeCheck(stream, "end_server_time"))
 			{
@@ -30,8 +32,12 @@ namespace message {
 			return true;
 		}
 
+		/* Microseconds */
 		uint64_t clientTimestamp;
 		uint64_t serverTimestamp;
+
+		/* Last frame the server simulated when answering */
+		Sequence serverFrame;
 	};
 
 };// namespace message
@@ -1,10 +1,8 @@
-
 #pragma once
 
-#include <core/entity.h>
-#include <core/entity_manager.h>
 #include <network/message.h>
-#include <utility/utility.h>
+#include <network/snapshot_payload.h>
+#include <network/world_state.h>
 
 namespace network {
 namespace message {
@@ -12,139 +10,96 @@ namespace message {
 	struct Snapshot : public Message
 	{
 		DECLARE_MESSAGE(Snapshot, UnreliableUnordered);
-		static const int32_t maxMissingEntityIds = 8;
+		static const int32_t maxDataWords = s_maxPayloadSize / 4;
 
-		bool serialize_impl(WriteStream& stream)
+		~Snapshot()
 		{
-			serializeCheck(stream, "begin_snapshot");
-
-			std::vector<Entity*> networkEntities;
-			auto& entities = EntityManager::getEntities();
-			for (Entity* entity : entities)
+			if (payload != nullptr)
 			{
-				if (entity->isReplicated())
-				{
-					networkEntities.push_back(entity);
-				}
+				payload->releaseRef();
 			}
+		}
 
-			int32_t numEntities = static_cast<int32_t>(networkEntities.size());
-			ASSERT(numEntities <= s_maxNetworkedEntities, "Number of networked entities exceeds the maximum");
-			serializeInt(stream, numEntities, 0, s_maxNetworkedEntities);
+		bool serialize_impl(WriteStream& stream)
+		{
+			ASSERT(payload != nullptr, "Snapshots are written from a SnapshotPayload");
+			if (payload == nullptr)
+			{
+				return false;
+			}
 
-			for (int32_t networkId = 0; networkId < s_maxNetworkedEntities; networkId++)
+			if (!payload->serialize(stream))
 			{
-				if (Entity* netEntity = findPtrByPredicate(networkEntities.begin(), networkEntities.end(),
-					[networkId](Entity* entity) -> bool { return entity->getNetworkId() == networkId; }))
-				{
-					serializeCheck(stream, "begin_entity");
-
-					MeasureStream measureStream;
-					EntityManager::serializeEntity(netEntity, measureStream);
-					int32_t entitySize = measureStream.getMeasuredBits();
-
-					bool writeEntity = entitySize > 0;
-					serializeBool(stream, writeEntity);
-					if (writeEntity)
-					{
-						serializeInt(stream, entitySize);
-						serializeCheck(stream, "begin_entity_data");
-						if (!EntityManager::serializeEntity(netEntity, stream))
-						{
-							return false;
-						}
-						serializeCheck(stream, "end_entity_data");
-
-					}
-					serializeCheck(stream, "end_entity");
-				}
+				return false;
 			}
 
-			serializeCheck(stream, "end_snapshot");
+			// Written per client, outside of the shared payload
+			serializeBool(stream, hasInputFrame);
+			if (hasInputFrame)
+			{
+				serializeBits(stream, inputFrame, 16);
+			}
 
 			return true;
 		}
 
+		/* Only copies the encoded world state, LocalClient decodes it against its baseline */
 		bool serialize_impl(ReadStream& stream)
 		{
-			std::fill(missingEntityIds, missingEntityIds + maxMissingEntityIds, INDEX_NONE);
+			if (!serializeCheck(stream, "begin_snapshot"))
+			{
+				return false;
+			}
 
-			serializeCheck(stream, "begin_snapshot");
+			serializeBits(stream, sequence, 16);
 
-			std::vector<Entity*> replicatedEntities;
-			auto& entities = EntityManager::getEntities();
-			for (Entity* entity : entities)
+			serializeBits(stream, frame, 16);
+
+			serializeBool(stream, hasBaseline);
+			if (hasBaseline)
 			{
-				if (entity->isReplicated())
-				{
-					replicatedEntities.push_back(entity);
-				}
+				serializeBits(stream, baselineSequence, 16);
 			}
 
-			int32_t numReceivedEntities;
-			serializeInt(stream, numReceivedEntities, 0, s_maxNetworkedEntities);
-			if (numReceivedEntities == 0)
+			serializeInt(stream, numDataBits, 0, s_maxPayloadBits);
+			int32_t numBitsLeft = numDataBits;
+			for (int32_t i = 0; numBitsLeft > 0; i++)
 			{
-				serializeCheck(stream, "end_snapshot");
-				return true;
+				const int32_t wordBits = std::min(numBitsLeft, 32);
+				data[i] = 0;
+				serializeBits(stream, data[i], wordBits);
+				numBitsLeft -= wordBits;
 			}
 
-			int32_t numEntitiesRead = 0;
-			for (int32_t networkId = 0; networkId < s_maxNetworkedEntities; networkId++)
+			if (!serializeCheck(stream, "end_snapshot"))
 			{
-				serializeCheck(stream, "begin_entity");
-
-				int32_t receivedEntitySizeBits = -1;
-				bool readEntity = false;
-				serializeBool(stream, readEntity);
-
-				if(readEntity)
-				{
-					serializeInt(stream, receivedEntitySizeBits);
-					if (receivedEntitySizeBits <= 0)
-					{
-						return false;
-					}
-					if (Entity* netEntity = findPtrByPredicate(replicatedEntities.begin(), replicatedEntities.end(),
-						[networkId](Entity* entity) -> bool { return entity->getNetworkId() == networkId; }))
-					{
-						serializeCheck(stream, "begin_entity_data");
-						if (!EntityManager::serializeEntity(netEntity, stream))
-						{
-							return false;
-						}
-						serializeCheck(stream, "end_entity_data");
-					}
-					else
-					{
-						if (numMissingEntities < maxMissingEntityIds)
-						{
-							missingEntityIds[numMissingEntities++] = networkId;
-						}
-
-						serializeCheck(stream, "begin_entity_data");
-						stream.skipBits(receivedEntitySizeBits);
-						serializeCheck(stream, "end_entity_data");
-					}
-					numEntitiesRead++;
-				}
-				serializeCheck(stream, "end_entity");
-				if (numEntitiesRead == numReceivedEntities)
-				{
-					break;
-				}
+				return false;
 			}
 
-
-			serializeCheck(stream, "end_snapshot");
+			serializeBool(stream, hasInputFrame);
+			if (hasInputFrame)
+			{
+				serializeBits(stream, inputFrame, 16);
+			}
 
 			return true;
 		}
 
-		int32_t missingEntityIds[maxMissingEntityIds];
-		int32_t numMissingEntities = 0;
+		Sequence sequence         = 0;
+		Sequence frame            = 0;
+		Sequence baselineSequence = 0;
+		bool     hasBaseline      = false;
+		int32_t  numDataBits      = 0;
+
+		/* Last input frame of the receiving client the server had processed */
+		Sequence inputFrame       = 0;
+		bool     hasInputFrame    = false;
+
+		uint32_t data[maxDataWords];
 
+		/* Encoded snapshot shared between clients, write only */
+		SnapshotPayload* payload = nullptr;
 	};
 
 }; // namespace message
-};// namespace network
\ No newline at end of file
+};// namespace network
@@ -22,7 +22,6 @@ namespace message {
 			if (Stream::isWriting)
 			{
 				serializeCheck(stream, "begin_entity");
-				LOG_DEBUG("SpawnEntity::write %d", rand());
 				ASSERT(entity != nullptr);
 				int32_t networkId = entity->getNetworkId();
 				ASSERT(networkId >= 0 && networkId < s_maxNetworkedEntities);
@@ -14,6 +14,10 @@ namespace network {
 		virtual ~MessageFactory() {};
 
 		virtual Message* createMessage(MessageType type) = 0;
+
+		/** @return true if the messages it creates can be read on the receive
+		*   thread, their serialize(ReadStream&) touching nothing but the message */
+		virtual bool canReadOffThread() const { return true; }
 	};
 
 }; // namespace network
\ No newline at end of file
@@ -22,6 +22,7 @@ namespace network
 		DestroyEntity,
 		GameEvent,
 		ServerTime,
+		ConnectionChallenge,
 
 		// Client to server
 		RequestConnection,
@@ -29,6 +30,8 @@ namespace network
 		PlayerInput,
 		RequestEntity,
 		RequestTime,
+		AckSnapshot,
+		RegisterActions,
 
 		NUM_MESSAGE_TYPES
 	};
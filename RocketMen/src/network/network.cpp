@@ -4,45 +4,45 @@
 #include <core/debug.h>
 #include <core/game.h>
 #include <core/input.h>
+#include <core/room.h>
 #include <network/local_client.h>
 #include <network/server.h>
 
 using namespace network;
 
-static LocalClient* s_client;
-static Server* s_server;
-
 bool Network::isClient()
 {
-	return s_client != nullptr;
+	return Room::getCurrent()->m_client != nullptr;
 }
 
 bool Network::isServer()
 {
-	return s_server != nullptr;
+	return Room::getCurrent()->m_server != nullptr;
 }
 
 void Network::generateNetworkId(Entity* entity)
 {
 	ASSERT(entity != nullptr);
-	if (isServer())
+	if (Server* server = Room::getCurrent()->m_server)
 	{
-		s_server->generateNetworkId(entity);
+		server->generateNetworkId(entity);
 	}
 }
 
 void Network::addLocalPlayer(int32_t controllerId)
 {
-	ASSERT(s_client != nullptr);
+	LocalClient* client = Room::getCurrent()->m_client;
+	ASSERT(client != nullptr);
 	ASSERT(controllerId >= 0 && controllerId <= input::NumSupportedControllers, "Invalid controllerId");
-	s_client->addLocalPlayer(controllerId);
+	client->addLocalPlayer(controllerId);
 }
 
 uint32_t Network::getNumLocalPlayers()
 {
-	if (s_client)
+	LocalClient* client = Room::getCurrent()->m_client;
+	if (client)
 	{
-		return s_client->getNumLocalPlayers();
+		return client->getNumLocalPlayers();
 	}
 
 	return 0;
@@ -50,9 +50,10 @@ uint32_t Network::getNumLocalPlayers()
 
 bool Network::isLocalPlayer(int16_t playerId)
 {
-	if (s_client != nullptr)
+	LocalClient* client = Room::getCurrent()->m_client;
+	if (client != nullptr)
 	{
-		return s_client->isLocalPlayer(playerId);
+		return client->isLocalPlayer(playerId);
 	}
 
 	return false;
@@ -60,23 +61,79 @@ bool Network::isLocalPlayer(int16_t playerId)
 
 void Network::destroyEntity(int32_t networkId)
 {
-	if (s_server && networkId > INDEX_NONE)
+	Server* server = Room::getCurrent()->m_server;
+	if (server && networkId > INDEX_NONE)
+	{
+		server->destroyEntity(networkId);
+	}
+}
+
+double Network::getServerFrame()
+{
+	Room* room = Room::getCurrent();
+	if (room->m_server)
+	{
+		return static_cast<double>(room->m_server->getFrame());
+	}
+
+	if (room->m_client)
+	{
+		return room->m_client->getServerFrame();
+	}
+
+	return 0.0;
+}
+
+float Network::getLagCompensation()
+{
+	Server* server = Room::getCurrent()->m_server;
+	if (server)
+	{
+		return server->getLagCompensation();
+	}
+
+	return 0.0f;
+}
+
+void Network::setInterestArea(uint32_t width, uint32_t height)
+{
+	Server* server = Room::getCurrent()->m_server;
+	if (server)
+	{
+		server->setInterestArea(width, height);
+	}
+}
+
+void Network::setMaxClients(int32_t maxClients)
+{
+	if (Server* server = Room::getCurrent()->m_server)
+	{
+		server->setMaxClients(maxClients);
+	}
+}
+
+network::QuantizationReport Network::getQuantizationReport()
+{
+	Server* server = Room::getCurrent()->m_server;
+	if (server)
 	{
-		s_server->destroyEntity(networkId);
+		return server->getQuantizationReport();
 	}
+
+	return QuantizationReport();
 }
 
 void Network::setClient(LocalClient* client)
 {
-	s_client = client;
+	Room::getCurrent()->m_client = client;
 }
 
 void Network::setServer(Server* server)
 {
-	s_server = server;
+	Room::getCurrent()->m_server = server;
 }
 
 Server* Network::getLocalServer()
 {
-	return s_server;
+	return Room::getCurrent()->m_server;
 }
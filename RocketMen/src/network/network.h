@@ -2,6 +2,7 @@
 #pragma once
 
 #include <network/address.h>
+#include <network/quantization.h>
 
 #include <cstdint>
 
@@ -13,6 +14,9 @@ namespace network {
 	class Server;
 }; // namespace network
 
+/* Network
+*  Session of the Room bound to the calling thread
+*/
 class Network
 {
 public:
@@ -27,6 +31,26 @@ public:
 
 	static void destroyEntity(int32_t networkId);
 
+	/** @return the frame the server simulates now, estimated from the
+	*   synchronized clock on clients. Wraps like a Sequence and includes
+	*   the fraction of the current frame */
+	static double getServerFrame();
+
+	/** @return seconds the server rewound the world by to execute the
+	*   current player input, 0 when not executing input */
+	static float getLagCompensation();
+
+	/** Enables area of interest filtering on the local server for a map of
+	*   width x height tiles */
+	static void setInterestArea(uint32_t width, uint32_t height);
+
+	/** Clients the local server accepts at once, only before any connected */
+	static void setMaxClients(int32_t maxClients);
+
+	/** @return bits the local server's snapshot entities take with and
+	*   without quantization, empty on clients */
+	static network::QuantizationReport getQuantizationReport();
+
 protected:
 	static void setClient(network::LocalClient* client);
 	static void setServer(network::Server* server);
@@ -2,29 +2,152 @@
 #include "network_channel.h"
 
 #include <core/debug.h>
+#include <network/network_metrics.h>
+#include <network/packet.h>
+#include <network/packet_coder.h>
 #include <network/socket.h>
 
-extern "C" unsigned long crcFast(unsigned char const message[], int nBytes);
+#include <atomic>
+
+extern "C" uint32_t crcFast(unsigned char const message[], int nBytes);
 
 using namespace network;
 
+/* Identifies the fragments of one packet, shared by all channels of the process
+*  and incremented by the send workers concurrently */
+static std::atomic<Sequence> s_fragmentSequence(0);
+
+/* Bytes of the checksum and datagram type ahead of the packet */
+static const int32_t s_datagramHeaderSize = 5;
+
+NetworkChannel::NetworkChannel() :
+	m_isPacketCoding(false)
+{
+}
+
 void NetworkChannel::sendPacket(Socket* socket, const Address& address, Packet* packet, MessageFactory* messageFactory)
 {
 	ASSERT(socket != nullptr);
 	ASSERT(packet != nullptr);
 	ASSERT(socket->isInitialized());
+
+	// In-process peers take the messages as is
+	if (socket->sendPacket(address, *packet))
+	{
+		return;
+	}
 	
 	WriteStream packetStream(g_maxPacketSize);
 
 	int32_t protocolId = g_protocolId;
 	serializeBits(packetStream, protocolId, 32);
 
+	uint32_t datagramType = static_cast<uint32_t>(DatagramType::Packet);
+	serializeBits(packetStream, datagramType, 8);
+
 	packet->serialize(packetStream, messageFactory);
 
-	const uint32_t checksum = crcFast((unsigned char*)packetStream.getData(), packetStream.getDataLength());
+	if (m_isPacketCoding)
+	{
+		WriteStream codedStream(g_maxPacketSize);
+		if (codePacket(packetStream, codedStream))
+		{
+			sendDatagram(socket, address, codedStream);
+			return;
+		}
+	}
+
+	sendDatagram(socket, address, packetStream);
+}
+
+void NetworkChannel::sendDatagram(Socket* socket, const Address& address, WriteStream& stream)
+{
+	const int32_t length = stream.getDataLength();
+	const uint32_t checksum = crcFast((unsigned char*)stream.getData(), length);
 
 	// swap protocolId for checksum
-	(uint32_t&)packetStream.getData()[0] = checksum;
+	(uint32_t&)stream.getData()[0] = checksum;
+
+	if (length <= g_maxDatagramSize)
+	{
+		socket->send(address, stream.getData(), length);
+	}
+	else
+	{
+		sendFragments(socket, address, stream.getData(), length);
+	}
+}
+
+bool NetworkChannel::codePacket(const WriteStream& packetStream, WriteStream& codedStream) const
+{
+	const int32_t length = packetStream.getDataLength();
+	int32_t packetLength = length - s_datagramHeaderSize;
+	if (packetLength <= 0)
+	{
+		return false;
+	}
+
+	// The coded datagram adds the packet length to the header, so it has to save more than that
+	char coded[g_maxPacketSize];
+	const int32_t codedLength = PacketCoder::encode(packetStream.getData() + s_datagramHeaderSize, packetLength, coded, packetLength - 1);
+	if (codedLength == 0)
+	{
+		return false;
+	}
+
+	int32_t protocolId = g_protocolId;
+	serializeBits(codedStream, protocolId, 32);
+
+	uint32_t datagramType = static_cast<uint32_t>(DatagramType::CodedPacket);
+	serializeBits(codedStream, datagramType, 8);
+
+	serializeInt(codedStream, packetLength, 1, g_maxPacketSize);
+	codedStream.serializeData(coded, codedLength);
+	codedStream.flush();
+
+	const int32_t bytesSaved = length - codedStream.getDataLength();
+	if (bytesSaved <= 0)
+	{
+		return false;
+	}
+
+	NetworkMetrics::get().packetsCoded.add();
+	NetworkMetrics::get().packetCodingBytesSaved.add(bytesSaved);
+	return true;
+}
+
+void NetworkChannel::sendFragments(Socket* socket, const Address& address, const char* data, int32_t length)
+{
+	// The receiver reassembles the checksummed datagram and reads it as if it was received whole
+	const int32_t numFragments = (length + g_fragmentSize - 1) / g_fragmentSize;
+	ASSERT(numFragments > 1 && numFragments <= g_maxFragmentsPerPacket, "Packet too large to fragment");
+
+	uint32_t sequence = s_fragmentSequence.fetch_add(1, std::memory_order_relaxed);
+	for (int32_t fragmentId = 0; fragmentId < numFragments; fragmentId++)
+	{
+		WriteStream stream(g_maxDatagramSize);
+
+		int32_t protocolId = g_protocolId;
+		serializeBits(stream, protocolId, 32);
+
+		uint32_t datagramType = static_cast<uint32_t>(DatagramType::Fragment);
+		serializeBits(stream, datagramType, 8);
+
+		int32_t fragmentCount = numFragments;
+		int32_t fragmentIndex = fragmentId;
+		int32_t fragmentBytes = std::min(length - fragmentId * g_fragmentSize, g_fragmentSize);
+		serializeBits(stream, sequence, 16);
+		serializeInt(stream, fragmentCount, 2, g_maxFragmentsPerPacket);
+		serializeInt(stream, fragmentIndex, 0, g_maxFragmentsPerPacket - 1);
+		serializeInt(stream, fragmentBytes, 1, g_fragmentSize);
+		stream.serializeData(data + fragmentId * g_fragmentSize, fragmentBytes);
+		stream.flush();
+
+		ASSERT(stream.getDataLength() - fragmentBytes <= g_fragmentHeaderSize);
+
+		const uint32_t checksum = crcFast((unsigned char*)stream.getData(), stream.getDataLength());
+		(uint32_t&)stream.getData()[0] = checksum;
 
-	socket->send(address, packetStream.getData(), packetStream.getDataLength());
+		socket->send(address, stream.getData(), stream.getDataLength());
+	}
 }
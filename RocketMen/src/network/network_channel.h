@@ -1,7 +1,10 @@
 
 #pragma once
 
+#include <cstdint>
+
 class Time;
+class WriteStream;
 
 namespace network 
 {
@@ -14,18 +17,35 @@ namespace network
 	class NetworkChannel
 	{
 	public:
+		NetworkChannel();
+
+		/** Packets are coded by PacketCoder when that makes them smaller,
+		*   only once the peer agreed to it in the handshake */
+		void setPacketCoding(bool isPacketCoding) { m_isPacketCoding = isPacketCoding; }
+
 		virtual void sendMessage(Message* message) = 0;
 
 		virtual void sendPendingMessages(Socket* socket, 
 			const Address& address, const Time& time, MessageFactory* messageFactory) = 0;
 
-		virtual void receivePacket(Packet& packet) = 0;
+		virtual void receivePacket(Packet& packet, const Time& time) = 0;
 
 		virtual Message* getNextMessage() = 0;
 
 	protected:
 		void sendPacket(Socket* socket, const Address& address, Packet* packet, MessageFactory* messageFactory);
 		Message* readMessage(Packet& packet);
+
+	private:
+		/** Checksums the datagram in stream and sends it, in fragments when too large */
+		void sendDatagram(Socket* socket, const Address& address, WriteStream& stream);
+		void sendFragments(Socket* socket, const Address& address, const char* data, int32_t length);
+
+		/** Writes the coded form of the datagram in packetStream to codedStream
+		*   @return false when coding would not make it smaller */
+		bool codePacket(const WriteStream& packetStream, WriteStream& codedStream) const;
+
+		bool m_isPacketCoding;
 	};
 
 }; // namespace network
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "network_metrics.h"
+
+using namespace network;
+
+NetworkMetrics& NetworkMetrics::get()
+{
+	static NetworkMetrics metrics;
+	return metrics;
+}
+
+NetworkMetrics::NetworkMetrics() :
+	datagramsSent(Metrics::getCounter("rm_socket_datagrams_sent_total", "Datagrams handed to the operating system")),
+	datagramsReceived(Metrics::getCounter("rm_socket_datagrams_received_total", "Datagrams read from the operating system")),
+	bytesSent(Metrics::getCounter("rm_socket_bytes_sent_total", "Bytes of the datagrams sent")),
+	bytesReceived(Metrics::getCounter("rm_socket_bytes_received_total", "Bytes of the datagrams received")),
+	sendErrors(Metrics::getCounter("rm_socket_send_errors_total", "Datagrams the socket failed to send")),
+	datagramSize(Metrics::getHistogram("rm_socket_datagram_bytes", "Size of the datagrams sent",
+		{ 64, 128, 256, 512, 768, 1024, 1200 })),
+
+	checksumMismatches(Metrics::getCounter("rm_receive_checksum_mismatches_total", "Datagrams discarded for their checksum")),
+	invalidPackets(Metrics::getCounter("rm_receive_invalid_packets_total", "Packets which failed to deserialize")),
+	droppedPackets(Metrics::getCounter("rm_receive_dropped_packets_total", "Packets dropped because the game thread fell behind")),
+	droppedFragmentedPackets(Metrics::getCounter("rm_receive_dropped_fragmented_packets_total", "Fragmented packets never completed")),
+
+	reliablePacketsSent(Metrics::getCounter("rm_reliable_packets_sent_total", "Packets sent on reliable ordered channels")),
+	reliablePacketsReceived(Metrics::getCounter("rm_reliable_packets_received_total", "Packets received on reliable ordered channels")),
+	reliableMessagesSent(Metrics::getCounter("rm_reliable_messages_sent_total", "Messages queued on reliable ordered channels")),
+	reliableMessagesReceived(Metrics::getCounter("rm_reliable_messages_received_total", "Messages received on reliable ordered channels, duplicates included")),
+	reliableMessagesAcked(Metrics::getCounter("rm_reliable_messages_acked_total", "Reliable messages acked by the peer")),
+	reliablePacketsLost(Metrics::getCounter("rm_reliable_packets_lost_total", "Reliable packets which left the ack window unacked")),
+	unreliablePacketsSent(Metrics::getCounter("rm_unreliable_packets_sent_total", "Packets sent on unreliable channels")),
+	unreliableMessagesSent(Metrics::getCounter("rm_unreliable_messages_sent_total", "Messages sent on unreliable channels")),
+	unreliableMessagesReceived(Metrics::getCounter("rm_unreliable_messages_received_total", "Messages received on unreliable channels")),
+	packetsCoded(Metrics::getCounter("rm_packets_coded_total", "Packets sent coded by PacketCoder")),
+	packetCodingBytesSaved(Metrics::getCounter("rm_packet_coding_bytes_saved_total", "Bytes PacketCoder took off the packets it coded")),
+
+	roundTripTime(Metrics::getHistogram("rm_connection_rtt_seconds", "Round trip time of acked reliable packets",
+		{ 0.01, 0.02, 0.04, 0.06, 0.08, 0.1, 0.15, 0.2, 0.3, 0.5, 1.0 })),
+	connectionsLost(Metrics::getCounter("rm_connections_lost_total", "Connections which stopped receiving packets")),
+	connectionsFailed(Metrics::getCounter("rm_connections_failed_total", "Connection attempts which timed out")),
+
+	connectedClients(Metrics::getGauge("rm_server_clients", "Clients connected to the servers of this process")),
+	connectionsAccepted(Metrics::getCounter("rm_server_connections_accepted_total", "Clients added after a valid handshake")),
+	connectionsRejected(Metrics::getCounter("rm_server_connections_rejected_total", "Valid handshakes refused because the server was full")),
+	challengesSent(Metrics::getCounter("rm_server_challenges_sent_total", "Connection requests answered with a challenge")),
+	snapshotsSent(Metrics::getCounter("rm_server_snapshots_sent_total", "Snapshots queued for clients")),
+	snapshotSize(Metrics::getHistogram("rm_server_snapshot_bytes", "Encoded size of the shared snapshot payloads",
+		{ 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 })),
+	serverUpdateTime(Metrics::getHistogram("rm_server_update_seconds", "Time of one Server::update",
+		{ 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05 }))
+{
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <utility/metrics.h>
+
+namespace network
+{
+	/* NetworkMetrics
+	*  Metrics of the socket, channels, connections and server, registered
+	*  together on first use so every name is defined in one place.
+	*/
+	struct NetworkMetrics
+	{
+		static NetworkMetrics& get();
+
+		// Socket, datagrams on the wire
+		MetricCounter&   datagramsSent;
+		MetricCounter&   datagramsReceived;
+		MetricCounter&   bytesSent;
+		MetricCounter&   bytesReceived;
+		MetricCounter&   sendErrors;
+		MetricHistogram& datagramSize;
+
+		// PacketReceiver
+		MetricCounter&   checksumMismatches;
+		MetricCounter&   invalidPackets;
+		MetricCounter&   droppedPackets;
+		MetricCounter&   droppedFragmentedPackets;
+
+		// Channels
+		MetricCounter&   reliablePacketsSent;
+		MetricCounter&   reliablePacketsReceived;
+		MetricCounter&   reliableMessagesSent;
+		MetricCounter&   reliableMessagesReceived;
+		MetricCounter&   reliableMessagesAcked;
+		MetricCounter&   reliablePacketsLost;
+		MetricCounter&   unreliablePacketsSent;
+		MetricCounter&   unreliableMessagesSent;
+		MetricCounter&   unreliableMessagesReceived;
+		MetricCounter&   packetsCoded;
+		MetricCounter&   packetCodingBytesSaved;
+
+		// Connections
+		MetricHistogram& roundTripTime;
+		MetricCounter&   connectionsLost;
+		MetricCounter&   connectionsFailed;
+
+		// Server
+		MetricGauge&     connectedClients;
+		MetricCounter&   connectionsAccepted;
+		MetricCounter&   connectionsRejected;
+		MetricCounter&   challengesSent;
+		MetricCounter&   snapshotsSent;
+		MetricHistogram& snapshotSize;
+		MetricHistogram& serverUpdateTime;
+
+	private:
+		NetworkMetrics();
+	};
+
+}; // namespace network
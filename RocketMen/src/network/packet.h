@@ -13,23 +13,44 @@ namespace network
 	struct SentPacketEntry
 	{
 		uint16_t numMessages;
+		float    timeSent;
 		Sequence messageIds[g_maxMessagesPerPacket];
 	};
 
 	static const int32_t g_protocolId = 1000;
 	static const int32_t g_maxBlockSize = 2048;
 	static const int32_t g_packetBufferSize = g_maxBlockSize + sizeof(g_protocolId);
-	static const int32_t g_maxPacketSize = (g_maxBlockSize);
+
+	/* Datagrams stay below a conservative path MTU, packets larger than one
+	*  datagram are split in fragments of g_fragmentSize bytes */
+	static const int32_t g_maxDatagramSize       = 1200;
+	static const int32_t g_fragmentHeaderSize    = 16;
+	static const int32_t g_fragmentSize          = g_maxDatagramSize - g_fragmentHeaderSize;
+	static const int32_t g_maxFragmentsPerPacket = 16;
+	static const int32_t g_maxPacketSize         = g_fragmentSize * g_maxFragmentsPerPacket;
+
+	/* Upper bound of what a packet spends around a single message: protocol id,
+	*  datagram type, header, the message's id and type and the serialize checks */
+	static const int32_t g_maxPacketOverhead     = 64;
+
+	enum class DatagramType : uint8_t
+	{
+		Packet = 0,
+		Fragment,
+		CodedPacket,    // Packet coded by PacketCoder, after its decoded length
+
+		NUM_DATAGRAM_TYPES
+	};
 // ============================================================================
 
 	struct Packet
 	{
-		Packet::Packet()
+		Packet()
 		{
 			header = {};
 		}
 
-		Packet::~Packet()
+		~Packet()
 		{
 			for (int32_t i = 0; i < header.numMessages; i++)
 			{
@@ -63,7 +84,8 @@ namespace network
 			serializeData(stream, (char*)&header, sizeof(header));
 			if (Stream::isReading)
 			{
-				if (header.numMessages <= 0 || header.numMessages >= g_maxMessagesPerPacket)
+				// Reliable packets may carry nothing but acks
+				if (header.numMessages < 0 || header.numMessages >= g_maxMessagesPerPacket)
 				{
 					ASSERT(false, "Invalid value for numMessages");
 					return false;
@@ -0,0 +1,263 @@
+#include "packet_coder.h"
+
+#include <core/debug.h>
+
+#include <algorithm>
+
+using namespace network;
+
+/* Probabilities of a 0 bit in 11 bits, moved a 32nd towards every coded bit, as in LZMA */
+static const int32_t  s_probabilityBits = 11;
+static const uint16_t s_probabilityHalf = 1 << (s_probabilityBits - 1);
+static const int32_t  s_adaptShift      = 5;
+
+/* The range is renormalized a byte at a time once it drops below 24 bits */
+static const uint32_t s_topValue        = 1u << 24;
+
+/* Bytes are conditioned on the top bits of the byte before them */
+static const int32_t  s_contextBits     = 2;
+static const int32_t  s_numContexts     = 1 << s_contextBits;
+
+namespace
+{
+	/* Trees of 255 probabilities, one per context, index 0 is unused */
+	struct ByteModel
+	{
+		ByteModel()
+		{
+			std::fill(&probabilities[0][0], &probabilities[0][0] + s_numContexts * 256, s_probabilityHalf);
+		}
+
+		uint16_t* getTree(uint8_t previousByte)
+		{
+			return probabilities[previousByte >> (8 - s_contextBits)];
+		}
+
+		uint16_t probabilities[s_numContexts][256];
+	};
+
+	class RangeEncoder
+	{
+	public:
+		RangeEncoder(char* output, int32_t maxLength) :
+			m_low(0),
+			m_range(0xFFFFFFFF),
+			m_cache(0),
+			m_cacheSize(1),
+			m_output(output),
+			m_length(0),
+			m_maxLength(maxLength),
+			m_isFirstByte(true)
+		{
+		}
+
+		void encodeBit(uint16_t& probability, uint32_t bit)
+		{
+			const uint32_t bound = (m_range >> s_probabilityBits) * probability;
+			if (bit == 0)
+			{
+				m_range = bound;
+				probability += ((1 << s_probabilityBits) - probability) >> s_adaptShift;
+			}
+			else
+			{
+				m_low += bound;
+				m_range -= bound;
+				probability -= probability >> s_adaptShift;
+			}
+
+			while (m_range < s_topValue)
+			{
+				m_range <<= 8;
+				shiftLow();
+			}
+		}
+
+		/** @return coded length, 0 when it did not fit */
+		int32_t finish()
+		{
+			for (int32_t i = 0; i < 5; i++)
+			{
+				shiftLow();
+			}
+
+			if (isFull())
+			{
+				return 0;
+			}
+
+			// The decoder reads zeros past the end
+			while (m_length > 1 && m_output[m_length - 1] == 0)
+			{
+				m_length--;
+			}
+			return m_length;
+		}
+
+		bool isFull() const { return m_length > m_maxLength; }
+
+	private:
+		void shiftLow()
+		{
+			// Bytes of 0xFF are held back until it is known whether a carry reaches them
+			if (static_cast<uint32_t>(m_low) < 0xFF000000 || (m_low >> 32) != 0)
+			{
+				const uint8_t carry = static_cast<uint8_t>(m_low >> 32);
+				uint8_t byte = m_cache;
+				do
+				{
+					writeByte(static_cast<uint8_t>(byte + carry));
+					byte = 0xFF;
+				} while (--m_cacheSize != 0);
+				m_cache = static_cast<uint8_t>(m_low >> 24);
+			}
+			m_cacheSize++;
+			m_low = (m_low & 0x00FFFFFF) << 8;
+		}
+
+		void writeByte(uint8_t byte)
+		{
+			// The first byte is always 0, the decoder starts from it
+			if (m_isFirstByte)
+			{
+				m_isFirstByte = false;
+				return;
+			}
+
+			if (m_length < m_maxLength)
+			{
+				m_output[m_length] = static_cast<char>(byte);
+			}
+			m_length++;
+		}
+
+		uint64_t m_low;
+		uint32_t m_range;
+		uint8_t  m_cache;
+		int64_t  m_cacheSize;
+		char*    m_output;
+		int32_t  m_length;
+		int32_t  m_maxLength;
+		bool     m_isFirstByte;
+	};
+
+	class RangeDecoder
+	{
+	public:
+		RangeDecoder(const char* input, int32_t length) :
+			m_code(0),
+			m_range(0xFFFFFFFF),
+			m_input(input),
+			m_length(length),
+			m_position(0)
+		{
+			for (int32_t i = 0; i < 4; i++)
+			{
+				m_code = (m_code << 8) | readByte();
+			}
+		}
+
+		uint32_t decodeBit(uint16_t& probability)
+		{
+			const uint32_t bound = (m_range >> s_probabilityBits) * probability;
+			uint32_t bit = 0;
+			if (m_code < bound)
+			{
+				m_range = bound;
+				probability += ((1 << s_probabilityBits) - probability) >> s_adaptShift;
+			}
+			else
+			{
+				m_code -= bound;
+				m_range -= bound;
+				probability -= probability >> s_adaptShift;
+				bit = 1;
+			}
+
+			while (m_range < s_topValue)
+			{
+				m_range <<= 8;
+				m_code = (m_code << 8) | readByte();
+			}
+			return bit;
+		}
+
+	private:
+		uint32_t readByte()
+		{
+			return (m_position < m_length) ? static_cast<uint8_t>(m_input[m_position++]) : 0;
+		}
+
+		uint32_t    m_code;
+		uint32_t    m_range;
+		const char* m_input;
+		int32_t     m_length;
+		int32_t     m_position;
+	};
+
+}; // namespace
+
+bool PacketCoder::s_isEnabled = false;
+
+void PacketCoder::setEnabled(bool isEnabled)
+{
+	s_isEnabled = isEnabled;
+}
+
+bool PacketCoder::isEnabled()
+{
+	return s_isEnabled;
+}
+
+int32_t PacketCoder::encode(const char* data, int32_t length, char* coded, int32_t maxCodedLength)
+{
+	ASSERT(data != nullptr && coded != nullptr);
+	ASSERT(length > 0);
+
+	ByteModel model;
+	RangeEncoder encoder(coded, maxCodedLength);
+
+	uint8_t previousByte = 0;
+	for (int32_t i = 0; i < length && !encoder.isFull(); i++)
+	{
+		const uint8_t byte = static_cast<uint8_t>(data[i]);
+		uint16_t* tree = model.getTree(previousByte);
+		uint32_t node = 1;
+		for (int32_t bit = 7; bit >= 0; bit--)
+		{
+			const uint32_t value = (byte >> bit) & 1;
+			encoder.encodeBit(tree[node], value);
+			node = (node << 1) | value;
+		}
+		previousByte = byte;
+	}
+
+	return encoder.finish();
+}
+
+bool PacketCoder::decode(const char* coded, int32_t codedLength, char* data, int32_t length)
+{
+	ASSERT(coded != nullptr && data != nullptr);
+	if (codedLength < 0 || length <= 0)
+	{
+		return false;
+	}
+
+	ByteModel model;
+	RangeDecoder decoder(coded, codedLength);
+
+	uint8_t previousByte = 0;
+	for (int32_t i = 0; i < length; i++)
+	{
+		uint16_t* tree = model.getTree(previousByte);
+		uint32_t node = 1;
+		while (node < 256)
+		{
+			node = (node << 1) | decoder.decodeBit(tree[node]);
+		}
+		previousByte = static_cast<uint8_t>(node);
+		data[i] = static_cast<char>(previousByte);
+	}
+
+	return true;
+}
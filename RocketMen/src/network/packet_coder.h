@@ -0,0 +1,33 @@
+#pragma once
+
+#include <common.h>
+
+namespace network
+{
+	/* PacketCoder
+	*  Optional entropy coding of bit-packed packets, between Packet::serialize
+	*  and the socket. An adaptive binary range coder codes the packet byte by
+	*  byte down a tree of probabilities, conditioned on the previous byte. The
+	*  model starts over for every packet, so each packet decodes on its own
+	*  whether others were lost or reordered. Peers advertise it while enabled
+	*  and code to each other only when both ends have it enabled.
+	*/
+	class PacketCoder
+	{
+	public:
+		static void setEnabled(bool isEnabled);
+		static bool isEnabled();
+
+		/** Codes length bytes of data into coded
+		*   @return coded length, 0 when it does not fit in maxCodedLength */
+		static int32_t encode(const char* data, int32_t length, char* coded, int32_t maxCodedLength);
+
+		/** Decodes exactly length bytes of data from coded
+		*   @return false when the lengths are out of bounds */
+		static bool decode(const char* coded, int32_t codedLength, char* data, int32_t length);
+
+	private:
+		static bool s_isEnabled;
+	};
+
+}; // namespace network
@@ -3,30 +3,61 @@
 
 #include <common.h>
 #include <core/debug.h>
+#include <network/network_metrics.h>
 #include <network/packet.h>
+#include <network/packet_coder.h>
 #include <network/socket.h>
 #include <utility/utility.h>
 
+#include <algorithm>
+#include <chrono>
+
 using namespace network;
 
-extern "C" unsigned long crcFast(unsigned char const message[], int nBytes);
+extern "C" uint32_t crcFast(unsigned char const message[], int nBytes);
+
+static const int32_t s_receiveBatchSize = 32;
+
+/* Partial packets kept at once, and receive calls they may stay incomplete */
+static const int32_t s_numFragmentSets  = 8;
+static const int32_t s_maxFragmentAge   = 30;
+
+/* Decoded packets the receive thread can be ahead of the game thread */
+static const uint32_t s_receiveQueueSize = 256;
+
+/* Longest the receive thread blocks before checking whether it should stop */
+static const int32_t s_threadWaitMilliseconds = 10;
+
+/* The receive thread ages fragments at about the rate of game frames */
+static const std::chrono::milliseconds s_fragmentUpdateInterval(16);
 
 PacketReceiver::PacketReceiver(int32_t bufferSize) :
 	m_packets(bufferSize),
-	m_restriction(ReceiveRestriction::LAN)
+	m_bufferSize(bufferSize),
+	m_restriction(ReceiveRestriction::LAN),
+	m_datagrams(new Datagram[s_receiveBatchSize]),
+	m_fragments(s_numFragmentSets),
+	m_receivedPackets(s_receiveQueueSize),
+	m_isRunning(false),
+	m_numDropped(0)
 {
 }
 
 PacketReceiver::~PacketReceiver()
 {
+	stopThread();
+
 #ifdef _DEBUG
-	LOG_DEBUG("~PacketReceiver: mismatched checksums: %d", m_numChecksumMismatches);
+	LOG_DEBUG("~PacketReceiver: mismatched checksums: %d, dropped fragmented packets: %d, dropped packets: %d", 
+		m_numChecksumMismatches, m_fragments.getNumDropped(), m_numDropped);
 #endif
 
 	for (Packet* packet : m_packets)
 	{
 		delete packet;
 	}
+
+	delete[] m_datagrams;
 }
 
 void PacketReceiver::receivePackets(Socket* socket, MessageFactory* messageFactory)
@@ -34,47 +65,244 @@ void PacketReceiver::receivePackets(Socket* socket, MessageFactory* messageFacto
 	ASSERT(socket != nullptr);
 	ASSERT(socket->isInitialized(), "Socket must be initialized first");
 
-	Address address;
-	char    buffer[g_maxPacketSize];
-	int32_t length = 0;
+	// Packets handed over by in-process peers are already decoded
+	while (Packet* packet = socket->receivePacket())
+	{
+		m_packets.insert(packet);
+	}
+
+	if (isThreaded())
+	{
+		// Packets left in the queue are collected next frame
+		Packet* packet = nullptr;
+		while (static_cast<int32_t>(m_packets.getCount()) < m_bufferSize && m_receivedPackets.pop(packet))
+		{
+			m_packets.insert(packet);
+		}
+		return;
+	}
+
+	m_fragments.update(s_maxFragmentAge);
+	receiveDatagrams(socket, messageFactory);
+}
+
+bool PacketReceiver::startThread(Socket* socket, MessageFactory* messageFactory)
+{
+	ASSERT(socket != nullptr && messageFactory != nullptr);
+	ASSERT(socket->isInitialized(), "Socket must be initialized first");
+	ASSERT(!isThreaded(), "Receive thread is already running");
+
+	if (!messageFactory->canReadOffThread())
+	{
+		LOG_WARNING("PacketReceiver: messages of this factory must be read on the game thread");
+		return false;
+	}
+
+	if (!socket->canReceiveOnThread())
+	{
+		LOG_INFO("PacketReceiver: socket receives on the game thread");
+		return false;
+	}
+
+	m_isRunning.store(true, std::memory_order_release);
+	m_thread = std::thread(&PacketReceiver::runThread, this, socket, messageFactory);
+	return true;
+}
+
+void PacketReceiver::stopThread()
+{
+	if (!isThreaded())
+	{
+		return;
+	}
+
+	m_isRunning.store(false, std::memory_order_release);
+	m_thread.join();
+
+	Packet* packet = nullptr;
+	while (m_receivedPackets.pop(packet))
+	{
+		delete packet;
+	}
+}
+
+void PacketReceiver::runThread(Socket* socket, MessageFactory* messageFactory)
+{
+	auto lastFragmentUpdate = std::chrono::steady_clock::now();
 
-	while (socket->receive(address, buffer, length))
+	while (m_isRunning.load(std::memory_order_acquire))
 	{
-		if (length > g_maxPacketSize 
-			|| (!address.isFromLAN() && m_restriction == ReceiveRestriction::LAN))
+		const bool hasData = socket->waitForData(s_threadWaitMilliseconds);
+
+		const auto now = std::chrono::steady_clock::now();
+		if (now - lastFragmentUpdate >= s_fragmentUpdateInterval)
+		{
+			m_fragments.update(s_maxFragmentAge);
+			lastFragmentUpdate = now;
+		}
+
+		if (!hasData)
 		{
 			continue;
 		}
 
-		ReadStream stream(buffer, roundTo(length, 4));
-		
-		uint32_t receivedChecksum = 0;
-		serializeBits(stream, receivedChecksum, 32);
+		int32_t numDatagrams = 0;
+		while ((numDatagrams = socket->receiveBatch(m_datagrams, s_receiveBatchSize)) > 0)
+		{
+			for (int32_t i = 0; i < numDatagrams; i++)
+			{
+				Packet* packet = readDatagram(m_datagrams[i], messageFactory);
+				if (packet != nullptr && !m_receivedPackets.push(packet))
+				{
+					// The game thread stalled, dropping is what the kernel would have done
+					m_numDropped++;
+					NetworkMetrics::get().droppedPackets.add();
+					delete packet;
+				}
+			}
+
+			if (numDatagrams < s_receiveBatchSize)
+			{
+				break;
+			}
+		}
+	}
+}
 
-		// swap checksum with protocolId
-		(int32_t&)stream.getData()[0] = g_protocolId;
+void PacketReceiver::receiveDatagrams(Socket* socket, MessageFactory* messageFactory)
+{
+	int32_t numDatagrams = 0;
+	while ((numDatagrams = socket->receiveBatch(m_datagrams, s_receiveBatchSize)) > 0)
+	{
+		for (int32_t i = 0; i < numDatagrams; i++)
+		{
+			if (Packet* packet = readDatagram(m_datagrams[i], messageFactory))
+			{
+				m_packets.insert(packet);
+			}
+		}
 
-		if (receivedChecksum != crcFast((unsigned char*)stream.getData(), length))
+		if (numDatagrams < s_receiveBatchSize)
 		{
+			break;
+		}
+	}
+}
+
+Packet* PacketReceiver::readDatagram(const Datagram& datagram, MessageFactory* messageFactory)
+{
+	const int32_t length = datagram.length;
+	if (length <= 0 || length > g_maxDatagramSize 
+		|| (!datagram.address.isFromLAN() && m_restriction == ReceiveRestriction::LAN))
+	{
+		return nullptr;
+	}
+
+	return readData(datagram.address, datagram.data, length, messageFactory, false);
+}
+
+Packet* PacketReceiver::readData(const Address& address, const char* data, int32_t length, 
+	MessageFactory* messageFactory, bool isReassembled)
+{
+	ReadStream stream(data, roundTo(length, 4));
+	
+	uint32_t receivedChecksum = 0;
+	serializeBits(stream, receivedChecksum, 32);
+
+	// swap checksum with protocolId
+	(int32_t&)stream.getData()[0] = g_protocolId;
+
+	if (receivedChecksum != crcFast((unsigned char*)stream.getData(), length))
+	{
+		NetworkMetrics::get().checksumMismatches.add();
 #ifdef _DEBUG
-			m_numChecksumMismatches++;
-			LOG_DEBUG("PacketReceiver::receivePackets: Checksum mismatched, packet discarded.");
+		m_numChecksumMismatches++;
+		LOG_DEBUG("PacketReceiver::receivePackets: Checksum mismatched, packet discarded.");
 #endif
-			continue;
+		return nullptr;
+	}
+
+	uint32_t datagramType = 0;
+	serializeBits(stream, datagramType, 8);
+
+	if (datagramType == static_cast<uint32_t>(DatagramType::Fragment) && !isReassembled)
+	{
+		uint32_t sequence      = 0;
+		int32_t  numFragments  = 0;
+		int32_t  fragmentId    = 0;
+		int32_t  fragmentBytes = 0;
+		serializeBits(stream, sequence, 16);
+
+		// Read ranges are wider than the valid ones, the datagram is checked before anything is copied
+		stream.serializeInt(numFragments, 2, g_maxFragmentsPerPacket);
+		stream.serializeInt(fragmentId, 0, g_maxFragmentsPerPacket - 1);
+		stream.serializeInt(fragmentBytes, 1, g_fragmentSize);
+		if (numFragments < 2 || numFragments > g_maxFragmentsPerPacket || fragmentId >= numFragments
+			|| fragmentBytes > g_fragmentSize || roundTo(stream.getBitsRead(), 8) / 8 + fragmentBytes > length)
+		{
+			NetworkMetrics::get().invalidPackets.add();
+			return nullptr;
 		}
 
-		Packet* packet = new Packet();
-		packet->address = address;
-		if (packet->serialize(stream, messageFactory))
+		char fragment[g_fragmentSize];
+		serializeData(stream, fragment, fragmentBytes);
+
+		const char* packetData = nullptr;
+		int32_t packetLength = 0;
+		if (m_fragments.addFragment(address, static_cast<Sequence>(sequence), fragmentId, numFragments,
+			fragment, fragmentBytes, packetData, packetLength))
 		{
-			m_packets.insert(packet);
+			return readData(address, packetData, packetLength, messageFactory, true);
+		}
+		return nullptr;
+	}
+
+	if (datagramType == static_cast<uint32_t>(DatagramType::CodedPacket))
+	{
+		int32_t packetLength = 0;
+		serializeInt(stream, packetLength, 1, g_maxPacketSize);
+		const int32_t codedOffset = roundTo(stream.getBitsRead(), 8) / 8;
+		if (packetLength > g_maxPacketSize || codedOffset > length)
+		{
+			NetworkMetrics::get().invalidPackets.add();
+			return nullptr;
 		}
-		else
+
+		char packetData[g_maxPacketSize + 4];
+		if (!PacketCoder::decode(data + codedOffset, length - codedOffset, packetData, packetLength))
 		{
-			LOG_WARNING("PacketReceiver: packet serialization error");
-			delete packet;
+			NetworkMetrics::get().invalidPackets.add();
+			return nullptr;
 		}
+
+		// Padded with zeros to the words ReadStream reads
+		std::fill(packetData + packetLength, packetData + roundTo(packetLength, 4), 0);
+
+		ReadStream packetStream(packetData, roundTo(packetLength, 4));
+		return readPacket(address, packetStream, messageFactory);
+	}
+
+	if (datagramType != static_cast<uint32_t>(DatagramType::Packet))
+	{
+		return nullptr;
+	}
+
+	return readPacket(address, stream, messageFactory);
+}
+
+Packet* PacketReceiver::readPacket(const Address& address, ReadStream& stream, MessageFactory* messageFactory)
+{
+	Packet* packet = new Packet();
+	packet->address = address;
+	if (!packet->serialize(stream, messageFactory))
+	{
+		LOG_WARNING("PacketReceiver: packet serialization error");
+		NetworkMetrics::get().invalidPackets.add();
+		delete packet;
+		return nullptr;
 	}
+
+	return packet;
 }
 
 Buffer<Packet*>& PacketReceiver::getPackets()
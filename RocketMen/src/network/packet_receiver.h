@@ -2,10 +2,18 @@
 #pragma once
 
 #include <utility/buffer.h>
+#include <utility/spsc_queue.h>
 #include <network/address.h>
+#include <network/fragment_buffer.h>
+
+#include <atomic>
+#include <thread>
+
+class ReadStream;
 
 namespace network
 {
+	struct Datagram;
 	struct Packet;
 	class Socket;
 
@@ -24,14 +32,42 @@ namespace network
 		void receivePackets(Socket* socket, class MessageFactory* messageFactory);
 		Buffer<Packet*>& getPackets();
 
+		/** Receives, verifies and decodes datagrams on a thread blocking on socket,
+		*   receivePackets then only collects the decoded packets. Packets handed
+		*   over by sendPacket are still collected by receivePackets.
+		*   Local peers of a LoopbackSocket write from the game thread, so only
+		*   sockets without them are allowed
+		*   @return false if messageFactory cannot be used off the game thread */
+		bool startThread(Socket* socket, class MessageFactory* messageFactory);
+
+		/** Joins the receive thread, call before the socket is destroyed */
+		void stopThread();
+		bool isThreaded() const { return m_thread.joinable(); }
+
 		void clearPackets();
 
 		void setRestriction(ReceiveRestriction restriction) { m_restriction = restriction; }
 		ReceiveRestriction getRestriction() const { return m_restriction; }
 
 	private:
+		void receiveDatagrams(Socket* socket, class MessageFactory* messageFactory);
+		void runThread(Socket* socket, class MessageFactory* messageFactory);
+		Packet* readDatagram(const Datagram& datagram, class MessageFactory* messageFactory);
+		Packet* readData(const Address& address, const char* data, int32_t length, 
+			class MessageFactory* messageFactory, bool isReassembled);
+		Packet* readPacket(const Address& address, ReadStream& stream, class MessageFactory* messageFactory);
+
 		Buffer<Packet*>  m_packets;
+		int32_t          m_bufferSize;
 		ReceiveRestriction m_restriction;
+		Datagram* m_datagrams;
+		FragmentBuffer m_fragments;
+
+		/* Decoded by the receive thread, waiting for receivePackets */
+		SpscQueue<Packet*> m_receivedPackets;
+		std::thread        m_thread;
+		std::atomic<bool>  m_isRunning;
+		int32_t            m_numDropped;
 
 #ifdef _DEBUG
 		int32_t m_numChecksumMismatches;
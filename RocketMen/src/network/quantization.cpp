@@ -0,0 +1,117 @@
+#include "quantization.h"
+
+#include <core/debug.h>
+#include <core/entity.h>
+#include <core/entity_manager.h>
+
+using namespace network;
+
+/* Room around the map for entities flying or falling off it, further out is clamped */
+static const float s_boundsMargin = 16.0f;
+
+static QuantizationPolicy createPolicy(float positionPrecision)
+{
+	QuantizationPolicy policy;
+	policy.positionPrecision = positionPrecision;
+	return policy;
+}
+
+// Characters are reconciled against their replicated state and get the finest positions
+static QuantizationPolicy s_policies[static_cast<int32_t>(EntityType::NUM_ENTITY_TYPES)] =
+{
+	createPolicy(1.0f / 512.0f), // Entity
+	createPolicy(1.0f / 512.0f), // Character
+	createPolicy(1.0f / 256.0f), // Rocket
+	createPolicy(1.0f / 256.0f), // MovingCube
+};
+
+Vector2 Quantization::s_boundsMin(0.0f, 0.0f);
+Vector2 Quantization::s_boundsMax(0.0f, 0.0f);
+bool    Quantization::s_hasBounds = false;
+bool    Quantization::s_isEnabled = false;
+
+/* measure overrides the enabled state on its own thread only, rooms encoding
+*  snapshots on other threads keep writing with the enabled state */
+enum class MeasureMode : uint8_t
+{
+	None,
+	Full,
+	Quantized
+};
+
+static thread_local MeasureMode s_measureMode = MeasureMode::None;
+
+void Quantization::setWorldBounds(uint32_t width, uint32_t height)
+{
+	ASSERT(width > 0 && height > 0, "World bounds cannot be empty");
+
+	const Vector2 extents(0.5f * width + s_boundsMargin, 0.5f * height + s_boundsMargin);
+	s_boundsMin = -extents;
+	s_boundsMax = extents;
+	s_hasBounds = true;
+}
+
+bool Quantization::hasWorldBounds()
+{
+	return s_hasBounds;
+}
+
+void Quantization::setPolicy(EntityType type, const QuantizationPolicy& policy)
+{
+	ASSERT(type < EntityType::NUM_ENTITY_TYPES, "Invalid EntityType");
+	ASSERT(policy.positionPrecision > 0.0f && policy.velocityPrecision > 0.0f);
+	ASSERT(policy.maxVelocity > 0.0f);
+	ASSERT(policy.rotationBits > 0 && policy.rotationBits <= 16);
+
+	s_policies[static_cast<int32_t>(type)] = policy;
+}
+
+const QuantizationPolicy& Quantization::getPolicy(EntityType type)
+{
+	ASSERT(type < EntityType::NUM_ENTITY_TYPES, "Invalid EntityType");
+	return s_policies[static_cast<int32_t>(type)];
+}
+
+void Quantization::setEnabled(bool isEnabled)
+{
+	s_isEnabled = isEnabled;
+}
+
+bool Quantization::isEnabled()
+{
+	return s_isEnabled;
+}
+
+QuantizationReport Quantization::measure()
+{
+	QuantizationReport report;
+
+	for (Entity* entity : EntityManager::getEntities())
+	{
+		if (!entity->isReplicated())
+		{
+			continue;
+		}
+
+		MeasureStream fullStream;
+		s_measureMode = MeasureMode::Full;
+		EntityManager::serializeEntity(entity, fullStream);
+
+		MeasureStream quantizedStream;
+		s_measureMode = MeasureMode::Quantized;
+		EntityManager::serializeEntity(entity, quantizedStream);
+
+		report.numEntities++;
+		report.fullBits      += fullStream.getMeasuredBits();
+		report.quantizedBits += quantizedStream.getMeasuredBits();
+	}
+
+	s_measureMode = MeasureMode::None;
+	return report;
+}
+
+bool Quantization::isQuantized(FieldPolicy field)
+{
+	const bool isEnabled = (s_measureMode == MeasureMode::None) ? s_isEnabled : (s_measureMode == MeasureMode::Quantized);
+	return isEnabled && field == FieldPolicy::Quantized;
+}
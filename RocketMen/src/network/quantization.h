@@ -0,0 +1,158 @@
+#pragma once
+
+#include <common.h>
+#include <core/entity_type.h>
+#include <utility/bitstream.h>
+
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+
+namespace network
+{
+	/* How a replicated field is written */
+	enum class FieldPolicy : uint8_t
+	{
+		Skip,       // Not replicated
+		Full,       // Uncompressed 32-bit floats
+		Quantized   // Ranged with the precision of its QuantizationPolicy
+	};
+
+	/* Replication of the transform and velocity of one EntityType */
+	struct QuantizationPolicy
+	{
+		FieldPolicy position          = FieldPolicy::Quantized;
+		FieldPolicy velocity          = FieldPolicy::Quantized;
+		FieldPolicy rotation          = FieldPolicy::Skip;
+		float       positionPrecision = 1.0f / 512.0f;
+		float       velocityPrecision = 1.0f / 64.0f;
+		float       maxVelocity       = 64.0f;
+		int32_t     rotationBits      = 10;
+	};
+
+	/* Bits the replicated entities take in one snapshot, with and without quantization */
+	struct QuantizationReport
+	{
+		int32_t numEntities   = 0;
+		int32_t fullBits      = 0;
+		int32_t quantizedBits = 0;
+	};
+
+	/* Quantization
+	*  Per EntityType policies for writing positions, velocities and angles.
+	*  Positions are ranged by the bounds of the loaded map. Server and clients
+	*  must use the same policies, bounds and enabled state; until enabled
+	*  every Quantized field is written in full.
+	*/
+	class Quantization
+	{
+	public:
+		/** Bounds positions to a map of width x height tiles centered on the
+		*   origin, the way Physics::loadCollisionFromTilemap places tiles */
+		static void setWorldBounds(uint32_t width, uint32_t height);
+		static bool hasWorldBounds();
+
+		static void setPolicy(EntityType type, const QuantizationPolicy& policy);
+		static const QuantizationPolicy& getPolicy(EntityType type);
+
+		static void setEnabled(bool isEnabled);
+		static bool isEnabled();
+
+		/** Measures every replicated entity in EntityManager as a snapshot writes it,
+		*   in full and quantized, leaving the enabled state of other threads as is */
+		static QuantizationReport measure();
+
+		template<typename Stream>
+		static bool serializePosition(Stream& stream, Vector2& position, const QuantizationPolicy& policy);
+
+		template<typename Stream>
+		static bool serializeVelocity(Stream& stream, Vector2& velocity, const QuantizationPolicy& policy);
+
+		template<typename Stream>
+		static bool serializeRotation(Stream& stream, float& angle, const QuantizationPolicy& policy);
+
+	private:
+		static bool isQuantized(FieldPolicy field);
+
+		static Vector2 s_boundsMin;
+		static Vector2 s_boundsMax;
+		static bool    s_hasBounds;
+		static bool    s_isEnabled;
+	};
+
+	template<typename Stream>
+	bool Quantization::serializePosition(Stream& stream, Vector2& position, const QuantizationPolicy& policy)
+	{
+		if (policy.position == FieldPolicy::Skip)
+		{
+			return true;
+		}
+
+		if (!isQuantized(policy.position) || !s_hasBounds)
+		{
+			return serializeVector2(stream, position);
+		}
+
+		if (!serializeFloat(stream, position.x, s_boundsMin.x, s_boundsMax.x, policy.positionPrecision))
+		{
+			return false;
+		}
+
+		return serializeFloat(stream, position.y, s_boundsMin.y, s_boundsMax.y, policy.positionPrecision);
+	}
+
+	template<typename Stream>
+	bool Quantization::serializeVelocity(Stream& stream, Vector2& velocity, const QuantizationPolicy& policy)
+	{
+		if (policy.velocity == FieldPolicy::Skip)
+		{
+			return true;
+		}
+
+		if (!isQuantized(policy.velocity))
+		{
+			return serializeVector2(stream, velocity);
+		}
+
+		return serializeVector2(stream, velocity, -policy.maxVelocity, policy.maxVelocity, policy.velocityPrecision);
+	}
+
+	template<typename Stream>
+	bool Quantization::serializeRotation(Stream& stream, float& angle, const QuantizationPolicy& policy)
+	{
+		if (policy.rotation == FieldPolicy::Skip)
+		{
+			return true;
+		}
+
+		if (!isQuantized(policy.rotation))
+		{
+			return serializeFloat(stream, angle);
+		}
+
+		// Angles wrap, so the full circle maps onto the bits without a reserved end value
+		const float    twoPi = 2.0f * glm::pi<float>();
+		const uint32_t steps = 1u << policy.rotationBits;
+		uint32_t value = 0;
+		if (Stream::isWriting)
+		{
+			float turns = angle / twoPi;
+			turns -= std::floor(turns);
+			value = static_cast<uint32_t>(std::floor(turns * steps + 0.5f)) & (steps - 1);
+		}
+
+		serializeBits(stream, value, policy.rotationBits);
+
+		if (Stream::isReading)
+		{
+			angle = (static_cast<float>(value) / steps) * twoPi;
+			if (angle > glm::pi<float>())
+			{
+				angle -= twoPi;
+			}
+		}
+
+		return true;
+	}
+
+}; // namespace network
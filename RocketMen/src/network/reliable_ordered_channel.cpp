@@ -6,8 +6,11 @@
 #include <core/game_time.h>
 #include <network/message.h>
 #include <network/message_factory.h>
+#include <network/network_metrics.h>
 #include <network/sequence_buffer.h>
 
+#include <algorithm>
+
 using namespace network;
 
 static const uint32_t s_packetWindowSize        = 1024;
@@ -15,26 +18,23 @@ static const uint32_t s_packetReceiveQueueSize  = 1024;
 static const uint32_t s_packetSendQueueSize     = 256;
 static const uint32_t s_messageSendQueueSize    = 1024;
 static const uint32_t s_messageReceiveQueueSize = 256;
-static const float    s_messageResendTime       = 0.1f;
+static const Sequence s_ackWindowSize           = 33;
 static const float    s_keepAliveTime           = 1.f;
 
 ReliableOrderedChannel::ReliableOrderedChannel() :
 	m_nextSendMessageId(0),
 	m_nextReceiveMessageId(0),
-	m_lastReceivedSequence(0),
+	m_lastReceivedSequence((Sequence)INDEX_NONE),
+	m_lossCheckSequence(0),
 	m_lastPacketSendTime(.0f),
+	m_isAckPending(false),
 	m_messageSendQueue(s_messageSendQueueSize),
 	m_messageReceiveQueue(s_messageReceiveQueueSize),
 	m_sentPackets(s_packetWindowSize),
 	m_receivedPackets(s_packetReceiveQueueSize)
-#ifdef _DEBUG 
-	, m_numReceivedPackets(0),
-	m_numReceivedMessages(0),
-	m_numSentPackets(0),
-	m_numSentMessages(0),
-	m_numAcksReceived(0)
-#endif
 {
+	std::fill(m_pendingHead, m_pendingHead + NUM_PENDING_LISTS, INDEX_NONE);
+	std::fill(m_pendingTail, m_pendingTail + NUM_PENDING_LISTS, INDEX_NONE);
 }
 
 ReliableOrderedChannel::~ReliableOrderedChannel()
@@ -47,12 +47,12 @@ void ReliableOrderedChannel::sendMessage(Message* message)
 	if (OutgoingMessageEntry* messageEntry = m_messageSendQueue.insert(m_nextSendMessageId))
 	{
 		message->assignId(m_nextSendMessageId);
-		messageEntry->message = message;
+		messageEntry->message   = message;
+		messageEntry->messageId = m_nextSendMessageId;
 		messageEntry->timeLastSent = -1.f;
+		pushPending(Unsent, m_messageSendQueue.getIndex(m_nextSendMessageId));
 		m_nextSendMessageId++;
-#ifdef _DEBUG
-		m_numSentMessages++;
-#endif
+		NetworkMetrics::get().reliableMessagesSent.add();
 	}
 	else
 	{
@@ -62,18 +62,18 @@ void ReliableOrderedChannel::sendMessage(Message* message)
 
 void ReliableOrderedChannel::sendPendingMessages(Socket* socket, const Address& address, const Time& time, MessageFactory* messageFactory)
 {
-	if (hasMessagesToSend(time))
+	// Reliable data is acked at once, by a packet without messages when there is nothing to send
+	if (hasMessagesToSend(time) || m_isAckPending)
 	{
 		Packet* packet = createPacket(time);
 
 		writeAcksToPacket(*packet);
 		sendPacket(socket, address, packet, messageFactory);
 		m_lastPacketSendTime = time.getSeconds();
+		m_isAckPending = false;
 		delete packet;
 
-#ifdef _DEBUG
-		m_numSentPackets++;
-#endif
+		NetworkMetrics::get().reliablePacketsSent.add();
 	}
 	else if (time.getSeconds() - m_lastPacketSendTime > s_keepAliveTime)
 	{
@@ -83,9 +83,9 @@ void ReliableOrderedChannel::sendPendingMessages(Socket* socket, const Address&
 	m_receivedPackets.removeOldEntries();
 }
 
-void ReliableOrderedChannel::receivePacket(Packet& packet)
+void ReliableOrderedChannel::receivePacket(Packet& packet, const Time& time)
 {
-	readAcksFromPacket(packet);
+	readAcksFromPacket(packet, time);
 
 	for (int32_t i = 0; i < packet.header.numMessages; i++)
 	{
@@ -97,10 +97,12 @@ void ReliableOrderedChannel::receivePacket(Packet& packet)
 
 	m_receivedPackets.insert(packet.header.sequence);
 
-#ifdef _DEBUG
-	m_numReceivedPackets++;
-	m_numReceivedMessages += packet.header.numMessages;
-#endif
+	// Packets only carrying acks are not acked themselves, or peers would ack each other forever
+	m_isAckPending |= packet.header.numMessages > 0;
+
+	NetworkMetrics& metrics = NetworkMetrics::get();
+	metrics.reliablePacketsReceived.add();
+	metrics.reliableMessagesReceived.add(packet.header.numMessages);
 }
 
 Message* ReliableOrderedChannel::getNextMessage()
@@ -127,6 +129,11 @@ float ReliableOrderedChannel::getLastPacketSendTime() const
 	return m_lastPacketSendTime;
 }
 
+const ConnectionStats& ReliableOrderedChannel::getStats() const
+{
+	return m_stats;
+}
+
 void ReliableOrderedChannel::writeAcksToPacket(Packet& packet)
 {
 	packet.header.ackSequence = m_lastReceivedSequence;
@@ -142,7 +149,7 @@ void ReliableOrderedChannel::writeAcksToPacket(Packet& packet)
 	}
 }
 
-void ReliableOrderedChannel::readAcksFromPacket(const Packet& packet)
+void ReliableOrderedChannel::readAcksFromPacket(const Packet& packet, const Time& time)
 {
 	if (sequenceGreaterThan(packet.header.sequence, m_lastReceivedSequence))
 	{
@@ -158,48 +165,74 @@ void ReliableOrderedChannel::readAcksFromPacket(const Packet& packet)
 	{
 		if (packet.header.ackBits & (1 << i))
 		{
-			ack(packet.header.ackSequence - i - 1);
+			ack(packet.header.ackSequence - i - 1, time, false);
 		}
 	}
 
-	ack(packet.header.ackSequence);
+	// Only the newest packet was acked right as it arrived, the ack bits may have waited for a
+	// packet of the peer to ride on. Packets without messages wait for one too.
+	ack(packet.header.ackSequence, time, true);
+	detectLostPackets(packet.header.ackSequence);
 }
 
-void ReliableOrderedChannel::ack(Sequence ackSequence)
+void ReliableOrderedChannel::ack(Sequence ackSequence, const Time& time, bool isRttSample)
 {
 	if (SentPacketEntry* packetData = m_sentPackets.getEntry(ackSequence))
 	{
+		NetworkMetrics& metrics = NetworkMetrics::get();
+		if (isRttSample && packetData->numMessages > 0)
+		{
+			const float rtt = time.getSeconds() - packetData->timeSent;
+			m_stats.addPacketAcked(rtt);
+			metrics.roundTripTime.observe(rtt);
+		}
+		else
+		{
+			m_stats.addPacketAcked();
+		}
+
 		for (int16_t j = 0; j < packetData->numMessages; j++)
 		{
 			const Sequence messageId = packetData->messageIds[j];
 			if (OutgoingMessageEntry* messageEntry = m_messageSendQueue.getEntry(messageId))
 			{
+				// Acked messages were sent, so they are on the resend list
+				removePending(Resend, m_messageSendQueue.getIndex(messageId));
 				messageEntry->message->releaseRef();
 				messageEntry->message = nullptr;
 				m_messageSendQueue.remove(messageId);
-#ifdef _DEBUG
-				m_numAcksReceived++;
-#endif
+				metrics.reliableMessagesAcked.add();
 			}
 		}
 		m_sentPackets.remove(ackSequence);
 	}
 }
 
-bool ReliableOrderedChannel::hasMessagesToSend(const Time& time) const
+void ReliableOrderedChannel::detectLostPackets(Sequence ackSequence)
 {
-	for (Sequence i = 0; i < s_messageSendQueueSize; i++)
+	// Packets older than the ack window that are still unacked will not be acked anymore
+	const Sequence windowStart = ackSequence - s_ackWindowSize + 1;
+	for (uint32_t i = 0; i < s_packetWindowSize && sequenceLessThan(m_lossCheckSequence, windowStart); i++)
 	{
-		if (m_messageSendQueue.exists(i))
+		if (m_sentPackets.getEntry(m_lossCheckSequence) != nullptr)
 		{
-			OutgoingMessageEntry* messageEntry = m_messageSendQueue.getAtIndex(i);
-			if (time.getSeconds() - messageEntry->timeLastSent >= s_messageResendTime)
-			{
-				return true;
-			}
+			m_stats.addPacketLost();
+			NetworkMetrics::get().reliablePacketsLost.add();
+			m_sentPackets.remove(m_lossCheckSequence);
 		}
+		m_lossCheckSequence++;
 	}
-	return false;
+}
+
+bool ReliableOrderedChannel::hasMessagesToSend(const Time& time) const
+{
+	if (m_pendingHead[Unsent] != INDEX_NONE)
+	{
+		return true;
+	}
+
+	const OutgoingMessageEntry* messageEntry = getPending(m_pendingHead[Resend]);
+	return messageEntry != nullptr && time.getSeconds() - messageEntry->timeLastSent >= m_stats.getResendTimeout();
 }
 
 bool ReliableOrderedChannel::canSendMessage() const
@@ -213,39 +246,111 @@ Packet* ReliableOrderedChannel::createPacket(const Time& time)
 	SentPacketEntry* packetEntry = m_sentPackets.insert(packetSequence);
 	ASSERT(packetEntry != nullptr, "Failed to create packet entry");
 	packetEntry->numMessages = 0;
+	packetEntry->timeSent = time.getSeconds();
+	m_stats.addPacketSent();
 
 	Packet* packet = new Packet();
 	packet->header = {};
 	packet->header.sequence = packetSequence;
 
-	for (uint32_t i = 0; i < s_messageSendQueueSize; i++)
-	{
-		if (OutgoingMessageEntry* messageEntry = m_messageSendQueue.getAtIndex(i))
-		{
-			Message* message = messageEntry->message;
-			ASSERT(message->getType() != MessageType::None);
-			ASSERT(message->getChannel() == ChannelType::ReliableOrdered);
+	auto addMessage = [&](OutgoingMessageEntry* messageEntry) {
+		Message* message = messageEntry->message;
+		ASSERT(message->getType() != MessageType::None);
+		ASSERT(message->getChannel() == ChannelType::ReliableOrdered);
 
-			if (time.getSeconds() - messageEntry->timeLastSent >= s_messageResendTime)
-			{
-				const int32_t currentIndex = packet->header.numMessages;
-				packet->messages[currentIndex] = message->addRef();
-				packet->messageIds[currentIndex] = message->getId();
-				packet->messageTypes[currentIndex] = message->getType();
-
-				packetEntry->messageIds[currentIndex] = message->getId();
-			
-				packet->header.numMessages++;
-				packetEntry->numMessages = (int16_t)packet->header.numMessages;
-				messageEntry->timeLastSent = time.getSeconds();
-			}
-		}
+		const int32_t currentIndex = packet->header.numMessages;
+		packet->messages[currentIndex] = message->addRef();
+		packet->messageIds[currentIndex] = messageEntry->messageId;
+		packet->messageTypes[currentIndex] = message->getType();
+
+		packetEntry->messageIds[currentIndex] = messageEntry->messageId;
 
-		if (packet->header.numMessages == g_maxMessagesPerPacket)
+		packet->header.numMessages++;
+		packetEntry->numMessages = (int16_t)packet->header.numMessages;
+		messageEntry->timeLastSent = time.getSeconds();
+	};
+
+	// Packets hold less than g_maxMessagesPerPacket messages, see Packet::serialize
+	const int32_t maxMessages = g_maxMessagesPerPacket - 1;
+
+	// Overdue resends go first, they carry the oldest message ids. Each one
+	// moves to the back of the list, where the loop stops as it is not due.
+	int32_t index = m_pendingHead[Resend];
+	while (index != INDEX_NONE && packet->header.numMessages < maxMessages)
+	{
+		OutgoingMessageEntry* messageEntry = getPending(index);
+		if (time.getSeconds() - messageEntry->timeLastSent < m_stats.getResendTimeout())
 		{
 			break;
 		}
+
+		const int32_t nextIndex = messageEntry->nextPending;
+		addMessage(messageEntry);
+		removePending(Resend, index);
+		pushPending(Resend, index);
+		index = nextIndex;
+	}
+
+	while (m_pendingHead[Unsent] != INDEX_NONE && packet->header.numMessages < maxMessages)
+	{
+		index = m_pendingHead[Unsent];
+		addMessage(getPending(index));
+		removePending(Unsent, index);
+		pushPending(Resend, index);
 	}
 
 	return packet;
 }
+
+void ReliableOrderedChannel::pushPending(PendingList list, int32_t index)
+{
+	OutgoingMessageEntry* messageEntry = getPending(index);
+	ASSERT(messageEntry != nullptr);
+
+	messageEntry->prevPending = m_pendingTail[list];
+	messageEntry->nextPending = INDEX_NONE;
+
+	if (OutgoingMessageEntry* tailEntry = getPending(m_pendingTail[list]))
+	{
+		tailEntry->nextPending = index;
+	}
+	else
+	{
+		m_pendingHead[list] = index;
+	}
+	m_pendingTail[list] = index;
+}
+
+void ReliableOrderedChannel::removePending(PendingList list, int32_t index)
+{
+	OutgoingMessageEntry* messageEntry = getPending(index);
+	ASSERT(messageEntry != nullptr);
+
+	if (OutgoingMessageEntry* prevEntry = getPending(messageEntry->prevPending))
+	{
+		prevEntry->nextPending = messageEntry->nextPending;
+	}
+	else
+	{
+		ASSERT(m_pendingHead[list] == index, "Message is not on this pending list");
+		m_pendingHead[list] = messageEntry->nextPending;
+	}
+
+	if (OutgoingMessageEntry* nextEntry = getPending(messageEntry->nextPending))
+	{
+		nextEntry->prevPending = messageEntry->prevPending;
+	}
+	else
+	{
+		ASSERT(m_pendingTail[list] == index, "Message is not on this pending list");
+		m_pendingTail[list] = messageEntry->prevPending;
+	}
+
+	messageEntry->prevPending = INDEX_NONE;
+	messageEntry->nextPending = INDEX_NONE;
+}
+
+OutgoingMessageEntry* ReliableOrderedChannel::getPending(int32_t index) const
+{
+	return (index == INDEX_NONE) ? nullptr : m_messageSendQueue.getAtIndex(index);
+}
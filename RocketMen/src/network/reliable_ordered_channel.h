@@ -2,6 +2,7 @@
 #pragma once
 
 #include <utility/circular_buffer.h>
+#include <network/connection_stats.h>
 #include <network/network_channel.h>
 #include <network/packet.h>
 #include <network/sequence_buffer.h>
@@ -19,39 +20,55 @@ namespace network
 		virtual void sendPendingMessages(Socket* socket,
 			const Address& address, const Time& time, MessageFactory* messageFactory) override;
 
-		virtual void receivePacket(Packet& packet) override;
+		virtual void receivePacket(Packet& packet, const Time& time) override;
 
 		virtual Message* getNextMessage() override;
 
 		float getLastPacketSendTime() const;
+		const ConnectionStats& getStats() const;
 
 	private:
 		void writeAcksToPacket(Packet& packet);
-		void readAcksFromPacket(const Packet& packet);
-		void ack(Sequence ackSequence);
+		void readAcksFromPacket(const Packet& packet, const Time& time);
+		/** @param isRttSample  Whether the ack was sent as the packet arrived */
+		void ack(Sequence ackSequence, const Time& time, bool isRttSample);
+		void detectLostPackets(Sequence ackSequence);
 		bool hasMessagesToSend(const Time& time) const;
 		bool canSendMessage() const;
 
 		Packet* createPacket(const Time& time);
 
+		/* Unacked messages are on one of two lists, so finding the ones to
+		*  send costs nothing when none are due. Messages never sent are due
+		*  at once; sent ones are appended as they go out, which keeps the
+		*  resend list ordered by resend time. */
+		enum PendingList
+		{
+			Unsent = 0,
+			Resend,
+
+			NUM_PENDING_LISTS
+		};
+
+		void pushPending(PendingList list, int32_t index);
+		void removePending(PendingList list, int32_t index);
+		OutgoingMessageEntry* getPending(int32_t index) const;
+
 		Sequence m_nextSendMessageId;
 		Sequence m_nextReceiveMessageId;
 		Sequence m_lastReceivedSequence;
+		Sequence m_lossCheckSequence;
 		float    m_lastPacketSendTime;
+		bool     m_isAckPending;
+		ConnectionStats m_stats;
 
 		SequenceBuffer<OutgoingMessageEntry> m_messageSendQueue;
 		SequenceBuffer<IncomingMessageEntry> m_messageReceiveQueue;
 		SequenceBuffer<SentPacketEntry>      m_sentPackets;
 		SequenceBuffer<SentPacketEntry>      m_receivedPackets;
 
-#ifdef _DEBUG
-		int32_t m_numReceivedPackets;
-		int32_t m_numReceivedMessages;
-
-		int32_t m_numSentPackets;
-		int32_t m_numSentMessages;
-		int32_t m_numAcksReceived;
-#endif
+		int32_t m_pendingHead[NUM_PENDING_LISTS];
+		int32_t m_pendingTail[NUM_PENDING_LISTS];
 	};
 
 }; // namespace network
\ No newline at end of file
@@ -11,9 +11,20 @@ RemoteClient::RemoteClient() :
 	m_connection(nullptr),
 	m_id(INDEX_NONE),
 	m_nextNetworkId(0),
-	m_playerIds(s_maxPlayersPerClient)
+	m_ackedSnapshot(0),
+	m_hasAckedSnapshot(false),
+	m_lastInputFrame(0),
+	m_hasInputFrame(false),
+	m_nextInputFrame(0),
+	m_lastQueuedFrame(0),
+	m_hasQueuedInput(false),
+	m_playerIds(s_maxPlayersPerClient),
+	m_relevance(s_snapshotHistorySize),
+	m_sentStates(s_snapshotHistorySize),
+	m_inputs(s_inputBufferSize)
 {
 	std::fill(m_recentNetworkIds,  m_recentNetworkIds  + s_networkIdBufferSize, INDEX_NONE);
+	std::fill(m_priorities, m_priorities + s_maxNetworkedEntities, 0.0f);
 }
 
 RemoteClient::~RemoteClient()
@@ -33,6 +44,11 @@ void RemoteClient::clear()
 {
 	m_id = INDEX_NONE;
 	m_playerIds.clear();
+	m_hasAckedSnapshot = false;
+	m_hasInputFrame    = false;
+	m_hasQueuedInput   = false;
+	m_actionDictionary.clear();
+	std::fill(m_priorities, m_priorities + s_maxNetworkedEntities, 0.0f);
 
 	delete m_connection;
 	m_connection = nullptr;
@@ -50,6 +66,112 @@ void RemoteClient::sendMessage(Message* message)
 	m_connection->sendMessage(message);
 }
 
+void RemoteClient::setAckedSnapshot(Sequence sequence)
+{
+	m_ackedSnapshot    = sequence;
+	m_hasAckedSnapshot = true;
+}
+
+bool RemoteClient::getAckedSnapshot(Sequence& sequence) const
+{
+	sequence = m_ackedSnapshot;
+	return m_hasAckedSnapshot;
+}
+
+InputFrame* RemoteClient::insertInput(Sequence frame)
+{
+	if (!m_hasQueuedInput)
+	{
+		m_nextInputFrame = frame;
+		m_hasQueuedInput = true;
+	}
+	else if (!sequenceGreaterThan(frame, m_lastQueuedFrame))
+	{
+		return nullptr;
+	}
+
+	InputFrame* input = m_inputs.insert(frame);
+	if (input != nullptr)
+	{
+		m_lastQueuedFrame = frame;
+		for (ActionBuffer& actions : input->actions)
+		{
+			actions.clear();
+		}
+		input->hasViewFrame = false;
+	}
+	return input;
+}
+
+InputFrame* RemoteClient::getNextInput()
+{
+	return (getNumQueuedInputs() > 0) ? m_inputs.getEntry(m_nextInputFrame) : nullptr;
+}
+
+void RemoteClient::popInput()
+{
+	ASSERT(getNumQueuedInputs() > 0, "No input queued");
+	m_inputs.remove(m_nextInputFrame);
+
+	m_lastInputFrame = m_nextInputFrame;
+	m_hasInputFrame  = true;
+	m_nextInputFrame++;
+}
+
+int32_t RemoteClient::getNumQueuedInputs() const
+{
+	return m_hasQueuedInput ? sequenceDifference(m_lastQueuedFrame, m_nextInputFrame) + 1 : 0;
+}
+
+bool RemoteClient::getLastInputFrame(Sequence& frame) const
+{
+	frame = m_lastInputFrame;
+	return m_hasInputFrame;
+}
+
+RelevanceMask* RemoteClient::insertRelevance(Sequence sequence)
+{
+	RelevanceMask* mask = m_relevance.insert(sequence);
+	if (mask != nullptr)
+	{
+		mask->reset();
+	}
+	return mask;
+}
+
+const RelevanceMask* RemoteClient::getRelevance(Sequence sequence) const
+{
+	return m_relevance.getEntry(sequence);
+}
+
+WorldState* RemoteClient::insertSentState(Sequence sequence)
+{
+	return m_sentStates.insert(sequence);
+}
+
+const WorldState* RemoteClient::getSentState(Sequence sequence) const
+{
+	return m_sentStates.getEntry(sequence);
+}
+
+void RemoteClient::removeSentState(Sequence sequence)
+{
+	m_sentStates.remove(sequence);
+}
+
+float RemoteClient::addPriority(int32_t networkId, float priority)
+{
+	ASSERT(networkId >= 0 && networkId < s_maxNetworkedEntities);
+	m_priorities[networkId] += priority;
+	return m_priorities[networkId];
+}
+
+void RemoteClient::resetPriority(int32_t networkId)
+{
+	ASSERT(networkId >= 0 && networkId < s_maxNetworkedEntities);
+	m_priorities[networkId] = 0.0f;
+}
+
 bool RemoteClient::isUsed() const
 {
 	return (m_id > INDEX_NONE);
@@ -92,6 +214,11 @@ Buffer<int16_t>& RemoteClient::getPlayerIds()
 	return m_playerIds;
 }
 
+ActionDictionary& RemoteClient::getActionDictionary()
+{
+	return m_actionDictionary;
+}
+
 bool network::operator==(const RemoteClient& a, const RemoteClient& b)
 {
 	return (a.m_id == b.m_id);
@@ -1,8 +1,13 @@
 
 #pragma once
 
+#include <core/action_buffer.h>
+#include <core/action_dictionary.h>
 #include <utility/buffer.h>
 #include <network/address.h>
+#include <network/common_network.h>
+#include <network/sequence_buffer.h>
+#include <network/world_state.h>
 
 #include <array>
 #include <vector>
@@ -12,6 +17,16 @@ namespace network
 	class  Connection;
 	struct Message;
 
+	/* Input of the players of a client for one of its frames, with the frame
+	*  it was viewing the world at */
+	struct InputFrame
+	{
+		ActionBuffer actions[s_maxPlayersPerClient];
+		bool         hasViewFrame;
+		Sequence     viewFrame;
+		float        viewFraction;
+	};
+
 	class RemoteClient
 	{
 	private:
@@ -26,6 +41,44 @@ namespace network
 		void addPlayer(int16_t playerId);
 		void sendMessage(Message* message);
 
+		/** Records the latest snapshot the client acknowledged, used as delta baseline */
+		void setAckedSnapshot(Sequence sequence);
+
+		/** @return false if the client has not acknowledged any snapshot yet */
+		bool getAckedSnapshot(Sequence& sequence) const;
+
+		/** Queues the input of frame until a server tick executes it
+		*   @return nullptr when frame was queued before */
+		InputFrame* insertInput(Sequence frame);
+
+		/** @return the oldest queued input, nullptr when it was lost or none is queued */
+		InputFrame* getNextInput();
+
+		/** Removes the oldest queued input and records its frame as executed */
+		void popInput();
+
+		int32_t getNumQueuedInputs() const;
+
+		/** @return false if no input of the client was executed yet, otherwise
+		*   the frame the client replays its prediction from */
+		bool getLastInputFrame(Sequence& frame) const;
+
+		/** @return mask to fill with the entities sent in snapshot sequence */
+		RelevanceMask* insertRelevance(Sequence sequence);
+
+		/** @return entities sent in snapshot sequence, nullptr if unknown */
+		const RelevanceMask* getRelevance(Sequence sequence) const;
+
+		/* World state as this client holds it after snapshot sequence, only
+		*  kept when entities were deferred and it differs from the server's */
+		WorldState*       insertSentState(Sequence sequence);
+		const WorldState* getSentState(Sequence sequence) const;
+		void              removeSentState(Sequence sequence);
+
+		/* Snapshot priority accumulated by networkId since it was last sent */
+		float addPriority(int32_t networkId, float priority);
+		void  resetPriority(int32_t networkId);
+
 		bool        isUsed()                     const;
 		bool        isAvailable()                const;
 		bool        ownsPlayer(int16_t playerId) const;
@@ -35,13 +88,30 @@ namespace network
 
 		Buffer<int16_t>& getPlayerIds();
 
+		/* Actions the client registered, its input refers to them by index */
+		ActionDictionary& getActionDictionary();
+
 	private:
 		Connection* m_connection;
 		int32_t	    m_id;
 		int32_t     m_recentNetworkIds[s_networkIdBufferSize];
 		int8_t      m_nextNetworkId;
+		Sequence    m_ackedSnapshot;
+		bool        m_hasAckedSnapshot;
+		Sequence    m_lastInputFrame;
+		bool        m_hasInputFrame;
+
+		/* Queued input runs from m_nextInputFrame up to m_lastQueuedFrame */
+		Sequence    m_nextInputFrame;
+		Sequence    m_lastQueuedFrame;
+		bool        m_hasQueuedInput;
 
 		Buffer<int16_t> m_playerIds;
+		ActionDictionary m_actionDictionary;
+		SequenceBuffer<RelevanceMask> m_relevance;
+		SequenceBuffer<WorldState>    m_sentStates;
+		SequenceBuffer<InputFrame>    m_inputs;
+		float m_priorities[s_maxNetworkedEntities];
 	
 		friend bool operator== (const RemoteClient& a, const RemoteClient& b);
 		friend bool operator!= (const RemoteClient& a, const RemoteClient& b);
@@ -2,49 +2,79 @@
 #include <network/remote_client_manager.h>
 
 #include <core/debug.h>
+#include <network/address_table.h>
+#include <network/common_network.h>
 #include <network/connection.h>
+#include <network/datagram_queue.h>
 #include <network/remote_client.h>
 #include <network/message.h>
+#include <network/network_metrics.h>
+#include <network/socket.h>
+#include <utility/worker_pool.h>
+
+#include <algorithm>
+#include <thread>
 
 using namespace network;
 
-RemoteClientManager::RemoteClientManager(int32_t size) :
+RemoteClientManager::RemoteClientManager(int32_t maxClients) :
+	m_slots(nullptr),
+	m_size(0),
+	m_addresses(nullptr),
+	m_usedIndices(nullptr),
 	m_localClientId(INDEX_NONE),
-	m_clientIdCounter(0)
+	m_clientIdCounter(0),
+	m_sendWorkers(nullptr),
+	m_sendQueues(nullptr),
+	m_sendClients(nullptr)
 {
-	ASSERT(size > 0, "size cannot be 0");
-	m_size = size;
-	m_clients = new RemoteClient[m_size];
+	allocate(maxClients);
 }
 
 RemoteClientManager::~RemoteClientManager()
 {
-	delete[] m_clients;
+	clear();
+	release();
+	delete m_sendWorkers;
 }
 
 RemoteClient* RemoteClientManager::add(Connection* connection)
 {
 	ASSERT(connection != nullptr);
-	if (getClient(connection))
+	if (m_freeSlots.empty() || getClient(connection->getAddress()))
 	{
 		return nullptr;
 	}
 
-	for (RemoteClient* client = begin(); client != end(); client++)
+	const int32_t slot = m_freeSlots.back();
+	if (!m_addresses->insert(connection->getAddress(), slot))
 	{
-		if (client->isAvailable())
-		{
-			client->initialize(m_clientIdCounter++, connection);
-			return client;
-		}
+		return nullptr;
 	}
+	m_freeSlots.pop_back();
+
+	if (m_slots[slot] == nullptr)
+	{
+		m_slots[slot] = new RemoteClient();
+	}
+
+	RemoteClient* client = m_slots[slot];
+	client->initialize(m_clientIdCounter++, connection);
 
-	return nullptr;
+	m_usedIndices[slot] = static_cast<int32_t>(m_usedClients.size());
+	m_usedClients.push_back(client);
+	m_usedSlots.push_back(slot);
+	NetworkMetrics::get().connectedClients.add(1);
+	return client;
 }
 
 void RemoteClientManager::remove(RemoteClient* client)
 {
 	ASSERT(client != nullptr);
+	ASSERT(client->isUsed());
+
+	const int32_t slot = m_addresses->find(client->getConnection()->getAddress());
+	ASSERT(slot != INDEX_NONE && m_slots[slot] == client, "Client is not in the registry");
 
 	if (!client->getConnection()->isClosed())
 	{
@@ -52,7 +82,21 @@ void RemoteClientManager::remove(RemoteClient* client)
 		client->getConnection()->close();
 	}
 
+	m_addresses->remove(client->getConnection()->getAddress());
 	client->clear();
+
+	// Keep the used clients dense, the last one takes the removed one's place
+	const int32_t index = m_usedIndices[slot];
+	const int32_t lastSlot = m_usedSlots.back();
+	m_usedClients[index] = m_usedClients.back();
+	m_usedSlots[index]   = lastSlot;
+	m_usedIndices[lastSlot] = index;
+	m_usedClients.pop_back();
+	m_usedSlots.pop_back();
+	m_usedIndices[slot] = INDEX_NONE;
+
+	m_freeSlots.push_back(slot);
+	NetworkMetrics::get().connectedClients.add(-1);
 }
 
 int32_t RemoteClientManager::getMaxClients() const
@@ -62,39 +106,39 @@ int32_t RemoteClientManager::getMaxClients() const
 
 int32_t RemoteClientManager::count() const
 {
-	int32_t result = 0;
-	for (RemoteClient* client = begin(); client != end(); client++)
+	return static_cast<int32_t>(m_usedClients.size());
+}
+
+void RemoteClientManager::clear()
+{
+	while (!m_usedClients.empty())
 	{
-		if (client->isUsed())
-		{
-			result++;
-		}
+		RemoteClient* client = m_usedClients.back();
+		client->getConnection()->close();
+		remove(client);
 	}
-	return result;
 }
 
-void RemoteClientManager::clear()
+bool RemoteClientManager::setMaxClients(int32_t maxClients)
 {
-	for (RemoteClient* client = begin(); client != end(); client++)
+	if (count() > 0)
 	{
-		if (client->isUsed())
-		{
-			client->getConnection()->close();
-			client->clear();
-		}
+		LOG_WARNING("RemoteClientManager: capacity cannot change while clients are connected");
+		return false;
 	}
+
+	release();
+	allocate(maxClients);
+	return true;
 }
 
 void RemoteClientManager::sendMessage(struct Message* message, bool skipLocalClient)
 {
-	for (RemoteClient* client = begin(); client != end(); client++)
+	for (RemoteClient* client : m_usedClients)
 	{
-		if (client->isUsed())
+		if (!(skipLocalClient && client->getId() == m_localClientId))
 		{
-			if (!(skipLocalClient && client->getId() == m_localClientId))
-			{
-				client->sendMessage(message->addRef());
-			}
+			client->sendMessage(message->addRef());
 		}
 	}
 
@@ -103,9 +147,11 @@ void RemoteClientManager::sendMessage(struct Message* message, bool skipLocalCli
 
 void RemoteClientManager::updateConnections(const Time& time)
 {
-	for (RemoteClient* client = begin(); client != end(); client++)
+	// Backwards, a lost connection removes its client and the last client moves into its place
+	for (int32_t i = count() - 1; i >= 0; i--)
 	{
-		if (client->isUsed() && client->getId() != m_localClientId)
+		RemoteClient* client = m_usedClients[i];
+		if (client->getId() != m_localClientId)
 		{
 			client->getConnection()->update(time);
 		}
@@ -114,13 +160,58 @@ void RemoteClientManager::updateConnections(const Time& time)
 
 void RemoteClientManager::sendPendingMessages(const Time& time)
 {
-	for (RemoteClient* client = begin(); client != end(); client++)
+	int32_t numParallel = 0;
+	for (RemoteClient* client : m_usedClients)
 	{
-		if (client->isUsed())
+		if (isSentInParallel(client))
+		{
+			numParallel++;
+		}
+	}
+
+	const bool isParallel = numParallel >= s_minParallelSendClients;
+	if (isParallel && m_sendWorkers == nullptr)
+	{
+		const int32_t numHardwareThreads = static_cast<int32_t>(std::thread::hardware_concurrency());
+		const int32_t numWorkers = std::max(0, std::min(numHardwareThreads - 1, s_maxSendWorkers));
+		m_sendWorkers = new WorkerPool(numWorkers);
+		LOG_INFO("Server: sending to clients on %d send workers", numWorkers);
+	}
+
+	if (isParallel && m_sendQueues == nullptr)
+	{
+		m_sendQueues  = new DatagramQueue[m_size];
+		m_sendClients = new RemoteClient*[m_size];
+	}
+
+	numParallel = 0;
+	for (RemoteClient* client : m_usedClients)
+	{
+		if (isParallel && isSentInParallel(client))
+		{
+			m_sendClients[numParallel++] = client;
+		}
+		else
 		{
 			client->getConnection()->sendPendingMessages(time);
 		}
 	}
+
+	if (!isParallel)
+	{
+		return;
+	}
+
+	// Workers only touch the connection of their client and its queue, shared 
+	// messages and payloads are reference counted atomically
+	m_sendWorkers->run(numParallel, [this, &time](int32_t index) {
+		m_sendClients[index]->getConnection()->sendPendingMessages(time, &m_sendQueues[index]);
+	});
+
+	for (int32_t i = 0; i < numParallel; i++)
+	{
+		m_sendQueues[i].flushTo(m_sendClients[i]->getConnection()->getSocket());
+	}
 }
 
 void RemoteClientManager::setLocalClientId(int32_t id)
@@ -133,46 +224,73 @@ int32_t RemoteClientManager::getLocalClientId() const
 	return m_localClientId;
 }
 
+bool RemoteClientManager::isSentInParallel(const RemoteClient* client) const
+{
+	// The local client shares messages by reference through the loopback socket
+	const Connection* connection = client->getConnection();
+	return client->getId() != m_localClientId
+		&& !connection->getSocket()->sharesMessagesWith(connection->getAddress());
+}
+
 RemoteClient* RemoteClientManager::getClient(const Address& address) const
 {
-	for (RemoteClient* client = begin(); client != end(); client++)
-	{
-		if (client->isUsed() && client->getConnection()->getAddress() == address)
-		{
-			return client;
-		}
-	}
-	return nullptr;
+	const int32_t slot = m_addresses->find(address);
+	return slot != INDEX_NONE ? m_slots[slot] : nullptr;
 }
 
 RemoteClient* RemoteClientManager::getClient(const Connection* connection) const
 {
-	for (RemoteClient* client = begin(); client != end(); client++)
-	{
-		if (client->isUsed() && client->getConnection() == connection)
-		{
-			return client;
-		}
-	}
-	return nullptr;
+	ASSERT(connection != nullptr);
+	RemoteClient* client = getClient(connection->getAddress());
+	return (client != nullptr && client->getConnection() == connection) ? client : nullptr;
 }
 
-RemoteClient* RemoteClientManager::begin()
+RemoteClientManager::Iterator RemoteClientManager::begin() const
 {
-	return m_clients;
+	return Iterator(m_usedClients.data());
 }
 
-RemoteClient* RemoteClientManager::begin() const
+RemoteClientManager::Iterator RemoteClientManager::end() const
 {
-	return m_clients;
+	return Iterator(m_usedClients.data() + m_usedClients.size());
 }
 
-RemoteClient* RemoteClientManager::end()
+void RemoteClientManager::allocate(int32_t maxClients)
 {
-	return m_clients + m_size;
+	ASSERT(maxClients > 0, "maxClients cannot be 0");
+	m_size        = maxClients;
+	m_slots       = new RemoteClient*[m_size]();
+	m_usedIndices = new int32_t[m_size];
+	m_addresses   = new AddressTable(m_size);
+	std::fill(m_usedIndices, m_usedIndices + m_size, INDEX_NONE);
+
+	// Lowest slots are used first
+	m_freeSlots.clear();
+	for (int32_t slot = m_size - 1; slot >= 0; slot--)
+	{
+		m_freeSlots.push_back(slot);
+	}
+	m_usedClients.reserve(m_size);
+	m_usedSlots.reserve(m_size);
 }
 
-RemoteClient* RemoteClientManager::end() const
+void RemoteClientManager::release()
 {
-	return m_clients + m_size;
-}
\ No newline at end of file
+	ASSERT(m_usedClients.empty());
+	for (int32_t slot = 0; slot < m_size; slot++)
+	{
+		delete m_slots[slot];
+	}
+
+	delete[] m_slots;
+	delete[] m_usedIndices;
+	delete m_addresses;
+	delete[] m_sendQueues;
+	delete[] m_sendClients;
+	m_slots       = nullptr;
+	m_usedIndices = nullptr;
+	m_addresses   = nullptr;
+	m_sendQueues  = nullptr;
+	m_sendClients = nullptr;
+	m_size        = 0;
+}
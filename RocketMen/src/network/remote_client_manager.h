@@ -3,18 +3,45 @@
 
 #include <common.h>
 
+#include <vector>
+
 class Time;
+class WorkerPool;
 
 namespace network
 {
 	class Address;
+	class AddressTable;
 	class Connection;
+	class DatagramQueue;
 	class RemoteClient;
 
+	/* RemoteClientManager
+	*  Registry of the connected clients. Clients are found by address in an
+	*  AddressTable and iterated in a dense list, so neither depends on the
+	*  capacity. RemoteClients are allocated when a slot is first used and 
+	*  kept for reuse.
+	*/
 	class RemoteClientManager
 	{
 	public:
-		RemoteClientManager(int32_t size);
+		/* Iterates the used clients only */
+		class Iterator
+		{
+		public:
+			Iterator(RemoteClient* const* client) : m_client(client) {}
+
+			RemoteClient& operator*()  const { return **m_client; }
+			RemoteClient* operator->() const { return *m_client; }
+			Iterator& operator++() { ++m_client; return *this; }
+			bool operator!=(const Iterator& other) const { return m_client != other.m_client; }
+
+		private:
+			RemoteClient* const* m_client;
+		};
+
+	public:
+		RemoteClientManager(int32_t maxClients);
 		~RemoteClientManager();
 
 		RemoteClient* add(Connection* connection);
@@ -23,8 +50,15 @@ namespace network
 		int32_t count() const;
 		void clear();
 
+		/** Changes the capacity, only while no client is connected */
+		bool setMaxClients(int32_t maxClients);
+
 		void sendMessage(struct Message* message, bool skipLocalClient = false);
 		void updateConnections(const Time& time);
+
+		/** Builds and encodes the packets of remote clients on send workers
+		*   once there are s_minParallelSendClients of them, the datagrams are
+		*   sent from the calling thread after every worker is done */
 		void sendPendingMessages(const Time& time);
 
 		void setLocalClientId(int32_t id);
@@ -33,15 +67,32 @@ namespace network
 		RemoteClient* getClient(const Address& address) const;
 		RemoteClient* getClient(const Connection* connection) const;
 
-		RemoteClient* begin();
-		RemoteClient* begin() const;
-		RemoteClient* end();
-		RemoteClient* end() const;
+		Iterator begin() const;
+		Iterator end() const;
 	private:
-		RemoteClient* m_clients;
-		int32_t m_size;
+		bool isSentInParallel(const RemoteClient* client) const;
+		void allocate(int32_t maxClients);
+		void release();
+
+		/* Slots by index, nullptr until first used */
+		RemoteClient** m_slots;
+		int32_t        m_size;
+
+		AddressTable*              m_addresses;
+		std::vector<int32_t>       m_freeSlots;
+		std::vector<RemoteClient*> m_usedClients;
+		std::vector<int32_t>       m_usedSlots;
+
+		/* Position of each used slot in m_usedClients */
+		int32_t* m_usedIndices;
+
 		int32_t m_localClientId;
 		int32_t m_clientIdCounter;
+
+		/* Created by the first parallel send */
+		WorkerPool*    m_sendWorkers;
+		DatagramQueue* m_sendQueues;
+		RemoteClient** m_sendClients;
 	};
 
-}; //namespace network
\ No newline at end of file
+}; //namespace network
@@ -0,0 +1,136 @@
+#include "replay_socket.h"
+
+#include <core/debug.h>
+
+#include <cstring>
+
+using namespace network;
+
+ReplaySocket::ReplaySocket(const std::string& path, ReplayClock* clock) :
+	m_path(path),
+	m_clock(clock),
+	m_hasNext(false),
+	m_isInitialized(false),
+	m_port(0),
+	m_startTime(0),
+	m_firstTimestamp(0),
+	m_bytesReceived(0),
+	m_bytesSent(0),
+	m_packetsReceived(0),
+	m_packetsSent(0)
+{
+	ASSERT(clock != nullptr);
+}
+
+ReplaySocket::~ReplaySocket()
+{
+	// Closed before the end, there is nothing left to wait for
+	if (m_hasNext)
+	{
+		m_clock->numFinished++;
+	}
+
+	LOG_INFO("ReplaySocket: %llu datagrams replayed, %llu sent datagrams dropped",
+		static_cast<unsigned long long>(m_packetsReceived), static_cast<unsigned long long>(m_packetsSent));
+}
+
+bool ReplaySocket::initialize(uint16_t port)
+{
+	ASSERT(!m_isInitialized);
+	if (!m_reader.open(m_path))
+	{
+		LOG_ERROR("ReplaySocket: %s is not a capture", m_path.c_str());
+		return false;
+	}
+
+	m_port = port;
+	m_isInitialized = true;
+	m_startTime = m_clock->time;
+	m_clock->numOpened++;
+
+	readNext();
+	if (!m_hasNext)
+	{
+		LOG_WARNING("ReplaySocket: %s holds no datagrams received on port %d", m_path.c_str(), port);
+	}
+	else
+	{
+		m_firstTimestamp = m_next.timestamp;
+	}
+
+	return true;
+}
+
+bool ReplaySocket::isInitialized() const
+{
+	return m_isInitialized;
+}
+
+bool ReplaySocket::receive(Address& address, char* buffer, int32_t& length)
+{
+	if (!m_hasNext || m_next.timestamp - m_firstTimestamp > m_clock->time - m_startTime)
+	{
+		return false;
+	}
+
+	address = m_next.datagram.address;
+	length  = m_next.datagram.length;
+	memcpy(buffer, m_next.datagram.data, length);
+
+	m_bytesReceived += length;
+	m_packetsReceived++;
+
+	readNext();
+	return true;
+}
+
+bool ReplaySocket::send(const Address& /*address*/, const void* /*buffer*/, const size_t length)
+{
+	m_bytesSent += length;
+	m_packetsSent++;
+	return true;
+}
+
+void ReplaySocket::readNext()
+{
+	while (m_reader.read(m_next))
+	{
+		if (m_next.direction == CaptureDirection::Received && (m_next.localPort == m_port || m_port == 0))
+		{
+			m_port = m_next.localPort;
+			m_hasNext = true;
+			return;
+		}
+	}
+
+	if (m_isInitialized)
+	{
+		m_clock->numFinished++;
+	}
+	m_hasNext = false;
+}
+
+uint32_t ReplaySocket::getPort() const
+{
+	return m_port;
+}
+
+uint64_t ReplaySocket::getBytesReceived() const
+{
+	return m_bytesReceived;
+}
+
+uint64_t ReplaySocket::getBytesSent() const
+{
+	return m_bytesSent;
+}
+
+uint64_t ReplaySocket::getPacketsReceived() const
+{
+	return m_packetsReceived;
+}
+
+uint64_t ReplaySocket::getPacketsSent() const
+{
+	return m_packetsSent;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <network/datagram_capture.h>
+#include <network/socket.h>
+
+#include <string>
+
+namespace network
+{
+	/* Time of a replay, shared by its driver with the ReplaySockets the game 
+	*  creates and destroys on its own */
+	struct ReplayClock
+	{
+		/* Microseconds, never goes back */
+		uint64_t time        = 0;
+
+		/* Sockets opened on the capture, and those of them done replaying */
+		int32_t  numOpened   = 0;
+		int32_t  numFinished = 0;
+	};
+
+	/* ReplaySocket
+	*  Receives the datagrams a capture recorded as received on the port this
+	*  socket is opened on, once the replay clock passes their time relative
+	*  to the first of them. A socket opened on port 0 takes the port of the
+	*  first datagram received, as clients are bound by the system. Sent
+	*  datagrams are counted and dropped. Only the driver moves the clock,
+	*  so a replay driven by a fixed step receives the same datagrams in
+	*  the same frames every run.
+	*/
+	class ReplaySocket : public Socket
+	{
+	public:
+		ReplaySocket(const std::string& path, ReplayClock* clock);
+		~ReplaySocket();
+
+		bool initialize(uint16_t port) override;
+		bool isInitialized()     const override;
+
+		bool receive(Address& address, char* buffer, int32_t& length) override;
+		bool send(const Address& address, const void* buffer, const size_t length) override;
+
+		/** Received datagrams follow the clock of the thread replaying them */
+		bool canReceiveOnThread() const override { return false; }
+
+		/** Cookies in the capture were handed out by a secret of the recording */
+		bool isReplaying() const override { return true; }
+
+		uint32_t getPort()            const override;
+		uint64_t getBytesReceived()   const override;
+		uint64_t getBytesSent()       const override;
+		uint64_t getPacketsReceived() const override;
+		uint64_t getPacketsSent()     const override;
+
+	private:
+		/* Reads ahead to the next datagram received on m_port */
+		void readNext();
+
+		std::string   m_path;
+		ReplayClock*  m_clock;
+		CaptureReader m_reader;
+		CaptureRecord m_next;
+		bool          m_hasNext;
+		bool          m_isInitialized;
+		uint16_t      m_port;
+
+		/* Replay time it was opened at and capture time of the first datagram */
+		uint64_t      m_startTime;
+		uint64_t      m_firstTimestamp;
+
+		uint64_t      m_bytesReceived;
+		uint64_t      m_bytesSent;
+		uint64_t      m_packetsReceived;
+		uint64_t      m_packetsSent;
+	};
+
+}; // namespace network
@@ -0,0 +1,345 @@
+#include "room_socket.h"
+
+#include <core/debug.h>
+#include <network/common_network.h>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+using namespace network;
+
+static const int32_t  s_receiveBatchSize   = 64;
+static const uint32_t s_roomQueueSize      = 256;
+
+/* Longer than a Connection takes to time out, so a route outlives its connection */
+static const float    s_routeTimeout       = 30.0f;
+static const float    s_routeExpiryInterval = 1.0f;
+
+SharedSocket::SharedSocket() :
+	m_socket(Socket::create()),
+	m_datagrams(new Datagram[s_receiveBatchSize]),
+	m_lastExpiryTime(0.0f)
+{
+}
+
+SharedSocket::~SharedSocket()
+{
+	ASSERT(m_rooms.empty(), "SharedSocket destroyed while rooms still use it");
+	delete m_socket;
+	delete[] m_datagrams;
+}
+
+bool SharedSocket::initialize(uint16_t port)
+{
+	if (!m_socket->initialize(port))
+	{
+		LOG_WARNING("SharedSocket: Failed to listen on port %d", port);
+		return false;
+	}
+
+	LOG_INFO("SharedSocket: Listening on port %d", port);
+	return true;
+}
+
+uint16_t SharedSocket::getPort() const
+{
+	return static_cast<uint16_t>(m_socket->getPort());
+}
+
+void SharedSocket::update(int32_t timeoutMilliseconds)
+{
+	m_time.update();
+	if (m_time.getSeconds() - m_lastExpiryTime >= s_routeExpiryInterval)
+	{
+		removeExpiredRoutes();
+		m_lastExpiryTime = m_time.getSeconds();
+	}
+
+	if (!m_socket->waitForData(timeoutMilliseconds))
+	{
+		return;
+	}
+
+	const int32_t numDatagrams = m_socket->receiveBatch(m_datagrams, s_receiveBatchSize);
+	if (numDatagrams == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_roomMutex);
+	for (int32_t i = 0; i < numDatagrams; i++)
+	{
+		const Datagram& datagram = m_datagrams[i];
+		RoomSocket* room = findRoom(datagram.address);
+		if (room == nullptr)
+		{
+			continue;
+		}
+
+		if (!room->m_datagrams.push(datagram))
+		{
+			LOG_WARNING("SharedSocket: queue of room %d is full, datagram dropped", room->getRoomId());
+		}
+	}
+}
+
+bool SharedSocket::send(const Address& address, const void* buffer, const size_t length)
+{
+	std::lock_guard<std::mutex> lock(m_sendMutex);
+	return m_socket->send(address, buffer, length);
+}
+
+bool SharedSocket::sendBatch(const Datagram* datagrams, int32_t numDatagrams)
+{
+	std::lock_guard<std::mutex> lock(m_sendMutex);
+	return m_socket->sendBatch(datagrams, numDatagrams);
+}
+
+void SharedSocket::flush()
+{
+	std::lock_guard<std::mutex> lock(m_sendMutex);
+	m_socket->flush();
+}
+
+void SharedSocket::addRoom(RoomSocket* room)
+{
+	ASSERT(room != nullptr);
+	std::lock_guard<std::mutex> lock(m_roomMutex);
+	ASSERT(std::find(m_rooms.begin(), m_rooms.end(), room) == m_rooms.end());
+	m_rooms.push_back(room);
+}
+
+void SharedSocket::removeRoom(RoomSocket* room)
+{
+	std::lock_guard<std::mutex> lock(m_roomMutex);
+	auto it = std::find(m_rooms.begin(), m_rooms.end(), room);
+	if (it == m_rooms.end())
+	{
+		return;
+	}
+	m_rooms.erase(it);
+
+	for (auto route = m_routes.begin(); route != m_routes.end();)
+	{
+		route = (route->second.room == room) ? m_routes.erase(route) : std::next(route);
+	}
+}
+
+void SharedSocket::addRoute(RoomSocket* room, const Address& address)
+{
+	ASSERT(room != nullptr);
+	std::lock_guard<std::mutex> lock(m_roomMutex);
+
+	Route& route = m_routes[getRouteKey(address)];
+	if (route.room != room)
+	{
+		if (route.room != nullptr)
+		{
+			route.room->m_numRoutes--;
+		}
+		room->m_numRoutes++;
+	}
+	route = { room, m_time.getSeconds() };
+}
+
+void SharedSocket::removeRoute(RoomSocket* room, const Address& address)
+{
+	std::lock_guard<std::mutex> lock(m_roomMutex);
+
+	// The route may have expired, or been taken by another room since
+	auto it = m_routes.find(getRouteKey(address));
+	if (it != m_routes.end() && it->second.room == room)
+	{
+		room->m_numRoutes--;
+		m_routes.erase(it);
+	}
+}
+
+RoomSocket* SharedSocket::findRoom(const Address& address)
+{
+	const uint64_t key = getRouteKey(address);
+	auto it = m_routes.find(key);
+	if (it != m_routes.end())
+	{
+		it->second.lastReceiveTime = m_time.getSeconds();
+		return it->second.room;
+	}
+
+	// Nothing is stored for addresses the rooms did not accept, so spoofed datagrams
+	// cannot fill them. An address keeps its room while the rooms do not change.
+	const size_t numRooms = m_rooms.size();
+	const size_t firstRoom = numRooms > 0 ? getRouteHash(key) % numRooms : 0;
+	for (size_t i = 0; i < numRooms; i++)
+	{
+		RoomSocket* room = m_rooms[(firstRoom + i) % numRooms];
+		if (room->m_numRoutes < static_cast<int32_t>(s_maxConnectedClients))
+		{
+			return room;
+		}
+	}
+
+	LOG_DEBUG("SharedSocket: no room for %s, datagram dropped", address.toString().c_str());
+	return nullptr;
+}
+
+void SharedSocket::removeExpiredRoutes()
+{
+	std::lock_guard<std::mutex> lock(m_roomMutex);
+	for (auto route = m_routes.begin(); route != m_routes.end();)
+	{
+		if (m_time.getSeconds() - route->second.lastReceiveTime > s_routeTimeout)
+		{
+			route->second.room->m_numRoutes--;
+			route = m_routes.erase(route);
+		}
+		else
+		{
+			++route;
+		}
+	}
+}
+
+uint64_t SharedSocket::getRouteKey(const Address& address)
+{
+	return (static_cast<uint64_t>(address.getAddress()) << 16) | address.getPort();
+}
+
+uint32_t SharedSocket::getRouteHash(uint64_t key)
+{
+	// Finalizer of MurmurHash3, as in AddressTable
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return static_cast<uint32_t>(key);
+}
+
+// ============================================================================
+
+RoomSocket::RoomSocket(SharedSocket* sharedSocket, int32_t roomId) :
+	m_sharedSocket(sharedSocket),
+	m_roomId(roomId),
+	m_isInitialized(false),
+	m_datagrams(s_roomQueueSize),
+	m_numRoutes(0),
+	m_bytesReceived(0),
+	m_bytesSent(0),
+	m_packetsReceived(0),
+	m_packetsSent(0)
+{
+	ASSERT(sharedSocket != nullptr);
+}
+
+RoomSocket::~RoomSocket()
+{
+	if (m_isInitialized)
+	{
+		m_sharedSocket->removeRoom(this);
+	}
+}
+
+bool RoomSocket::initialize(uint16_t port)
+{
+	ASSERT(!m_isInitialized);
+	if (port != m_sharedSocket->getPort())
+	{
+		LOG_ERROR("RoomSocket: rooms listen on port %d, not %d", m_sharedSocket->getPort(), port);
+		return false;
+	}
+
+	m_sharedSocket->addRoom(this);
+	m_isInitialized = true;
+	return true;
+}
+
+bool RoomSocket::isInitialized() const
+{
+	return m_isInitialized;
+}
+
+bool RoomSocket::receive(Address& address, char* buffer, int32_t& length)
+{
+	Datagram datagram;
+	if (!m_datagrams.pop(datagram))
+	{
+		return false;
+	}
+
+	address = datagram.address;
+	length  = datagram.length;
+	memcpy(buffer, datagram.data, datagram.length);
+
+	m_bytesReceived += datagram.length;
+	m_packetsReceived++;
+	return true;
+}
+
+bool RoomSocket::send(const Address& address, const void* buffer, const size_t length)
+{
+	m_bytesSent += length;
+	m_packetsSent++;
+	return m_sharedSocket->send(address, buffer, length);
+}
+
+bool RoomSocket::sendBatch(const Datagram* datagrams, int32_t numDatagrams)
+{
+	for (int32_t i = 0; i < numDatagrams; i++)
+	{
+		m_bytesSent += datagrams[i].length;
+	}
+	m_packetsSent += numDatagrams;
+	return m_sharedSocket->sendBatch(datagrams, numDatagrams);
+}
+
+void RoomSocket::flush()
+{
+	m_sharedSocket->flush();
+}
+
+void RoomSocket::onConnectionAdded(const Address& address)
+{
+	m_sharedSocket->addRoute(this, address);
+}
+
+void RoomSocket::onConnectionRemoved(const Address& address)
+{
+	m_sharedSocket->removeRoute(this, address);
+}
+
+bool RoomSocket::waitForData(int32_t timeoutMilliseconds)
+{
+	// SharedSocket is the one blocking on the socket, poll its queue
+	for (int32_t i = 0; i < timeoutMilliseconds && m_datagrams.getCount() == 0; i++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	return m_datagrams.getCount() > 0;
+}
+
+uint32_t RoomSocket::getPort() const
+{
+	return m_sharedSocket->getPort();
+}
+
+uint64_t RoomSocket::getBytesReceived() const
+{
+	return m_bytesReceived;
+}
+
+uint64_t RoomSocket::getBytesSent() const
+{
+	return m_bytesSent;
+}
+
+uint64_t RoomSocket::getPacketsReceived() const
+{
+	return m_packetsReceived;
+}
+
+uint64_t RoomSocket::getPacketsSent() const
+{
+	return m_packetsSent;
+}
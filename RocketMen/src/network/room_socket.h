@@ -0,0 +1,124 @@
+#pragma once
+
+#include <core/game_time.h>
+#include <network/socket.h>
+#include <utility/spsc_queue.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace network
+{
+	class RoomSocket;
+
+	/* SharedSocket
+	*  One UDP socket for all rooms of the process. Datagrams are routed to a
+	*  room by their source address. Addresses without a route go to a room
+	*  picked by a hash of the address, without keeping any state for them,
+	*  and get a route once that room accepts their connection. Routes end
+	*  when the room removes the connection, or once the address has been
+	*  silent for longer than a connection times out.
+	*/
+	class SharedSocket
+	{
+	public:
+		SharedSocket();
+		~SharedSocket();
+
+		bool     initialize(uint16_t port);
+		uint16_t getPort() const;
+
+		/** Receives for up to timeoutMilliseconds and routes the datagrams */
+		void update(int32_t timeoutMilliseconds);
+
+		/** Sending is serialized, rooms send from their own threads */
+		bool send(const Address& address, const void* buffer, const size_t length);
+		bool sendBatch(const Datagram* datagrams, int32_t numDatagrams);
+		void flush();
+
+		void addRoom(RoomSocket* room);
+		void removeRoom(RoomSocket* room);
+
+		void addRoute(RoomSocket* room, const Address& address);
+		void removeRoute(RoomSocket* room, const Address& address);
+
+	private:
+		struct Route
+		{
+			RoomSocket* room;
+			float       lastReceiveTime;
+		};
+
+		RoomSocket* findRoom(const Address& address);
+		void removeExpiredRoutes();
+
+		static uint64_t getRouteKey(const Address& address);
+		static uint32_t getRouteHash(uint64_t key);
+
+		Socket*    m_socket;
+		std::mutex m_sendMutex;
+
+		/* Rooms and routes, rooms join and leave from their own threads */
+		std::mutex                 m_roomMutex;
+		std::vector<RoomSocket*>   m_rooms;
+		std::map<uint64_t, Route>  m_routes;
+
+		Datagram* m_datagrams;
+		Time      m_time;
+		float     m_lastExpiryTime;
+	};
+
+	/* RoomSocket
+	*  Socket of one room's Server, receives what SharedSocket routed to the
+	*  room and sends through the shared socket.
+	*/
+	class RoomSocket : public Socket
+	{
+	public:
+		RoomSocket(SharedSocket* sharedSocket, int32_t roomId);
+		~RoomSocket();
+
+		int32_t getRoomId() const { return m_roomId; }
+
+		bool initialize(uint16_t port) override;
+		bool isInitialized()     const override;
+
+		bool receive(Address& address, char* buffer, int32_t& length) override;
+		bool send(const Address& address, const void* buffer, const size_t length) override;
+		bool sendBatch(const Datagram* datagrams, int32_t numDatagrams) override;
+		bool waitForData(int32_t timeoutMilliseconds) override;
+		void flush() override;
+
+		/** Routes the datagrams of address to this room, until it is removed */
+		void onConnectionAdded(const Address& address) override;
+		void onConnectionRemoved(const Address& address) override;
+
+		uint32_t getPort()            const override;
+		uint64_t getBytesReceived()   const override;
+		uint64_t getBytesSent()       const override;
+		uint64_t getPacketsReceived() const override;
+		uint64_t getPacketsSent()     const override;
+
+	private:
+		SharedSocket* m_sharedSocket;
+		int32_t       m_roomId;
+		bool          m_isInitialized;
+
+		/* Filled by the thread updating SharedSocket */
+		SpscQueue<Datagram> m_datagrams;
+
+		/* Accepted addresses routed to this room, used by SharedSocket only */
+		int32_t m_numRoutes;
+
+		std::atomic<uint64_t> m_bytesReceived;
+		std::atomic<uint64_t> m_bytesSent;
+		std::atomic<uint64_t> m_packetsReceived;
+		std::atomic<uint64_t> m_packetsSent;
+
+	public:
+		friend class SharedSocket;
+	};
+
+}; // namespace network
@@ -6,21 +6,60 @@
 #include <core/game.h>
 #include <core/debug.h>
 #include <core/action_buffer.h>
+#include <core/room.h>
 #include <network/common_network.h>
 #include <network/connection.h>
 #include <network/packet_receiver.h>
 #include <network/remote_client.h>
+#include <network/snapshot_payload.h>
 #include <network/client/message_factory_client.h>
+#include <network/loopback_socket.h>
+#include <network/network_metrics.h>
+#include <network/packet_coder.h>
 #include <network/socket.h>
 
 #include <utility/utility.h>
 
-extern "C" unsigned long crcFast(unsigned char const message[], int nBytes);
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+extern "C" uint32_t crcFast(unsigned char const message[], int nBytes);
 
 using namespace network;
 
+/* Estimated cost of the snapshot header and of the id and flags written per entity */
+static const int32_t s_snapshotOverheadBits = 128;
+static const int32_t s_entityOverheadBits   = 32;
+
+/* Snapshots between measurements of the bits quantization saves */
+static const Sequence s_quantizationReportInterval = 20;
+
+/* Input frames a client may queue before the extra ones are executed in one tick */
+static const int32_t s_maxBufferedInputFrames = 4;
+
+/* Distance at which an entity's priority has halved */
+static const float   s_priorityDistance     = 8.0f;
+
+static float getPriorityWeight(EntityType type)
+{
+	switch (type)
+	{
+		case EntityType::Rocket:     return 4.0f;
+		case EntityType::Character:  return 2.0f;
+		case EntityType::MovingCube: return 0.5f;
+		default:                     return 1.0f;
+	}
+}
+
 Server::Server(Game* game) :
 	m_game(game),
+	m_worldStates(s_snapshotHistorySize),
+	m_snapshotSequence(0),
+	m_interestRadius(s_defaultInterestRadius),
+	m_snapshotBudget(s_maxSnapshotSize),
+	m_lagCompensation(s_lagCompensationFrames),
 	m_packetReceiver(new PacketReceiver(128)),
 	m_networkIdManager(s_maxNetworkedEntities),
 	m_clients(s_maxConnectedClients)
@@ -31,6 +70,7 @@ Server::Server(Game* game) :
 
 Server::~Server()
 {
+	m_packetReceiver->stopThread();
 	delete m_socket;
 	delete m_packetReceiver;
 }
@@ -39,26 +79,47 @@ void Server::reset()
 {
 	m_isInitialized    = false;
 	m_playerIdCounter  = 0;
+	m_lastFrameSimulated = 0;
 	m_snapshotTime     = 0.0f;
 	m_networkIdManager.clear();
 	m_clients.clear();
+	m_lagCompensation.clear();
+	m_quantizationReport = QuantizationReport();
+	m_cookies.reset();
 
 	EntityManager::killEntities();
 	
+	m_packetReceiver->stopThread();
 	delete m_socket;
-	m_socket = Socket::create();
-	ASSERT(m_socket != nullptr);
+
+	// Rooms sharing a socket or replaying a capture provide the socket
+	if (Socket* roomSocket = Room::getCurrent()->createSocket())
+	{
+		m_socket = roomSocket;
+		return;
+	}
+
+	LoopbackSocket* socket = new LoopbackSocket(Socket::create());
+	socket->setPassMessages(s_loopbackPassMessages);
+	m_socket = socket;
 }
 
 void Server::update(const Time& time)
 {
 	if (m_socket->isInitialized())
 	{
-		receivePackets();
+		const auto updateStart = std::chrono::steady_clock::now();
+
+		m_cookies.update(time.getDeltaSeconds());
+		receivePackets(time);
 		readMessages(time);
 		createSnapshots(time.getDeltaSeconds());
 		m_clients.sendPendingMessages(time);
+		m_socket->flush();
 		m_clients.updateConnections(time);
+
+		const std::chrono::duration<double> updateTime = std::chrono::steady_clock::now() - updateStart;
+		NetworkMetrics::get().serverUpdateTime.observe(updateTime.count());
 	}
 }
 
@@ -66,6 +127,27 @@ void Server::fixedUpdate()
 {
 }
 
+void Server::tick(Sequence frameCounter)
+{
+	// Poses the previous frame ended with, the state snapshots label with that frame
+	m_lagCompensation.record(m_lastFrameSimulated);
+	m_lastFrameSimulated = frameCounter;
+
+	// The state a snapshot holds follows exactly the input frames executed before it
+	for (RemoteClient& client : m_clients)
+	{
+		if (client.isUsed())
+		{
+			executeInput(client);
+		}
+	}
+}
+
+float Server::getLagCompensation() const
+{
+	return m_lagCompensation.getRewindFrames() * m_game->getTimestep() / 1000000.0f;
+}
+
 bool Server::host(uint16_t port, GameSessionType type)
 {
 	ASSERT(m_socket != nullptr);
@@ -75,6 +157,12 @@ bool Server::host(uint16_t port, GameSessionType type)
 	if (m_socket->initialize(port))
 	{
 		LOG_INFO("Server: Listening on port %d", port);
+
+		// Without a player in this process no local peer writes to the socket from the game thread
+		if (type == GameSessionType::Online && s_dedicatedReceiveThread)
+		{
+			m_packetReceiver->startThread(m_socket, &m_clientMessageFactory);
+		}
 		return true;
 	}
 	else
@@ -110,6 +198,35 @@ int32_t network::Server::getNumClients() const
 	return m_clients.count();
 }
 
+bool Server::setMaxClients(int32_t maxClients)
+{
+	ASSERT(maxClients > 0);
+	if (!m_clients.setMaxClients(maxClients))
+	{
+		return false;
+	}
+
+	LOG_INFO("Server: Accepting up to %d clients", maxClients);
+	return true;
+}
+
+void Server::setInterestArea(uint32_t width, uint32_t height)
+{
+	m_interestGrid.initialize(width, height, s_interestCellSize);
+}
+
+void Server::setInterestRadius(float radius)
+{
+	ASSERT(radius > 0.0f);
+	m_interestRadius = radius;
+}
+
+void Server::setSnapshotBudget(uint32_t bytesPerSnapshot)
+{
+	ASSERT(bytesPerSnapshot > 0);
+	m_snapshotBudget = bytesPerSnapshot;
+}
+
 void Server::onClientDisconnect(RemoteClient& client)
 {
 	for (auto playerId : client.getPlayerIds())
@@ -154,6 +271,7 @@ void Server::onIntroducePlayer(const message::IntroducePlayer& inMessage, Remote
 void Server::onPlayerInput(const message::PlayerInput& inMessage, RemoteClient& client)
 {
 	ActionBuffer playerActions;
+	ActionBuffer previousActions[s_maxPlayersPerClient];
 
 	const int32_t numPlayers = client.getNumPlayers();
 	if (numPlayers != inMessage.numPlayers || inMessage.dataLength == 0)
@@ -161,17 +279,66 @@ void Server::onPlayerInput(const message::PlayerInput& inMessage, RemoteClient&
 		return;
 	}
 
+	const ActionDictionary& dictionary = client.getActionDictionary();
+
 	ReadStream stream(inMessage.data, inMessage.dataLength);
 
+	// Frames are queued and executed one per tick, see executeInput
 	for (int32_t i = 0; i < inMessage.numFrames; i++)
 	{
 		const Sequence frameId = static_cast<Sequence>(inMessage.startFrame + i);
+		InputFrame* input = client.insertInput(frameId);
 		for (int32_t j = 0; j < numPlayers; j++)
 		{
-			playerActions.serialize(stream);
-			m_game->processPlayerActions(playerActions, client.getPlayerIds()[j]);
-			playerActions.clear();
+			// Each frame is coded against the player's previous frame in this message
+			if (!playerActions.serialize(stream, dictionary, (i > 0) ? &previousActions[j] : nullptr))
+			{
+				LOG_WARNING("Server: client %d sent input for an unregistered action", client.getId());
+				return;
+			}
+
+			if (input != nullptr)
+			{
+				input->actions[j].insert(playerActions);
+			}
+			previousActions[j].clear();
+			previousActions[j].insert(playerActions);
+		}
+
+		if (input != nullptr)
+		{
+			input->hasViewFrame = inMessage.hasViewFrame;
+			input->viewFrame    = inMessage.viewFrame;
+			input->viewFraction = inMessage.viewFraction;
+		}
+	}
+}
+
+void Server::executeInput(RemoteClient& client)
+{
+	// Input piling up past the buffer is executed at once, rather than delaying all later input
+	int32_t numQueued = client.getNumQueuedInputs();
+	for (int32_t i = 0; numQueued > 0 && (i == 0 || numQueued > s_maxBufferedInputFrames); i++, numQueued--)
+	{
+		if (InputFrame* input = client.getNextInput())
+		{
+			// Actions hit what the player saw, the player's own entities act from where they are now
+			const bool isRewound = input->hasViewFrame && m_lagCompensation.rewind(input->viewFrame, input->viewFraction,
+				[&client](Entity* entity) -> bool {
+					return client.ownsPlayer(entity->getOwnerPlayerId());
+				});
+
+			for (uint32_t j = 0; j < client.getNumPlayers(); j++)
+			{
+				m_game->processPlayerActions(input->actions[j], client.getPlayerIds()[j]);
+			}
+
+			if (isRewound)
+			{
+				m_lagCompensation.restore();
+			}
 		}
+		client.popInput();
 	}
 }
 
@@ -179,7 +346,8 @@ void Server::onRequestTime(const message::RequestTime& inMessage, RemoteClient&
 {	
 	message::ServerTime* outMessage = dynamic_cast<message::ServerTime*>(m_messageFactory.createMessage(MessageType::ServerTime));
 	outMessage->clientTimestamp = inMessage.clientTimestamp;
-	outMessage->serverTimestamp = time.getMilliSeconds();
+	outMessage->serverTimestamp = time.getMicroSeconds();
+	outMessage->serverFrame     = m_lastFrameSimulated;
 
 	client.getConnection()->sendMessage(outMessage);
 }
@@ -189,8 +357,7 @@ void Server::onRequestEntity(const message::RequestEntity& inMessage, RemoteClie
 {
 	const int32_t requestId = inMessage.entityNetworkId;
 
-	Entity* entity = findPtrByPredicate(EntityManager::getEntities().begin(), EntityManager::getEntities().end(),
-		[requestId](Entity* entity) -> bool { return entity->getNetworkId() == requestId; });
+	Entity* entity = EntityManager::findNetworkedEntity(requestId);
 
 	if (entity != nullptr)
 	{
@@ -207,6 +374,29 @@ void Server::onKeepAlive(RemoteClient& client)
 	client.sendMessage(m_messageFactory.createMessage(MessageType::KeepAlive));
 }
 
+void Server::onRegisterActions(const message::RegisterActions& inMessage, RemoteClient& client)
+{
+	// Reliable ordered, the dictionary only grows so the latest one holds every earlier index
+	client.getActionDictionary() = inMessage.dictionary;
+}
+
+void Server::onAckSnapshot(const message::AckSnapshot& inMessage, RemoteClient& client)
+{
+	Sequence ackedSequence;
+	if (client.getAckedSnapshot(ackedSequence) && !sequenceGreaterThan(inMessage.sequence, ackedSequence))
+	{
+		return;
+	}
+
+	// Never trust an ack for a snapshot that was not sent yet
+	if (!sequenceLessThan(inMessage.sequence, m_snapshotSequence))
+	{
+		return;
+	}
+
+	client.setAckedSnapshot(inMessage.sequence);
+}
+
 void Server::sendEntitySpawn(Entity* entity, RemoteClient& client)
 {
 	ASSERT(entity != nullptr);
@@ -267,6 +457,16 @@ void Server::readMessage(const Message& message, RemoteClient& client, const Tim
 			onKeepAlive(client);
 			break;
 		}
+		case MessageType::AckSnapshot:
+		{
+			onAckSnapshot(static_cast<const message::AckSnapshot&>(message), client);
+			break;
+		}
+		case MessageType::RegisterActions:
+		{
+			onRegisterActions(static_cast<const message::RegisterActions&>(message), client);
+			break;
+		}
 		case MessageType::Snapshot:
 		case MessageType::RequestConnection:
 		case MessageType::None:
@@ -276,6 +476,7 @@ void Server::readMessage(const Message& message, RemoteClient& client, const Tim
 		case MessageType::DestroyEntity:
 		case MessageType::GameEvent:
 		case MessageType::ServerTime:
+		case MessageType::ConnectionChallenge:
 		case MessageType::NUM_MESSAGE_TYPES:
 		{
 			break;
@@ -291,17 +492,257 @@ void Server::createSnapshots(float deltaTime)
 	{
 		m_snapshotTime -= s_snapshotCreationRate;
 		const int32_t localClientId = m_clients.getLocalClientId();
+		WorldState* state = nullptr;
+
+		// Clients sent the same state on the same baseline with the same relevant entities share one encoded payload
+		struct PayloadEntry
+		{
+			const WorldState*    source;
+			const WorldState*    baseline;
+			const RelevanceMask* relevance;
+			const RelevanceMask* baselineRelevance;
+			SnapshotPayload*     payload;
+		};
+		std::vector<PayloadEntry> payloads;
+		std::vector<Vector2> focus;
+
+		auto isSameMask = [](const RelevanceMask* a, const RelevanceMask* b) -> bool {
+			return (a == nullptr || b == nullptr) ? (a == b) : (*a == *b);
+		};
+
 		for (auto& client : m_clients)
 		{
-			if (client.isUsed() && client.getId() != localClientId)
+			if (!client.isUsed() || client.getId() == localClientId)
+			{
+				continue;
+			}
+
+			// Encode the world once, on demand, for every client this tick
+			if (state == nullptr)
+			{
+				state = m_worldStates.insert(m_snapshotSequence);
+				ASSERT(state != nullptr);
+				if (!state->encode(m_snapshotSequence, m_lastFrameSimulated))
+				{
+					m_worldStates.remove(m_snapshotSequence);
+					return;
+				}
+
+				if (m_interestGrid.isInitialized())
+				{
+					m_interestGrid.update();
+				}
+
+				if (m_snapshotSequence % s_quantizationReportInterval == 0)
+				{
+					m_quantizationReport = Quantization::measure();
+				}
+			}
+
+			focus.clear();
+			gatherFocus(client, focus);
+
+			RelevanceMask* relevance = nullptr;
+			if (m_interestGrid.isInitialized())
+			{
+				relevance = client.insertRelevance(m_snapshotSequence);
+				ASSERT(relevance != nullptr);
+				gatherRelevance(client, focus, *relevance);
+			}
+
+			// The client's own copy of a state is used when entities were deferred in it
+			const WorldState*    baseline = nullptr;
+			const RelevanceMask* baselineRelevance = nullptr;
+			Sequence ackedSequence;
+			if (client.getAckedSnapshot(ackedSequence)
+				&& sequenceDifference(m_snapshotSequence, ackedSequence) < s_snapshotHistorySize)
+			{
+				baseline = client.getSentState(ackedSequence);
+				if (baseline == nullptr)
+				{
+					baseline = m_worldStates.getEntry(ackedSequence);
+				}
+
+				baselineRelevance = client.getRelevance(ackedSequence);
+				if (relevance != nullptr && baselineRelevance == nullptr)
+				{
+					baseline = nullptr;
+				}
+			}
+
+			RelevanceMask deferred;
+			prioritizeEntities(client, focus, *state, baseline, relevance, deferred);
+
+			const WorldState* source = state;
+			if (deferred.any())
+			{
+				WorldState* sentState = client.insertSentState(m_snapshotSequence);
+				if (sentState == nullptr || !sentState->assemble(*state, baseline, deferred))
+				{
+					client.removeSentState(m_snapshotSequence);
+					continue;
+				}
+				source = sentState;
+			}
+			else
+			{
+				client.removeSentState(m_snapshotSequence);
+			}
+
+			auto it = std::find_if(payloads.begin(), payloads.end(), [&](const PayloadEntry& entry) -> bool {
+				return entry.source == source && entry.baseline == baseline 
+					&& isSameMask(entry.relevance, relevance)
+					&& isSameMask(entry.baselineRelevance, baselineRelevance);
+			});
+
+			SnapshotPayload* payload = nullptr;
+			if (it != payloads.end())
+			{
+				payload = it->payload;
+			}
+			else
+			{
+				payload = SnapshotPayload::create(*source, baseline, relevance, baselineRelevance);
+				if (payload == nullptr)
+				{
+					continue;
+				}
+				NetworkMetrics::get().snapshotSize.observe((payload->getNumBits() + 7) / 8);
+				payloads.push_back({ source, baseline, relevance, baselineRelevance, payload });
+			}
+
+			message::Snapshot* snapshot = static_cast<message::Snapshot*>(m_messageFactory.createMessage(MessageType::Snapshot));
+			snapshot->payload = payload->addRef();
+			snapshot->hasInputFrame = client.getLastInputFrame(snapshot->inputFrame);
+			client.sendMessage(snapshot);
+			NetworkMetrics::get().snapshotsSent.add();
+		}
+
+		for (auto& entry : payloads)
+		{
+			entry.payload->releaseRef();
+		}
+
+		if (state != nullptr)
+		{
+			m_snapshotSequence++;
+		}
+	}
+}
+
+void Server::gatherFocus(const RemoteClient& client, std::vector<Vector2>& focus) const
+{
+	for (Entity* entity : EntityManager::getEntities())
+	{
+		if (entity->isReplicated() && entity->getType() == EntityType::Character
+			&& client.ownsPlayer(entity->getOwnerPlayerId()))
+		{
+			focus.push_back(entity->getTransform().getWorldPosition());
+		}
+	}
+}
+
+void Server::gatherRelevance(const RemoteClient& client, const std::vector<Vector2>& focus, RelevanceMask& mask) const
+{
+	// Without a Character to follow, e.g. while spectating, send everything
+	if (focus.empty())
+	{
+		mask.set();
+		return;
+	}
+
+	for (const Vector2& position : focus)
+	{
+		m_interestGrid.query(position, m_interestRadius, mask);
+	}
+
+	// Entities of the client's own players are always relevant
+	for (Entity* entity : EntityManager::getEntities())
+	{
+		if (entity->isReplicated() && client.ownsPlayer(entity->getOwnerPlayerId()))
+		{
+			mask.set(entity->getNetworkId());
+		}
+	}
+}
+
+/* Grows the priority of every changed entity by its type and its distance to
+*  the client's Characters, then fills the snapshot budget in priority order.
+*  Entities that do not fit are marked in deferred and keep their priority. */
+void Server::prioritizeEntities(RemoteClient& client, const std::vector<Vector2>& focus, const WorldState& state,
+	const WorldState* baseline, const RelevanceMask* relevance, RelevanceMask& deferred) const
+{
+	struct Candidate
+	{
+		int32_t networkId;
+		int32_t numBits;
+		float   priority;
+		bool    isOwned;
+	};
+
+	std::vector<Candidate> candidates;
+
+	int32_t numBitsLeft = static_cast<int32_t>(m_snapshotBudget) * 8 - s_snapshotOverheadBits;
+	for (int32_t networkId = 0; networkId < s_maxNetworkedEntities; networkId++)
+	{
+		if (!state.hasEntity(networkId) || (relevance != nullptr && !relevance->test(networkId)))
+		{
+			continue;
+		}
+
+		// Up to date entities cost a single bit
+		if (!state.isEntityChanged(networkId, baseline))
+		{
+			client.resetPriority(networkId);
+			numBitsLeft--;
+			continue;
+		}
+
+		float weight = 1.0f;
+		bool isOwned = false;
+		if (Entity* entity = EntityManager::findNetworkedEntity(networkId))
+		{
+			weight = getPriorityWeight(entity->getType());
+			isOwned = client.ownsPlayer(entity->getOwnerPlayerId());
+
+			if (!focus.empty())
 			{
-				client.sendMessage(m_messageFactory.createMessage(MessageType::Snapshot));
+				const Vector2 position = entity->getTransform().getWorldPosition();
+				float distance = std::numeric_limits<float>::max();
+				for (const Vector2& focusPosition : focus)
+				{
+					distance = std::min(distance, glm::distance(position, focusPosition));
+				}
+				weight *= s_priorityDistance / (s_priorityDistance + distance);
 			}
 		}
+
+		const float priority = client.addPriority(networkId, weight * s_snapshotCreationRate);
+		candidates.push_back({ networkId, state.getEntityBits(networkId) + s_entityOverheadBits, priority, isOwned });
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) -> bool {
+		return a.priority > b.priority;
+	});
+
+	// The most important entity is always sent so an oversized one cannot starve, and
+	// the client's own entities are too because it reconciles its prediction with them
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		const Candidate& candidate = candidates[i];
+		if (i == 0 || candidate.isOwned || candidate.numBits <= numBitsLeft)
+		{
+			numBitsLeft -= candidate.numBits;
+			client.resetPriority(candidate.networkId);
+		}
+		else
+		{
+			deferred.set(candidate.networkId);
+		}
 	}
 }
 
-void Server::receivePackets()
+void Server::receivePackets(const Time& time)
 {
 	ASSERT(m_game->getSessionType() != GameSessionType::Offline);
 
@@ -318,7 +759,7 @@ void Server::receivePackets()
 		if(RemoteClient* client = m_clients.getClient(packet->address))
 		{
 			newConnection = false;
-			client->getConnection()->receivePacket(*packet);
+			client->getConnection()->receivePacket(*packet, time);
 		}
 
 		if (newConnection && packet->header.numMessages > 0)
@@ -326,10 +767,7 @@ void Server::receivePackets()
 			Message* message = packet->messages[0];
 			if (message->getType() == MessageType::RequestConnection)
 			{
-				if (Connection* connection = addConnection(packet->address))
-				{
-					connection->receivePacket(*packet);
-				}
+				onRequestConnection(static_cast<const message::RequestConnection&>(*message), *packet, time);
 			}
 		}
 	}
@@ -348,7 +786,8 @@ void Server::readMessages(const Time& time)
 			while (Message* message = connection->getNextMessage())
 			{
 				readMessage(*message, client, time);
-				ASSERT(message->getRefCount() == 1, "Message has unexpected dangling references");
+				ASSERT(message->getRefCount() == 1 || m_socket->sharesMessagesWith(connection->getAddress()),
+					   "Message has unexpected dangling references");
 				message->releaseRef();
 			}
 		}
@@ -371,6 +810,7 @@ void Server::onConnectionCallback(ConnectionCallback type, Connection* connectio
 				m_game->onPlayerLeave(playerId);
 			}
 
+			m_socket->onConnectionRemoved(connection->getAddress());
 			m_clients.remove(client);
 			break;
 		}
@@ -383,11 +823,37 @@ void Server::onConnectionCallback(ConnectionCallback type, Connection* connectio
 	}
 }
 
-Connection* Server::addConnection(const Address& address)
+void Server::onRequestConnection(const message::RequestConnection& inMessage, Packet& packet, const Time& time)
+{
+	// A replay accepts the requests the recorded server accepted, it cannot know their secret
+	if (!inMessage.hasCookie || (!m_socket->isReplaying() && !m_cookies.verify(packet.address, inMessage.cookie)))
+	{
+		sendChallenge(packet.address, time);
+		return;
+	}
+
+	if (Connection* connection = addConnection(packet.address, inMessage.supportsPacketCoding))
+	{
+		connection->receivePacket(packet, time);
+	}
+}
+
+void Server::sendChallenge(const Address& address, const Time& time)
+{
+	message::ConnectionChallenge* message = 
+		static_cast<message::ConnectionChallenge*>(m_messageFactory.createMessage(MessageType::ConnectionChallenge));
+	message->cookie = m_cookies.generate(address);
+
+	NetworkMetrics::get().challengesSent.add();
+	m_handshakeChannel.sendMessage(message);
+	m_handshakeChannel.sendPendingMessages(m_socket, address, time, &m_messageFactory);
+}
+
+Connection* Server::addConnection(const Address& address, bool supportsPacketCoding)
 {
 	using namespace std::placeholders;
 
-	if (m_clients.count() < s_maxConnectedClients)
+	if (m_clients.count() < m_clients.getMaxClients())
 	{
 		Connection* connection = new Connection(m_socket, address, 
 			std::bind(&Server::onConnectionCallback, this, _1, _2),
@@ -401,10 +867,14 @@ Connection* Server::addConnection(const Address& address)
 			ASSERT(message != nullptr);
 
 			message->clientId = client->getId();
-			ASSERT(message->clientId >= 0 && message->clientId < s_maxConnectedClients, "ClientId out of range");
+			message->usePacketCoding = supportsPacketCoding && PacketCoder::isEnabled();
+			ASSERT(message->clientId >= 0, "ClientId out of range");
 			LOG_INFO("Server::addConnection: New ClientId: %d", message->clientId);
+			NetworkMetrics::get().connectionsAccepted.add();
 
+			connection->setPacketCoding(message->usePacketCoding);
 			client->sendMessage(message);
+			m_socket->onConnectionAdded(address);
 
 			connection->setState(Connection::State::Connected);
 			return connection;
@@ -418,6 +888,7 @@ Connection* Server::addConnection(const Address& address)
 	else
 	{
 		LOG_WARNING("connection attempt dropped, client limit reached");
+		NetworkMetrics::get().connectionsRejected.add();
 	}
 
 	return nullptr;
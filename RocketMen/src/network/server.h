@@ -2,23 +2,29 @@
 #pragma once
 
 #include <core/game_time.h>
+#include <network/common_network.h>
 #include <network/connection_callback.h>
+#include <network/connection_cookies.h>
+#include <network/interest_grid.h>
+#include <network/lag_compensation.h>
+#include <network/quantization.h>
 #include <network/remote_client_manager.h>
 #include <network/server/message_factory_server.h>
 #include <network/client/message_factory_client.h>
+#include <network/sequence_buffer.h>
 #include <network/session.h>
+#include <network/unreliable_channel.h>
+#include <network/world_state.h>
 #include <utility/id_manager.h>
 
 #include <array>
+#include <vector>
 
 class Game;
 class Entity;
 
 namespace network
 {
-	static const uint32_t s_maxConnectedClients = 32;
-	//=========================================================================
-
 	struct Packet;
 	class  PacketReceiver;
 	class  Socket;
@@ -32,6 +38,7 @@ namespace network
 
 		void update(const Time& time);
 		void fixedUpdate();
+		void tick(Sequence frameCounter);
 
 		bool host(uint16_t port, GameSessionType type);
 
@@ -39,37 +46,97 @@ namespace network
 		void registerLocalClientId(int32_t clientId);
 		void destroyEntity(int32_t networkId);
 
-		int32_t getNumClients() const;
+		int32_t  getNumClients() const;
+		Sequence getFrame()      const { return m_lastFrameSimulated; }
+
+		/** @return seconds the world is rewound by while executing a player's
+		*   input, 0 outside of that */
+		float getLagCompensation() const;
+
+		/** @return bits a recent snapshot's entities take with and without quantization */
+		const QuantizationReport& getQuantizationReport() const { return m_quantizationReport; }
+
+		/** Limits snapshots to entities near each client's Characters on a
+		*   map of width x height tiles */
+		void setInterestArea(uint32_t width, uint32_t height);
+		void setInterestRadius(float radius);
+
+		/** Clients connected at once at most, s_maxConnectedClients by default.
+		*   Only changes while no client is connected */
+		bool setMaxClients(int32_t maxClients);
+
+		/** Bytes of entity state each client is sent per snapshot at most,
+		*   the entities that do not fit are sent in a later snapshot */
+		void setSnapshotBudget(uint32_t bytesPerSnapshot);
 
 	private:
 		void onIntroducePlayer(const message::IntroducePlayer& inMessage, RemoteClient& client);
 		void onPlayerInput(const message::PlayerInput& inMessage, RemoteClient& client);
+
+		/** Executes the oldest input frame the client queued */
+		void executeInput(RemoteClient& client);
 		void onRequestTime(const message::RequestTime& inMessage, RemoteClient& client, const Time& time);
 		void onRequestEntity(const message::RequestEntity& inMessagem, RemoteClient& client);
 		void onClientDisconnect(RemoteClient& client);
 		void onKeepAlive(RemoteClient& client);
+		void onAckSnapshot(const message::AckSnapshot& inMessage, RemoteClient& client);
+		void onRegisterActions(const message::RegisterActions& inMessage, RemoteClient& client);
 
 		void sendEntitySpawn(Entity* entity, RemoteClient& client);
 		void sendEntitySpawn(Entity* entity);
 
 		void readMessage(const Message& message, RemoteClient& client, const Time& time);
 		void createSnapshots(float deltaTime);
+		void gatherFocus(const RemoteClient& client, std::vector<Vector2>& focus) const;
+		void gatherRelevance(const RemoteClient& client, const std::vector<Vector2>& focus, RelevanceMask& mask) const;
+		void prioritizeEntities(RemoteClient& client, const std::vector<Vector2>& focus, const WorldState& state,
+			const WorldState* baseline, const RelevanceMask* relevance, RelevanceMask& deferred) const;
 
-		void receivePackets();
+		void receivePackets(const Time& time);
 		void readMessages(const Time& time);
 		void onConnectionCallback(ConnectionCallback type, 
 			Connection* connection);
 
-		Connection* addConnection(const Address& address);
+		/** Allocates a client only for requests echoing a valid cookie,
+		*   any other request is answered with a challenge */
+		void onRequestConnection(const message::RequestConnection& inMessage, Packet& packet, const Time& time);
+		void sendChallenge(const Address& address, const Time& time);
+
+		/** Codes the packets to the client when it supports it and PacketCoder is enabled */
+		Connection* addConnection(const Address& address, bool supportsPacketCoding);
 
 		Socket* m_socket;
 		Game*   m_game;
 		bool    m_isInitialized;
 		int16_t m_playerIdCounter;
 
+		/* Frame clients synchronize their clocks to */
+		Sequence m_lastFrameSimulated;
+
 		/* Time since last snapshot */
 		float m_snapshotTime;
 
+		/* Recent world states, baselines for delta snapshots */
+		SequenceBuffer<WorldState> m_worldStates;
+		Sequence m_snapshotSequence;
+
+		/* Area of interest, disabled until an area is set */
+		InterestGrid m_interestGrid;
+		float        m_interestRadius;
+
+		/* Bytes per snapshot per client */
+		uint32_t m_snapshotBudget;
+
+		/* Recent entity poses, player input is executed against what the player saw */
+		LagCompensation m_lagCompensation;
+
+		/* Measured every s_quantizationReportInterval snapshots */
+		QuantizationReport m_quantizationReport;
+
+		/* Challenges are answered without allocating a client */
+		ConnectionCookies m_cookies;
+		UnreliableChannel m_handshakeChannel;
+
 		PacketReceiver* m_packetReceiver;
 		IdManager m_networkIdManager;
 		RemoteClientManager m_clients;
@@ -7,6 +7,7 @@
 
 #include <network/message/accept_connection.h>
 #include <network/message/accept_player.h>
+#include <network/message/connection_challenge.h>
 #include <network/message/destroy_entity.h>
 #include <network/message/disconnect.h>
 #include <network/message/keep_alive.h>
@@ -22,6 +23,9 @@ namespace network {
 		MessageFactoryServer() {};
 		~MessageFactoryServer() {};
 
+		// SpawnEntity instantiates its entity while it is read
+		virtual bool canReadOffThread() const override { return false; }
+
 		virtual Message* createMessage(MessageType type) override
 		{
 			switch (type)
@@ -54,6 +58,10 @@ namespace network {
 				{
 					return new message::ServerTime();
 				}
+				case MessageType::ConnectionChallenge:
+				{
+					return new message::ConnectionChallenge();
+				}
 				case MessageType::SpawnEntity:
 				{
 					return new message::SpawnEntity();
@@ -66,6 +74,8 @@ namespace network {
 				case MessageType::PlayerInput:
 				case MessageType::RequestEntity:
 				case MessageType::RequestTime:
+				case MessageType::AckSnapshot:
+				case MessageType::RegisterActions:
 				case MessageType::NUM_MESSAGE_TYPES:
 				{
 					ASSERT(false, "MessageFactoryServer::createMessage Message Type %d not allowed", (int32_t)type);
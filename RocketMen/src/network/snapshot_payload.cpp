@@ -0,0 +1,92 @@
+#include "snapshot_payload.h"
+
+#include <core/debug.h>
+#include <network/packet.h>
+#include <network/world_state.h>
+
+using namespace network;
+
+SnapshotPayload::SnapshotPayload() :
+	m_refCount(1),
+	m_stream(s_maxPayloadSize)
+{
+}
+
+SnapshotPayload::~SnapshotPayload()
+{
+	ASSERT(m_refCount == 0);
+}
+
+SnapshotPayload* SnapshotPayload::create(const WorldState& state, const WorldState* baseline,
+	const RelevanceMask* relevance, const RelevanceMask* baselineRelevance)
+{
+	SnapshotPayload* payload = new SnapshotPayload();
+	if (!payload->encode(state, baseline, relevance, baselineRelevance))
+	{
+		LOG_WARNING("SnapshotPayload: failed to encode world state %d", state.getSequence());
+		payload->releaseRef();
+		return nullptr;
+	}
+
+	return payload;
+}
+
+SnapshotPayload* SnapshotPayload::addRef()
+{
+	m_refCount.fetch_add(1, std::memory_order_relaxed);
+	return this;
+}
+
+void SnapshotPayload::releaseRef()
+{
+	const int32_t refCount = m_refCount.fetch_sub(1, std::memory_order_acq_rel);
+	ASSERT(refCount > 0);
+
+	if (refCount == 1)
+	{
+		delete this;
+	}
+}
+
+bool SnapshotPayload::serialize(WriteStream& stream) const
+{
+	return stream.serializeStream(m_stream);
+}
+
+bool SnapshotPayload::encode(const WorldState& state, const WorldState* baseline,
+	const RelevanceMask* relevance, const RelevanceMask* baselineRelevance)
+{
+	WriteStream body(s_maxPayloadSize);
+	if (!state.writeDelta(body, baseline, relevance, baselineRelevance))
+	{
+		return false;
+	}
+	body.flush();
+
+	WriteStream& stream = m_stream;
+	serializeCheck(stream, "begin_snapshot");
+
+	Sequence sequence = state.getSequence();
+	serializeBits(stream, sequence, 16);
+
+	Sequence frame = state.getFrame();
+	serializeBits(stream, frame, 16);
+
+	bool hasBaseline = baseline != nullptr;
+	serializeBool(stream, hasBaseline);
+	if (hasBaseline)
+	{
+		Sequence baselineSequence = baseline->getSequence();
+		serializeBits(stream, baselineSequence, 16);
+	}
+
+	// Lets receivers skip a delta whose baseline they no longer have
+	int32_t numBodyBits = body.getBitsWritten();
+	serializeInt(stream, numBodyBits, 0, s_maxPayloadBits);
+	stream.serializeStream(body);
+
+	serializeCheck(stream, "end_snapshot");
+	stream.flush();
+
+	return true;
+}
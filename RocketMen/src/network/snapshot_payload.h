@@ -0,0 +1,50 @@
+#pragma once
+
+#include <common.h>
+#include <utility/bitstream.h>
+#include <network/packet.h>
+#include <network/world_state.h>
+
+#include <atomic>
+
+namespace network
+{
+	/* A snapshot fills at most a whole packet, with room left for the per client fields */
+	static const int32_t s_maxPayloadSize = g_maxPacketSize - g_maxPacketOverhead;
+	static const int32_t s_maxPayloadBits = s_maxPayloadSize * 8;
+
+	/* SnapshotPayload
+	*  Snapshot encoded once per tick for every client sharing the same
+	*  baseline. Each client's Snapshot message references a payload, which
+	*  copies its bits into the outgoing packet instead of encoding again.
+	*/
+	class SnapshotPayload
+	{
+	public:
+		/** Encodes state relative to baseline, or in full when baseline is nullptr.
+		*   Relevance masks limit the entities, see WorldState::writeDelta
+		*   @return payload with a single reference, nullptr on failure */
+		static SnapshotPayload* create(const WorldState& state, const WorldState* baseline,
+			const RelevanceMask* relevance = nullptr, const RelevanceMask* baselineRelevance = nullptr);
+
+		SnapshotPayload* addRef();
+		void releaseRef();
+
+		int32_t getRefCount() const { return m_refCount.load(std::memory_order_relaxed); }
+		int32_t getNumBits()  const { return m_stream.getBitsWritten(); }
+
+		bool serialize(WriteStream& stream) const;
+
+	private:
+		SnapshotPayload();
+		~SnapshotPayload();
+
+		bool encode(const WorldState& state, const WorldState* baseline,
+			const RelevanceMask* relevance, const RelevanceMask* baselineRelevance);
+
+		/* Released by whichever send worker drops the last Snapshot */
+		std::atomic<int32_t> m_refCount;
+		WriteStream          m_stream;
+	};
+
+}; // namespace network
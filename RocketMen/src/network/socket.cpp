@@ -3,15 +3,74 @@
 
 #include <utility/bitstream.h>
 #include <core/debug.h>
+#include <network/capture_socket.h>
+#include <network/datagram_capture.h>
+#include <network/network_metrics.h>
 
 #include <assert.h>
 #include <stdio.h>
-#include <WS2tcpip.h>
 
-#pragma comment(lib, "Ws2_32.lib")
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 using namespace network;
 
+int32_t Socket::receiveBatch(Datagram* datagrams, int32_t maxDatagrams)
+{
+	ASSERT(datagrams != nullptr);
+
+	int32_t numReceived = 0;
+	while (numReceived < maxDatagrams)
+	{
+		Datagram& datagram = datagrams[numReceived];
+		if (!receive(datagram.address, datagram.data, datagram.length))
+		{
+			break;
+		}
+		numReceived++;
+	}
+
+	return numReceived;
+}
+
+bool Socket::waitForData(int32_t timeoutMilliseconds)
+{
+	// Implementations without a way to block are polled at the timeout
+	std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMilliseconds));
+	return true;
+}
+
+Socket* Socket::create()
+{
+	Socket* socket = createPlatformSocket();
+	if (std::shared_ptr<DatagramCapture> capture = DatagramCapture::getActive())
+	{
+		return new CaptureSocket(socket, capture);
+	}
+	return socket;
+}
+
+bool Socket::sendBatch(const Datagram* datagrams, int32_t numDatagrams)
+{
+	ASSERT(datagrams != nullptr);
+
+	bool result = true;
+	for (int32_t i = 0; i < numDatagrams; i++)
+	{
+		const Datagram& datagram = datagrams[i];
+		result &= send(datagram.address, datagram.data, datagram.length);
+	}
+
+	return result;
+}
+
+#ifdef _WIN32
+
+#include <WS2tcpip.h>
+
+#pragma comment(lib, "Ws2_32.lib")
+
 static bool    s_initializedWSA = false;
 static int     s_numSockets = 0;
 static WSADATA s_wsa;
@@ -31,6 +90,7 @@ public:
 
 	bool receive(Address& adress, char* buffer, int32_t& length) override;
 	bool send(const Address& adress, const void* buffer, const size_t bufferLength)	override;
+	bool waitForData(int32_t timeoutMilliseconds) override;
 	
 	uint32_t getPort()            const	override;
 	uint64_t getBytesSent()       const override;
@@ -40,22 +100,24 @@ public:
 
 private:
 	bool     m_isInitialized;
-	uint64_t m_bytesReceived;
 	uint64_t m_bytesSent;
-	uint64_t m_packetsReceived;
 	uint64_t m_packetsSent;
 	uint16_t m_port;
 
+	// Counted by the receive thread when there is one
+	std::atomic<uint64_t> m_bytesReceived;
+	std::atomic<uint64_t> m_packetsReceived;
+
 	SOCKET m_winSocket;
 };
 
 Socket_win32::Socket_win32() : 
 	m_isInitialized(false),
-	m_bytesReceived(0),
 	m_bytesSent(0),
-	m_packetsReceived(0),
 	m_packetsSent(0),
 	m_port(0),
+	m_bytesReceived(0),
+	m_packetsReceived(0),
 	m_winSocket(0)
 {
 }
@@ -84,7 +146,7 @@ Socket_win32::~Socket_win32()
 
 #ifdef _DEBUG
 	LOG_DEBUG("~Socket_win32: bytes received: %d, bytes sent: %d, packets received: %d, packets sent: %d",
-		m_bytesReceived, m_bytesSent, m_packetsReceived, m_packetsSent);
+		m_bytesReceived.load(), m_bytesSent, m_packetsReceived.load(), m_packetsSent);
 #endif
 
 }
@@ -112,6 +174,13 @@ bool Socket_win32::initialize(uint16_t port)
 		return false;
 	}
 
+	// Port 0 binds whichever port the OS picked
+	int addressLength = sizeof(localAddress);
+	if (getsockname(m_winSocket, (sockaddr*)&localAddress, &addressLength) == 0)
+	{
+		m_port = ntohs(localAddress.sin_port);
+	}
+
 	s_numSockets++;
 	m_isInitialized = true;
 	return m_isInitialized;
@@ -134,14 +203,19 @@ bool Socket_win32::send(const Address& adress, const void* buffer, size_t buffer
 		reinterpret_cast<sockaddr*>(&remoteAddress),
 		static_cast<int>(sizeof(remoteAddress)));
 
+	NetworkMetrics& metrics = NetworkMetrics::get();
 	if (dataSent == SOCKET_ERROR)
 	{
+		metrics.sendErrors.add();
 		LOG_ERROR("Socket: Send failed. Error Code : %d\n", WSAGetLastError());
 		__debugbreak();
 		return false;
 	}
 	m_bytesSent += dataSent;
 	m_packetsSent++;
+	metrics.bytesSent.add(dataSent);
+	metrics.datagramsSent.add();
+	metrics.datagramSize.observe(dataSent);
 	return true;
 }
 
@@ -170,11 +244,24 @@ uint64_t Socket_win32::getPacketsSent() const
 	return m_packetsSent;
 }
 
+bool Socket_win32::waitForData(int32_t timeoutMilliseconds)
+{
+	fd_set readSet;
+	FD_ZERO(&readSet);
+	FD_SET(m_winSocket, &readSet);
+
+	timeval timeout;
+	timeout.tv_sec  = timeoutMilliseconds / 1000;
+	timeout.tv_usec = (timeoutMilliseconds % 1000) * 1000;
+
+	return select(0, &readSet, nullptr, nullptr, &timeout) > 0;
+}
+
 bool Socket_win32::receive(Address& address, char* buffer, int32_t& length)
 {
 	sockaddr_in remoteAddress;
 	int32_t remoteAddrSize = sizeof(remoteAddress);
-	int32_t receivedLength = recvfrom(m_winSocket, buffer, g_maxPacketSize, 0, 
+	int32_t receivedLength = recvfrom(m_winSocket, buffer, g_maxDatagramSize, 0, 
 									  reinterpret_cast<sockaddr*>(&remoteAddress),
 									  &remoteAddrSize);
 
@@ -183,8 +270,13 @@ bool Socket_win32::receive(Address& address, char* buffer, int32_t& length)
 		address = Address(ntohl(remoteAddress.sin_addr.s_addr),
 						  ntohs(remoteAddress.sin_port));
 		m_bytesReceived += receivedLength;
+		m_packetsReceived++;
 		length = receivedLength;
 
+		NetworkMetrics& metrics = NetworkMetrics::get();
+		metrics.bytesReceived.add(receivedLength);
+		metrics.datagramsReceived.add();
+
 		return true;
 	}
 	else
@@ -212,7 +304,7 @@ bool Socket_win32::receive(Address& address, char* buffer, int32_t& length)
 	}
 }
 
-Socket* Socket::create()
+Socket* Socket::createPlatformSocket()
 {
 	return new Socket_win32();
 }
@@ -239,3 +331,5 @@ bool closeWSA()
 	return true;
 }
 
+#endif // _WIN32
+
@@ -9,6 +9,13 @@
 
 namespace network 
 {
+	struct Datagram
+	{
+		Address address;
+		int32_t length;
+		char    data[g_maxDatagramSize];
+	};
+
 	class Socket 
 	{
 	public:
@@ -33,13 +40,72 @@ namespace network
 		virtual bool send(const Address& address, const void* buffer, 
 						  const size_t length) = 0;
 
+		/** Receive a batch of datagrams
+		* @param Datagram* datagrams   Destination for received datagrams
+		* @param int32_t maxDatagrams  Capacity of datagrams
+		* @return number of datagrams received
+		*/
+		virtual int32_t receiveBatch(Datagram* datagrams, int32_t maxDatagrams);
+
+		/** Send a batch of datagrams
+		* @param const Datagram* datagrams  Datagrams to send
+		* @param int32_t numDatagrams       Number of datagrams to send
+		* @return true when no error occurred
+		*/
+		virtual bool sendBatch(const Datagram* datagrams, int32_t numDatagrams);
+
+		/** Blocks until a datagram can be received, for a receive thread
+		* @param int32_t timeoutMilliseconds  Longest time to block
+		* @return true when a datagram may be ready, false on timeout
+		*/
+		virtual bool waitForData(int32_t timeoutMilliseconds);
+
+		/** Sends datagrams which were queued by send(), if the implementation 
+		*   batches its sends. Call once per frame after all channels are done.
+		*/
+		virtual void flush() {}
+
+		/** Hand a packet to the destination without encoding it
+		* @param const Address& address  Destination address
+		* @param const Packet& packet    Packet to send, messages are shared by reference
+		* @return true when the packet was taken, false if it must be sent as datagram
+		*/
+		virtual bool sendPacket(const Address& /*address*/, const Packet& /*packet*/) { return false; }
+
+		/** Receive a packet which was handed over by sendPacket 
+		* @return Packet* owned by the caller, nullptr when none are pending
+		*/
+		virtual Packet* receivePacket() { return nullptr; }
+
+		/** @return true when messages exchanged with address are shared by 
+		*   reference, so the sender may still hold references to them */
+		virtual bool sharesMessagesWith(const Address& /*address*/) const { return false; }
+
+		/** The server accepted a connection from address, or removed it. Sockets
+		*   shared by servers route the datagrams of address to this one meanwhile */
+		virtual void onConnectionAdded(const Address& /*address*/) {}
+		virtual void onConnectionRemoved(const Address& /*address*/) {}
+
+		/** @return true when the datagrams received were recorded before, so
+		*   the connection cookies they carry cannot be verified */
+		virtual bool isReplaying() const { return false; }
+
+		/** @return false when datagrams must be received on the thread that 
+		*   sends, so PacketReceiver cannot receive on a thread of its own */
+		virtual bool canReceiveOnThread() const { return true; }
+
 		virtual uint32_t getPort()				const = 0;
 		virtual uint64_t getBytesReceived()		const = 0;
 		virtual uint64_t getBytesSent()			const = 0;
 		virtual uint64_t getPacketsReceived()	const = 0;
 		virtual uint64_t getPacketsSent()		const = 0;
 	
+		/** Creates a socket of the platform, wrapped in a CaptureSocket while 
+		*   a DatagramCapture is active */
 		static Socket* create();
+
+	private:
+		static Socket* createPlatformSocket();
 	};
 
 }; // namespace network
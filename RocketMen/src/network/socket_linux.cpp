@@ -0,0 +1,384 @@
+#include <network/socket.h>
+
+#include <core/debug.h>
+#include <network/network_metrics.h>
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+
+using namespace network;
+
+static const int32_t s_batchSize = 32;
+
+// Linux Impl, drains and sends datagrams with recvmmsg/sendmmsg
+class Socket_linux : public Socket
+{
+public:
+	Socket_linux();
+	~Socket_linux();
+
+	bool initialize(uint16_t port)	override;
+	bool isInitialized()      const override;
+
+	bool receive(Address& adress, char* buffer, int32_t& length) override;
+	bool send(const Address& adress, const void* buffer, const size_t bufferLength)	override;
+
+	int32_t receiveBatch(Datagram* datagrams, int32_t maxDatagrams) override;
+	bool    sendBatch(const Datagram* datagrams, int32_t numDatagrams) override;
+	bool    waitForData(int32_t timeoutMilliseconds) override;
+	void    flush() override;
+
+	uint32_t getPort()            const	override;
+	uint64_t getBytesSent()       const override;
+	uint64_t getBytesReceived()	  const override;
+	uint64_t getPacketsReceived() const override;
+	uint64_t getPacketsSent()     const override;
+
+private:
+	int32_t receiveInto(Datagram* datagrams, int32_t maxDatagrams);
+	bool    sendFrom(const Datagram* datagrams, int32_t numDatagrams);
+
+	bool     m_isInitialized;
+	uint64_t m_bytesSent;
+	uint64_t m_packetsSent;
+	uint16_t m_port;
+	int      m_socket;
+
+	// Counted by the receive thread when there is one
+	std::atomic<uint64_t> m_bytesReceived;
+	std::atomic<uint64_t> m_packetsReceived;
+
+	/* Datagrams drained by receive() but not yet handed out */
+	Datagram* m_receiveQueue;
+	int32_t   m_numReceiveQueued;
+	int32_t   m_nextReceive;
+
+	/* Datagrams queued by send() waiting for flush() */
+	Datagram* m_sendQueue;
+	int32_t   m_numSendQueued;
+};
+
+Socket_linux::Socket_linux() :
+	m_isInitialized(false),
+	m_bytesSent(0),
+	m_packetsSent(0),
+	m_port(0),
+	m_socket(-1),
+	m_bytesReceived(0),
+	m_packetsReceived(0),
+	m_receiveQueue(new Datagram[s_batchSize]),
+	m_numReceiveQueued(0),
+	m_nextReceive(0),
+	m_sendQueue(new Datagram[s_batchSize]),
+	m_numSendQueued(0)
+{
+}
+
+Socket_linux::~Socket_linux()
+{
+	if (m_isInitialized)
+	{
+		flush();
+		close(m_socket);
+	}
+
+	delete[] m_receiveQueue;
+	delete[] m_sendQueue;
+
+#ifdef _DEBUG
+	LOG_DEBUG("~Socket_linux: bytes received: %d, bytes sent: %d, packets received: %d, packets sent: %d",
+		m_bytesReceived.load(), m_bytesSent, m_packetsReceived.load(), m_packetsSent);
+#endif
+}
+
+bool Socket_linux::initialize(uint16_t port)
+{
+	m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+	if (m_socket < 0)
+	{
+		LOG_ERROR("Socket: socket() failed. Error Code : %d\n", errno);
+		return false;
+	}
+
+	fcntl(m_socket, F_SETFL, fcntl(m_socket, F_GETFL, 0) | O_NONBLOCK);
+	m_port = port;
+
+	sockaddr_in localAddress = {};
+	localAddress.sin_family = AF_INET;
+	localAddress.sin_addr.s_addr = INADDR_ANY;
+	localAddress.sin_port = htons(m_port);
+
+	if (bind(m_socket, (sockaddr*)&localAddress, sizeof(localAddress)) != 0)
+	{
+		LOG_ERROR("Socket: bind failed. Error Code : %d\n", errno);
+		close(m_socket);
+		m_socket = -1;
+		return false;
+	}
+
+	// Port 0 binds whichever port the OS picked
+	socklen_t addressLength = sizeof(localAddress);
+	if (getsockname(m_socket, (sockaddr*)&localAddress, &addressLength) == 0)
+	{
+		m_port = ntohs(localAddress.sin_port);
+	}
+
+	m_isInitialized = true;
+	return m_isInitialized;
+}
+
+bool Socket_linux::isInitialized() const
+{
+	return m_isInitialized;
+}
+
+bool Socket_linux::receive(Address& address, char* buffer, int32_t& length)
+{
+	if (m_nextReceive == m_numReceiveQueued)
+	{
+		m_nextReceive = 0;
+		m_numReceiveQueued = receiveInto(m_receiveQueue, s_batchSize);
+		if (m_numReceiveQueued == 0)
+		{
+			return false;
+		}
+	}
+
+	const Datagram& datagram = m_receiveQueue[m_nextReceive++];
+	address = datagram.address;
+	length  = datagram.length;
+	memcpy(buffer, datagram.data, datagram.length);
+	return true;
+}
+
+bool Socket_linux::send(const Address& address, const void* buffer, size_t bufferLength)
+{
+	ASSERT(bufferLength <= static_cast<size_t>(g_maxDatagramSize), "Datagram exceeds g_maxDatagramSize");
+
+	if (m_numSendQueued == s_batchSize)
+	{
+		flush();
+	}
+
+	Datagram& datagram = m_sendQueue[m_numSendQueued++];
+	datagram.address = address;
+	datagram.length  = static_cast<int32_t>(bufferLength);
+	memcpy(datagram.data, buffer, bufferLength);
+	return true;
+}
+
+int32_t Socket_linux::receiveBatch(Datagram* datagrams, int32_t maxDatagrams)
+{
+	ASSERT(datagrams != nullptr);
+
+	// Hand out datagrams a previous receive() already drained first
+	int32_t numReceived = 0;
+	while (m_nextReceive < m_numReceiveQueued && numReceived < maxDatagrams)
+	{
+		const Datagram& datagram = m_receiveQueue[m_nextReceive++];
+		datagrams[numReceived].address = datagram.address;
+		datagrams[numReceived].length  = datagram.length;
+		memcpy(datagrams[numReceived].data, datagram.data, datagram.length);
+		numReceived++;
+	}
+
+	if (numReceived < maxDatagrams)
+	{
+		numReceived += receiveInto(datagrams + numReceived, maxDatagrams - numReceived);
+	}
+
+	return numReceived;
+}
+
+bool Socket_linux::sendBatch(const Datagram* datagrams, int32_t numDatagrams)
+{
+	ASSERT(datagrams != nullptr);
+
+	// Preserve ordering with datagrams queued through send()
+	flush();
+	return sendFrom(datagrams, numDatagrams);
+}
+
+bool Socket_linux::waitForData(int32_t timeoutMilliseconds)
+{
+	if (m_nextReceive < m_numReceiveQueued)
+	{
+		return true;
+	}
+
+	pollfd descriptor = {};
+	descriptor.fd     = m_socket;
+	descriptor.events = POLLIN;
+	return poll(&descriptor, 1, timeoutMilliseconds) > 0;
+}
+
+void Socket_linux::flush()
+{
+	if (m_numSendQueued > 0)
+	{
+		sendFrom(m_sendQueue, m_numSendQueued);
+		m_numSendQueued = 0;
+	}
+}
+
+uint32_t Socket_linux::getPort() const
+{
+	return m_port;
+}
+
+uint64_t Socket_linux::getBytesSent() const
+{
+	return m_bytesSent;
+}
+
+uint64_t Socket_linux::getBytesReceived() const
+{
+	return m_bytesReceived;
+}
+
+uint64_t Socket_linux::getPacketsReceived() const
+{
+	return m_packetsReceived;
+}
+
+uint64_t Socket_linux::getPacketsSent() const
+{
+	return m_packetsSent;
+}
+
+int32_t Socket_linux::receiveInto(Datagram* datagrams, int32_t maxDatagrams)
+{
+	mmsghdr     headers[s_batchSize];
+	iovec       vectors[s_batchSize];
+	sockaddr_in addresses[s_batchSize];
+	NetworkMetrics& metrics = NetworkMetrics::get();
+
+	int32_t numReceived = 0;
+	while (numReceived < maxDatagrams)
+	{
+		const int32_t batchSize = std::min(maxDatagrams - numReceived, s_batchSize);
+		for (int32_t i = 0; i < batchSize; i++)
+		{
+			vectors[i].iov_base = datagrams[numReceived + i].data;
+			vectors[i].iov_len  = g_maxDatagramSize;
+
+			headers[i] = {};
+			headers[i].msg_hdr.msg_name    = &addresses[i];
+			headers[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+			headers[i].msg_hdr.msg_iov     = &vectors[i];
+			headers[i].msg_hdr.msg_iovlen  = 1;
+		}
+
+		const int result = recvmmsg(m_socket, headers, batchSize, MSG_DONTWAIT, nullptr);
+		if (result <= 0)
+		{
+			if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNREFUSED)
+			{
+				LOG_ERROR("recvmmsg failed. Error Code : %d\n", errno);
+			}
+			break;
+		}
+
+		for (int32_t i = 0; i < result; i++)
+		{
+			Datagram& datagram = datagrams[numReceived + i];
+			datagram.address = Address(ntohl(addresses[i].sin_addr.s_addr),
+									   ntohs(addresses[i].sin_port));
+			datagram.length  = static_cast<int32_t>(headers[i].msg_len);
+			m_bytesReceived += headers[i].msg_len;
+			metrics.bytesReceived.add(headers[i].msg_len);
+		}
+
+		numReceived += result;
+		m_packetsReceived += result;
+		metrics.datagramsReceived.add(result);
+
+		if (result < batchSize)
+		{
+			break;
+		}
+	}
+
+	return numReceived;
+}
+
+bool Socket_linux::sendFrom(const Datagram* datagrams, int32_t numDatagrams)
+{
+	NetworkMetrics& metrics = NetworkMetrics::get();
+	mmsghdr     headers[s_batchSize];
+	iovec       vectors[s_batchSize];
+	sockaddr_in addresses[s_batchSize];
+
+	bool isSent = true;
+	int32_t numSent = 0;
+	while (numSent < numDatagrams)
+	{
+		const int32_t batchSize = std::min(numDatagrams - numSent, s_batchSize);
+		for (int32_t i = 0; i < batchSize; i++)
+		{
+			const Datagram& datagram = datagrams[numSent + i];
+			addresses[i] = {};
+			addresses[i].sin_family = AF_INET;
+			addresses[i].sin_addr.s_addr = htonl(datagram.address.getAddress());
+			addresses[i].sin_port = htons(datagram.address.getPort());
+
+			vectors[i].iov_base = const_cast<char*>(datagram.data);
+			vectors[i].iov_len  = datagram.length;
+
+			headers[i] = {};
+			headers[i].msg_hdr.msg_name    = &addresses[i];
+			headers[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+			headers[i].msg_hdr.msg_iov     = &vectors[i];
+			headers[i].msg_hdr.msg_iovlen  = 1;
+		}
+
+		const int result = sendmmsg(m_socket, headers, batchSize, 0);
+		if (result == 0 || (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)))
+		{
+			metrics.sendErrors.add(numDatagrams - numSent);
+			LOG_WARNING("Socket: Send buffer full, dropped %d datagrams", numDatagrams - numSent);
+			return false;
+		}
+
+		// The first datagram failed, e.g. an unreachable peer, the ones after it may still go out
+		if (result < 0)
+		{
+			metrics.sendErrors.add();
+			LOG_WARNING("Socket: Send to %s failed. Error Code : %d", 
+				datagrams[numSent].address.toString().c_str(), errno);
+			isSent = false;
+			numSent++;
+			continue;
+		}
+
+		for (int32_t i = 0; i < result; i++)
+		{
+			m_bytesSent += headers[i].msg_len;
+			metrics.bytesSent.add(headers[i].msg_len);
+			metrics.datagramSize.observe(headers[i].msg_len);
+		}
+		m_packetsSent += result;
+		metrics.datagramsSent.add(result);
+		numSent += result;
+	}
+
+	return isSent;
+}
+
+Socket* Socket::createPlatformSocket()
+{
+	return new Socket_linux();
+}
+
+#endif // __linux__
@@ -2,6 +2,7 @@
 #include "unreliable_channel.h"
 
 #include <core/debug.h>
+#include <network/network_metrics.h>
 #include <network/socket.h>
 
 using namespace network;
@@ -51,16 +52,21 @@ void UnreliableChannel::sendPendingMessages(Socket* socket, const Address& addre
 	if (hasMessagesToSend())
 	{
 		Packet* packet = createPacket(time);
+
+		NetworkMetrics& metrics = NetworkMetrics::get();
+		metrics.unreliablePacketsSent.add();
+		metrics.unreliableMessagesSent.add(packet->header.numMessages);
+
 		sendPacket(socket, address, packet, messageFactory);
 		delete packet;
 	}
 }
 
-void UnreliableChannel::receivePacket(Packet& packet)
+void UnreliableChannel::receivePacket(Packet& packet, const Time& /*time*/)
 {
+	NetworkMetrics::get().unreliableMessagesReceived.add(packet.header.numMessages);
 	for (int32_t i = 0; i < packet.header.numMessages; i++)
 	{
-
 		m_receiveQueue.insert(packet.messages[i]->addRef());
 	}
 }
@@ -104,10 +110,9 @@ Packet* UnreliableChannel::createPacket(const Time& /*time*/)
 		{
 			ASSERT(message->getChannel() == ChannelType::UnreliableUnordered);
 
-			message->assignId(m_nextMessageId++);
-
+			// Messages are shared between connections, the id only lives in the packet
 			packet->messages[packet->header.numMessages] = message->addRef();
-			packet->messageIds[packet->header.numMessages] = message->getId();
+			packet->messageIds[packet->header.numMessages] = m_nextMessageId++;
 			packet->messageTypes[packet->header.numMessages] = message->getType();
 
 			m_sendQueue[i] = nullptr;
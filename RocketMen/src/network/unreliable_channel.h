@@ -18,7 +18,7 @@ namespace network
 		virtual void sendPendingMessages(Socket* socket, 
 			const Address& address, const Time& time, MessageFactory* messageFactory) override;
 
-		virtual void receivePacket(Packet& packet) override;
+		virtual void receivePacket(Packet& packet, const Time& time) override;
 		virtual Message* getNextMessage() override;
 
 	private:
@@ -0,0 +1,394 @@
+#include "world_state.h"
+
+#include <core/debug.h>
+#include <core/entity.h>
+#include <core/entity_manager.h>
+
+#include <cstring>
+
+using namespace network;
+
+WorldState::WorldState()
+{
+	clear();
+}
+
+WorldState::~WorldState()
+{
+}
+
+void WorldState::clear()
+{
+	m_sequence = 0;
+	m_frame    = 0;
+	m_numWords = 0;
+	std::fill(m_offsets, m_offsets + s_maxNetworkedEntities, INDEX_NONE);
+	std::fill(m_numBits, m_numBits + s_maxNetworkedEntities, 0);
+}
+
+bool WorldState::encode(Sequence sequence, Sequence frame)
+{
+	clear();
+	m_sequence = sequence;
+	m_frame    = frame;
+
+	WriteStream stream(g_maxBlockSize);
+	for (Entity* entity : EntityManager::getEntities())
+	{
+		if (!entity->isReplicated())
+		{
+			continue;
+		}
+
+		const int32_t networkId = entity->getNetworkId();
+		ASSERT(networkId >= 0 && networkId < s_maxNetworkedEntities, "Replicated entity has an invalid network id");
+		ASSERT(m_offsets[networkId] == INDEX_NONE, "NetworkId is used by more than one entity");
+
+		MeasureStream measureStream;
+		EntityManager::serializeEntity(entity, measureStream);
+		const int32_t numBits = measureStream.getMeasuredBits();
+		if (numBits <= 0)
+		{
+			continue;
+		}
+
+		const int32_t offsetBits = stream.getBitsWritten();
+		if (offsetBits + getNumWords(numBits) * 32 >= s_maxEntityStateBits)
+		{
+			LOG_WARNING("WorldState: out of space, entity netId %d left out", networkId);
+			continue;
+		}
+
+		if (!EntityManager::serializeEntity(entity, stream))
+		{
+			return false;
+		}
+
+		ASSERT(stream.getBitsWritten() - offsetBits == numBits, "Entity measured and written sizes differ");
+
+		// Pad each entity to a word boundary so deltas compare whole words
+		const int32_t padding = getNumWords(numBits) * 32 - numBits;
+		if (padding > 0)
+		{
+			stream.serializeBits(0, padding);
+		}
+
+		m_offsets[networkId] = offsetBits / 32;
+		m_numBits[networkId] = numBits;
+	}
+
+	stream.flush();
+	m_numWords = getNumWords(stream.getBitsWritten());
+	memcpy(m_words, stream.getData(), m_numWords * sizeof(uint32_t));
+
+	return true;
+}
+
+bool WorldState::writeDelta(WriteStream& stream, const WorldState* baseline,
+	const RelevanceMask* relevance, const RelevanceMask* baselineRelevance) const
+{
+	// Entities out of a client's interest are written as if they did not exist
+	auto isSent = [this, relevance](int32_t networkId) -> bool {
+		return hasEntity(networkId) && (relevance == nullptr || relevance->test(networkId));
+	};
+
+	auto isInBaseline = [baseline, baselineRelevance](int32_t networkId) -> bool {
+		return baseline != nullptr && baseline->hasEntity(networkId)
+			&& (baselineRelevance == nullptr || baselineRelevance->test(networkId));
+	};
+
+	serializeCheck(stream, "begin_world_state");
+
+	// Entities known by the baseline, in the order the receiver finds them
+	for (int32_t networkId = 0; baseline != nullptr && networkId < s_maxNetworkedEntities; networkId++)
+	{
+		if (!isInBaseline(networkId))
+		{
+			continue;
+		}
+
+		bool unchanged = isSent(networkId) && isEntityEqual(networkId, *baseline);
+		serializeBool(stream, unchanged);
+		if (unchanged)
+		{
+			continue;
+		}
+
+		// Cheap out of scope notification, the receiver drops its replica
+		bool present = isSent(networkId);
+		serializeBool(stream, present);
+		if (!present)
+		{
+			continue;
+		}
+
+		bool isDiff = m_numBits[networkId] == baseline->m_numBits[networkId];
+		serializeBool(stream, isDiff);
+		if (!isDiff)
+		{
+			writeEntity(stream, networkId);
+			continue;
+		}
+
+		const uint32_t* words     = m_words + m_offsets[networkId];
+		const uint32_t* baseWords = baseline->m_words + baseline->m_offsets[networkId];
+		int32_t numBitsLeft = m_numBits[networkId];
+		for (int32_t i = 0; numBitsLeft > 0; i++)
+		{
+			const int32_t wordBits = std::min(numBitsLeft, 32);
+			uint32_t word = words[i];
+			bool changed = word != baseWords[i];
+			serializeBool(stream, changed);
+			if (changed)
+			{
+				serializeBits(stream, word, wordBits);
+			}
+			numBitsLeft -= wordBits;
+		}
+	}
+
+	int32_t numNewEntities = 0;
+	for (int32_t networkId = 0; networkId < s_maxNetworkedEntities; networkId++)
+	{
+		if (isSent(networkId) && !isInBaseline(networkId))
+		{
+			numNewEntities++;
+		}
+	}
+
+	serializeInt(stream, numNewEntities, 0, s_maxNetworkedEntities);
+	for (int32_t networkId = 0; networkId < s_maxNetworkedEntities; networkId++)
+	{
+		if (isSent(networkId) && !isInBaseline(networkId))
+		{
+			serializeInt(stream, networkId, 0, s_maxNetworkedEntities - 1);
+			writeEntity(stream, networkId);
+		}
+	}
+
+	serializeCheck(stream, "end_world_state");
+	return true;
+}
+
+bool WorldState::readDelta(ReadStream& stream, Sequence sequence, const WorldState* baseline)
+{
+	ASSERT(baseline != this, "A WorldState cannot be its own baseline");
+
+	clear();
+	m_sequence = sequence;
+
+	if (!serializeCheck(stream, "begin_world_state"))
+	{
+		return false;
+	}
+
+	if (baseline != nullptr)
+	{
+		for (int32_t networkId = 0; networkId < s_maxNetworkedEntities; networkId++)
+		{
+			if (!baseline->hasEntity(networkId))
+			{
+				continue;
+			}
+
+			const int32_t numBits = baseline->m_numBits[networkId];
+			const uint32_t* baseWords = baseline->m_words + baseline->m_offsets[networkId];
+
+			bool unchanged = false;
+			serializeBool(stream, unchanged);
+			if (unchanged)
+			{
+				if (!copyEntity(networkId, *baseline))
+				{
+					return false;
+				}
+				continue;
+			}
+
+			bool present = false;
+			serializeBool(stream, present);
+			if (!present)
+			{
+				continue;
+			}
+
+			bool isDiff = false;
+			serializeBool(stream, isDiff);
+			if (!isDiff)
+			{
+				if (!readEntity(stream, networkId))
+				{
+					return false;
+				}
+				continue;
+			}
+
+			if (!allocateEntity(networkId, numBits))
+			{
+				return false;
+			}
+
+			uint32_t* words = m_words + m_offsets[networkId];
+			int32_t numBitsLeft = numBits;
+			for (int32_t i = 0; numBitsLeft > 0; i++)
+			{
+				const int32_t wordBits = std::min(numBitsLeft, 32);
+				bool changed = false;
+				serializeBool(stream, changed);
+				words[i] = baseWords[i];
+				if (changed)
+				{
+					serializeBits(stream, words[i], wordBits);
+				}
+				numBitsLeft -= wordBits;
+			}
+		}
+	}
+
+	int32_t numNewEntities = 0;
+	serializeInt(stream, numNewEntities, 0, s_maxNetworkedEntities);
+	for (int32_t i = 0; i < numNewEntities; i++)
+	{
+		int32_t networkId = INDEX_NONE;
+		serializeInt(stream, networkId, 0, s_maxNetworkedEntities - 1);
+		if (hasEntity(networkId) || !readEntity(stream, networkId))
+		{
+			return false;
+		}
+	}
+
+	return serializeCheck(stream, "end_world_state");
+}
+
+bool WorldState::assemble(const WorldState& state, const WorldState* baseline, const RelevanceMask& deferred)
+{
+	ASSERT(&state != this && baseline != this);
+
+	clear();
+	m_sequence = state.m_sequence;
+	m_frame    = state.m_frame;
+
+	for (int32_t networkId = 0; networkId < s_maxNetworkedEntities; networkId++)
+	{
+		if (!deferred.test(networkId))
+		{
+			if (state.hasEntity(networkId) && !copyEntity(networkId, state))
+			{
+				return false;
+			}
+		}
+		else if (baseline != nullptr && baseline->hasEntity(networkId) && !copyEntity(networkId, *baseline))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool WorldState::readEntity(int32_t networkId, Entity* entity) const
+{
+	ASSERT(entity != nullptr);
+	ASSERT(hasEntity(networkId));
+
+	const int32_t numWords = getNumWords(m_numBits[networkId]);
+	ReadStream stream(reinterpret_cast<const char*>(m_words + m_offsets[networkId]), numWords * sizeof(uint32_t));
+	return EntityManager::serializeEntity(entity, stream);
+}
+
+bool WorldState::isEntityChanged(int32_t networkId, const WorldState* baseline) const
+{
+	ASSERT(hasEntity(networkId));
+	return baseline == nullptr || !baseline->hasEntity(networkId) || !isEntityEqual(networkId, *baseline);
+}
+
+bool WorldState::hasEntity(int32_t networkId) const
+{
+	ASSERT(networkId >= 0 && networkId < s_maxNetworkedEntities);
+	return m_offsets[networkId] != INDEX_NONE;
+}
+
+int32_t WorldState::getEntityBits(int32_t networkId) const
+{
+	ASSERT(networkId >= 0 && networkId < s_maxNetworkedEntities);
+	return m_numBits[networkId];
+}
+
+bool WorldState::isEntityEqual(int32_t networkId, const WorldState& other) const
+{
+	if (m_numBits[networkId] != other.m_numBits[networkId])
+	{
+		return false;
+	}
+
+	return memcmp(m_words + m_offsets[networkId], other.m_words + other.m_offsets[networkId],
+		getNumWords(m_numBits[networkId]) * sizeof(uint32_t)) == 0;
+}
+
+bool WorldState::writeEntity(WriteStream& stream, int32_t networkId) const
+{
+	int32_t numBits = m_numBits[networkId];
+	serializeInt(stream, numBits, 1, s_maxEntityStateBits);
+
+	const uint32_t* words = m_words + m_offsets[networkId];
+	int32_t numBitsLeft = numBits;
+	for (int32_t i = 0; numBitsLeft > 0; i++)
+	{
+		const int32_t wordBits = std::min(numBitsLeft, 32);
+		uint32_t word = words[i];
+		serializeBits(stream, word, wordBits);
+		numBitsLeft -= wordBits;
+	}
+
+	return true;
+}
+
+bool WorldState::readEntity(ReadStream& stream, int32_t networkId)
+{
+	int32_t numBits = 0;
+	serializeInt(stream, numBits, 1, s_maxEntityStateBits);
+	if (!allocateEntity(networkId, numBits))
+	{
+		return false;
+	}
+
+	uint32_t* words = m_words + m_offsets[networkId];
+	int32_t numBitsLeft = numBits;
+	for (int32_t i = 0; numBitsLeft > 0; i++)
+	{
+		const int32_t wordBits = std::min(numBitsLeft, 32);
+		words[i] = 0;
+		serializeBits(stream, words[i], wordBits);
+		numBitsLeft -= wordBits;
+	}
+
+	return true;
+}
+
+bool WorldState::allocateEntity(int32_t networkId, int32_t numBits)
+{
+	const int32_t numWords = getNumWords(numBits);
+	if (numBits <= 0 || m_numWords + numWords > s_maxWorldStateWords)
+	{
+		LOG_WARNING("WorldState: entity netId %d does not fit", networkId);
+		return false;
+	}
+
+	m_offsets[networkId] = m_numWords;
+	m_numBits[networkId] = numBits;
+	m_numWords += numWords;
+	return true;
+}
+
+bool WorldState::copyEntity(int32_t networkId, const WorldState& source)
+{
+	const int32_t numBits = source.m_numBits[networkId];
+	if (!allocateEntity(networkId, numBits))
+	{
+		return false;
+	}
+
+	memcpy(m_words + m_offsets[networkId], source.m_words + source.m_offsets[networkId],
+		getNumWords(numBits) * sizeof(uint32_t));
+	return true;
+}
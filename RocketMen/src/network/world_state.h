@@ -0,0 +1,79 @@
+#pragma once
+
+#include <common.h>
+#include <core/entity_manager.h>
+#include <network/packet.h>
+
+#include <bitset>
+
+class Entity;
+
+namespace network
+{
+	static const int32_t s_maxWorldStateWords  = g_maxBlockSize / 4;
+	static const int32_t s_maxEntityStateBits  = s_maxWorldStateWords * 32;
+
+	/* Set of NetworkIds a client is sent in a snapshot */
+	using RelevanceMask = std::bitset<s_maxNetworkedEntities>;
+
+	/* WorldState
+	*  Encoded state of every replicated entity at one snapshot tick. Each
+	*  entity is stored word-aligned so a later state can be sent as a diff of
+	*  the 32-bit words that changed against a state the client acknowledged.
+	*/
+	class WorldState
+	{
+	public:
+		WorldState();
+		~WorldState();
+
+		void clear();
+
+		/** Encodes all replicated entities through EntityManager
+		*   @param frame  Server frame the entities were last simulated at */
+		bool encode(Sequence sequence, Sequence frame);
+
+		/** Writes this state relative to baseline, or in full when baseline is nullptr.
+		*   Unchanged entities cost a single bit, changed ones only their changed words.
+		*   @param relevance          Entities to include, all when nullptr
+		*   @param baselineRelevance  Entities the baseline was sent with, all when nullptr */
+		bool writeDelta(WriteStream& stream, const WorldState* baseline,
+			const RelevanceMask* relevance = nullptr, const RelevanceMask* baselineRelevance = nullptr) const;
+
+		/** Rebuilds a state written by writeDelta from the same baseline */
+		bool readDelta(ReadStream& stream, Sequence sequence, const WorldState* baseline);
+
+		/** Builds the state a client holds after receiving state, where the
+		*   deferred entities keep their baseline data or are left out when the
+		*   baseline lacks them */
+		bool assemble(const WorldState& state, const WorldState* baseline, const RelevanceMask& deferred);
+
+		/** Deserializes the stored state of networkId onto entity */
+		bool readEntity(int32_t networkId, Entity* entity) const;
+
+		/** @return true if networkId has to be written when sent against baseline */
+		bool isEntityChanged(int32_t networkId, const WorldState* baseline) const;
+
+		bool     hasEntity(int32_t networkId) const;
+		int32_t  getEntityBits(int32_t networkId) const;
+		Sequence getSequence()                const { return m_sequence; }
+		Sequence getFrame()                   const { return m_frame; }
+
+	private:
+		bool isEntityEqual(int32_t networkId, const WorldState& other) const;
+		bool writeEntity(WriteStream& stream, int32_t networkId) const;
+		bool readEntity(ReadStream& stream, int32_t networkId);
+		bool allocateEntity(int32_t networkId, int32_t numBits);
+		bool copyEntity(int32_t networkId, const WorldState& source);
+
+		static int32_t getNumWords(int32_t numBits) { return (numBits + 31) / 32; }
+
+		Sequence m_sequence;
+		Sequence m_frame;
+		int32_t  m_numWords;
+		int32_t  m_offsets[s_maxNetworkedEntities];
+		int32_t  m_numBits[s_maxNetworkedEntities];
+		uint32_t m_words[s_maxWorldStateWords];
+	};
+
+}; // namespace network
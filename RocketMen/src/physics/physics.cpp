@@ -4,6 +4,7 @@
 #include <core/debug.h>
 #include <core/entity.h>
 #include <core/resource_manager.h>
+#include <core/room.h>
 #include <graphics/camera.h>
 #include <graphics/renderer.h>
 #include <network/network.h>
@@ -13,9 +14,6 @@
 
 using namespace physics;
 
-static std::vector<Rigidbody*>  s_rigidbodies;
-static std::vector<Staticbody*> s_staticbodies;
-
 #ifdef PHYSICS_BOX2D
 
 /** b2Vec2 to Vector2 */
@@ -30,8 +28,7 @@ b2Vec2 tob2(const Vector2& a)
 	return b2Vec2(a.x, a.y);
 }
 
-static b2Vec2  s_gravity(0.0f, -9.80f);
-       b2World g_boxWorld(s_gravity);
+static b2Vec2 s_gravity(0.0f, -9.80f);
 
 class PhysicsDraw : public b2Draw
 {
@@ -64,22 +61,78 @@ public:
 	}
 };
 
+class RaycastCallback : public b2RayCastCallback
+{
+public:
+	const Entity* ignore   = nullptr;
+	b2Fixture*    fixture  = nullptr;
+	b2Vec2        point;
+
+	float32 ReportFixture(b2Fixture* hitFixture, const b2Vec2& hitPoint, const b2Vec2& /*normal*/, float32 fraction) {
+		if (hitFixture->IsSensor() || (ignore != nullptr && hitFixture->GetBody()->GetUserData() == ignore))
+		{
+			return -1.0f;
+		}
+
+		fixture = hitFixture;
+		point   = hitPoint;
+		return fraction;
+	}
+};
+
 static PhysicsDraw     s_debugDrawInterface;
 static ContactListener s_contactListener;
 
 // ============================================================================
 
+/* Box2D world and bodies of one Room */
+struct PhysicsWorld
+{
+	PhysicsWorld() : world(s_gravity) {}
+
+	b2World                  world;
+	std::vector<Rigidbody*>  rigidbodies;
+	std::vector<Staticbody*> staticbodies;
+};
+
+static PhysicsWorld& getPhysicsWorld()
+{
+	PhysicsWorld* physicsWorld = Room::getCurrent()->getPhysicsWorld();
+	ASSERT(physicsWorld != nullptr, "Physics is not initialized in this room");
+	return *physicsWorld;
+}
+
+b2World& getBoxWorld()
+{
+	return getPhysicsWorld().world;
+}
+
+// ============================================================================
+
 void Physics::initialize()
 {
+	Room* room = Room::getCurrent();
+	ASSERT(room->m_physicsWorld == nullptr, "Physics is already initialized in this room");
+
 	m_rigidbodyIDCounter = 0;
-	g_boxWorld.SetDebugDraw(&s_debugDrawInterface);
-	g_boxWorld.SetContactListener(&s_contactListener);
+	room->m_physicsWorld = new PhysicsWorld();
+	room->m_physicsWorld->world.SetDebugDraw(&s_debugDrawInterface);
+	room->m_physicsWorld->world.SetContactListener(&s_contactListener);
 	s_debugDrawInterface.SetFlags(b2Draw::e_shapeBit);
 }
 
+void Physics::terminate()
+{
+	destroyBodies();
+
+	Room* room = Room::getCurrent();
+	delete room->m_physicsWorld;
+	room->m_physicsWorld = nullptr;
+}
+
 void Physics::step(float timestep)
 {
-	g_boxWorld.Step(timestep, 6, 2);
+	getBoxWorld().Step(timestep, 6, 2);
 }
 
 Rigidbody* Physics::createCharacterBody(const Vector2& dimensions, Entity* owner)
@@ -99,8 +152,8 @@ Rigidbody* Physics::createCharacterBody(const Vector2& dimensions, Entity* owner
 	rigidBody->getImpl()->CreateFixture(&fixtureDef);
 	rigidBody->getImpl()->SetUserData(owner);
 
-	s_rigidbodies.push_back(rigidBody);
-	return s_rigidbodies.back();
+	getPhysicsWorld().rigidbodies.push_back(rigidBody);
+	return rigidBody;
 }
 
 Rigidbody* Physics::createBoxRigidbody(const Vector2& dimensions, const Fixture& fixture, Entity* owner)
@@ -121,8 +174,8 @@ Rigidbody* Physics::createBoxRigidbody(const Vector2& dimensions, const Fixture&
 	rigidBody->getImpl()->CreateFixture(&fixtureDef);
 	rigidBody->getImpl()->SetUserData(owner);
 
-	s_rigidbodies.push_back(rigidBody);
-	return s_rigidbodies.back();
+	getPhysicsWorld().rigidbodies.push_back(rigidBody);
+	return rigidBody;
 }
 
 Staticbody* Physics::createStaticBody(const Vector2& position, const Vector2& dimensions, const Fixture& fixture)
@@ -140,7 +193,7 @@ Staticbody* Physics::createStaticBody(const Vector2& position, const Vector2& di
 
 	staticBody->getImpl()->CreateFixture(&fixtureDef);
 
-	s_staticbodies.push_back(staticBody);
+	getPhysicsWorld().staticbodies.push_back(staticBody);
 	return staticBody;
 }
 
@@ -148,13 +201,14 @@ bool Physics::destroyRigidbody(Rigidbody* rigidBody)
 {
 	assert(rigidBody != nullptr);
 
-	for (auto it = s_rigidbodies.begin(); it != s_rigidbodies.end(); ++it)
+	PhysicsWorld& physicsWorld = getPhysicsWorld();
+	for (auto it = physicsWorld.rigidbodies.begin(); it != physicsWorld.rigidbodies.end(); ++it)
 	{
 		if ((*it) == rigidBody)
 		{
-			g_boxWorld.DestroyBody(static_cast<b2Body*>(rigidBody->getImpl()));
+			physicsWorld.world.DestroyBody(static_cast<b2Body*>(rigidBody->getImpl()));
 			delete (*it);
-			s_rigidbodies.erase(it);
+			physicsWorld.rigidbodies.erase(it);
 			return true;
 		}
 	}
@@ -177,13 +231,34 @@ void _applyBlastImpulse(b2Body* body, b2Vec2 pos, float force)
 	}
 }
 
+bool Physics::raycast(const Vector2& start, const Vector2& end, Vector2& hitPoint, Entity*& hitEntity, const Entity* ignore)
+{
+	if (start == end)
+	{
+		return false;
+	}
+
+	RaycastCallback raycastCallback;
+	raycastCallback.ignore = ignore;
+	getBoxWorld().RayCast(&raycastCallback, tob2(start), tob2(end));
+
+	if (raycastCallback.fixture == nullptr)
+	{
+		return false;
+	}
+
+	hitPoint  = toVector2(raycastCallback.point);
+	hitEntity = static_cast<Entity*>(raycastCallback.fixture->GetBody()->GetUserData());
+	return true;
+}
+
 void Physics::blastExplosion(const Vector2& position, float radius, float power)
 {
 	QueryCallback queryCallback;
 	b2AABB aabb;
 	aabb.lowerBound = tob2(position) - b2Vec2(radius, radius);
 	aabb.upperBound = tob2(position) + b2Vec2(radius, radius);
-	g_boxWorld.QueryAABB(&queryCallback, aabb);
+	getBoxWorld().QueryAABB(&queryCallback, aabb);
 
 	for (int i = 0; i < queryCallback.foundBodies.size(); i++) 
 	{
@@ -202,12 +277,13 @@ bool Physics::destroyStaticbody(Staticbody* staticBody)
 {
 	assert(staticBody != nullptr);
 
-	for (auto it = s_staticbodies.begin(); it != s_staticbodies.end(); it++)
+	PhysicsWorld& physicsWorld = getPhysicsWorld();
+	for (auto it = physicsWorld.staticbodies.begin(); it != physicsWorld.staticbodies.end(); it++)
 	{
 		if ((*it) == staticBody)
 		{
-			g_boxWorld.DestroyBody(static_cast<b2Body*>(staticBody->getImpl()));
-			s_staticbodies.erase(it);
+			physicsWorld.world.DestroyBody(static_cast<b2Body*>(staticBody->getImpl()));
+			physicsWorld.staticbodies.erase(it);
 			return true;
 		}
 	}
@@ -309,25 +385,26 @@ void Physics::loadCollisionFromTilemap(const std::string& tilemapName)
 
 void Physics::drawDebug()
 {
-	g_boxWorld.DrawDebugData();
+	getBoxWorld().DrawDebugData();
 }
 
 void Physics::destroyBodies()
 {
-	for (auto it = s_staticbodies.begin(); it != s_staticbodies.end();)
+	PhysicsWorld& physicsWorld = getPhysicsWorld();
+	for (auto it = physicsWorld.staticbodies.begin(); it != physicsWorld.staticbodies.end();)
 	{
 
-		g_boxWorld.DestroyBody(static_cast<b2Body*>((*it)->getImpl()));
+		physicsWorld.world.DestroyBody(static_cast<b2Body*>((*it)->getImpl()));
 		delete (*it);
-		it = s_staticbodies.erase(it);
+		it = physicsWorld.staticbodies.erase(it);
 	}
 
-	for (auto it = s_rigidbodies.begin(); it != s_rigidbodies.end(); )
+	for (auto it = physicsWorld.rigidbodies.begin(); it != physicsWorld.rigidbodies.end(); )
 	{
 
-		g_boxWorld.DestroyBody(static_cast<b2Body*>((*it)->getImpl()));
+		physicsWorld.world.DestroyBody(static_cast<b2Body*>((*it)->getImpl()));
 		delete (*it);
-		it = s_rigidbodies.erase(it);
+		it = physicsWorld.rigidbodies.erase(it);
 	}
 }
 
@@ -26,10 +26,18 @@ class Entity;
 
 //==============================================================================
 
+/* Physics
+*  Acts on the Box2D world of the Room bound to the calling thread
+*/
 class Physics
 {
 public:
+	/** Creates the world of the current room */
 	void initialize();
+
+	/** Destroys the bodies and world of the current room */
+	void terminate();
+
 	void step(float timestep);
 
 	static Rigidbody*  createCharacterBody(const Vector2& dimensions,
@@ -49,6 +57,12 @@ public:
 	static void        blastExplosion(const Vector2& position, float radius,
 									  float power);
 
+	/** Finds the first solid body between start and end, sensors are skipped
+	*   @param ignore  Entity whose bodies are skipped
+	*   @return true if a body was hit, its entity is nullptr for static geometry */
+	static bool        raycast(const Vector2& start, const Vector2& end, Vector2& hitPoint,
+							   Entity*& hitEntity, const Entity* ignore = nullptr);
+
 	static void        loadCollisionFromTilemap(const std::string& tilemap);
 	static void        drawDebug();
 
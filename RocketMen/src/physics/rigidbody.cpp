@@ -6,7 +6,7 @@
 
 #ifdef PHYSICS_BOX2D
 
-extern b2World g_boxWorld;
+extern b2World& getBoxWorld();
 
 extern Vector2 toVector2(const b2Vec2& a);
 extern b2Vec2  tob2(const Vector2& a);
@@ -17,7 +17,7 @@ Rigidbody::Rigidbody()
 	dynamicBodyDef.position.Set(0.0f, 0.0f);
 	dynamicBodyDef.type = b2_dynamicBody;
 
-	b2Body* body = g_boxWorld.CreateBody(&dynamicBodyDef);
+	b2Body* body = getBoxWorld().CreateBody(&dynamicBodyDef);
 	
 	m_impl = static_cast<RigidbodyImpl*>(body);
 }
@@ -66,6 +66,16 @@ void Rigidbody::applyLinearImpulse(const Vector2& force, const Vector2& position
 	m_impl->ApplyLinearImpulse(tob2(force), tob2(position), true);
 }
 
+void Rigidbody::setKinematic(bool isKinematic)
+{
+	m_impl->SetType(isKinematic ? b2_kinematicBody : b2_dynamicBody);
+}
+
+bool Rigidbody::isKinematic() const
+{
+	return m_impl->GetType() == b2_kinematicBody;
+}
+
 Vector2 Rigidbody::getWorldCenter() const
 {
 	return toVector2(m_impl->GetWorldCenter());
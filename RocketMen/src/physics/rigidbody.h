@@ -2,6 +2,7 @@
 #pragma once
 
 #include <common.h>
+#include <network/quantization.h>
 
 class RigidbodyImpl;
 //
@@ -33,6 +34,10 @@ public:
 	Vector2 getLinearVelocity() const;
 
 	void applyLinearImpulse(const Vector2& force, const Vector2& position);
+
+	/* Kinematic bodies are moved by hand and ignore forces and gravity */
+	void setKinematic(bool isKinematic);
+	bool isKinematic() const;
 	
 	Vector2 getWorldCenter() const;
 	
@@ -45,10 +50,11 @@ private:
 
 public:
 	template<typename Stream>
-	bool serializeFull(Stream& stream);
+	bool serializeFull(Stream& stream, const network::QuantizationPolicy& policy);
 
+	/** @param policy  Precision of the velocity, per EntityType */
 	template<typename Stream>
-	bool serialize(Stream& stream);
+	bool serialize(Stream& stream, const network::QuantizationPolicy& policy);
 };
 
 inline bool operator==(const Rigidbody&a, const Rigidbody& b)
@@ -57,13 +63,13 @@ inline bool operator==(const Rigidbody&a, const Rigidbody& b)
 }
 
 template<typename Stream>
-bool Rigidbody::serializeFull(Stream& stream)
+bool Rigidbody::serializeFull(Stream& stream, const network::QuantizationPolicy& policy)
 {
-	return ensure(serialize(stream));
+	return ensure(serialize(stream, policy));
 }
 
 template<typename Stream>
-bool Rigidbody::serialize(Stream& stream)
+bool Rigidbody::serialize(Stream& stream, const network::QuantizationPolicy& policy)
 {
 	Vector2 velocity;
 	if (Stream::isWriting)
@@ -71,7 +77,7 @@ bool Rigidbody::serialize(Stream& stream)
 		velocity = getLinearVelocity();
 	}
 
-	if (!serializeVector2(stream, velocity))
+	if (!network::Quantization::serializeVelocity(stream, velocity, policy))
 		return ensure(false);
 
 	if (Stream::isReading)
@@ -7,7 +7,7 @@
 #ifdef PHYSICS_BOX2D
 
 //using namespace physics;
-extern b2World g_boxWorld;
+extern b2World& getBoxWorld();
 
 extern Vector2 toVector2(const b2Vec2& a);
 extern b2Vec2  tob2(const Vector2& a);
@@ -19,7 +19,7 @@ Staticbody::Staticbody(const Vector2& position)
 	staticBodyDef.position.Set(position.x, position.y);
 	staticBodyDef.type = b2_staticBody;
 
-	b2Body* body = g_boxWorld.CreateBody(&staticBodyDef);
+	b2Body* body = getBoxWorld().CreateBody(&staticBodyDef);
 
 	m_impl = static_cast<StaticbodyData*>(body);
 }
@@ -1,6 +1,35 @@
 
+#include <core/action_buffer.h>
+#include <core/entity.h>
+#include <core/game.h>
+#include <core/game_time.h>
+#include <core/room.h>
+#include <network/address_table.h>
+#include <network/connection_cookies.h>
+#include <utility/metrics.h>
+#include <network/clock_sync.h>
+#include <network/connection.h>
+#include <network/network.h>
+#include <network/network_metrics.h>
+#include <network/server.h>
+#include <network/client/message_factory_client.h>
+#include <network/fragment_buffer.h>
+#include <network/interpolation_buffer.h>
+#include <network/packet.h>
+#include <network/packet_coder.h>
+#include <network/packet_receiver.h>
+#include <network/quantization.h>
+#include <network/replay_socket.h>
 #include <utility/bitstream.h>
+#include <utility/spsc_queue.h>
 #include <utility/utility.h>
+#include <utility/worker_pool.h>
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+extern "C" uint32_t crcFast(unsigned char const message[], int nBytes);
 
 struct SerializationTestStruct
 {
@@ -83,6 +112,742 @@ bool testMeasureStream()
 	return true;
 }
 
+bool testSerializeStream()
+{
+	SerializationTestStruct testStruct;
+	WriteStream sourceStream(256);
+	testStruct.serialize(sourceStream);
+	sourceStream.flush();
+
+	// Append at an odd bit offset, the way a shared snapshot lands in a packet
+	WriteStream writeStream(512);
+	bool leadingBit = true;
+	serializeBool(writeStream, leadingBit);
+	writeStream.serializeStream(sourceStream);
+	writeStream.flush();
+
+	ASSERT(writeStream.getBitsWritten() == sourceStream.getBitsWritten() + 1);
+
+	char readBuffer[512];
+	memcpy(readBuffer, writeStream.getData(), writeStream.getDataLength());
+	ReadStream readStream(readBuffer, roundTo(writeStream.getDataLength(), 4));
+
+	bool receivedBit = false;
+	serializeBool(readStream, receivedBit);
+
+	SerializationTestStruct receiveStruct;
+	receiveStruct.serialize(readStream);
+
+	if (!receivedBit || receiveStruct.rand_ivalue != testStruct.rand_ivalue 
+		|| receiveStruct.ivalue2 != testStruct.ivalue2)
+	{
+		ASSERT(false, "Serialization Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
+bool testSerializeData()
+{
+	// Byte data written behind a header that is not word aligned, the way fragments are
+	char source[31];
+	for (char& byte : source)
+	{
+		byte = static_cast<char>(rand());
+	}
+
+	WriteStream writeStream(64);
+	uint32_t header = 0x2a;
+	serializeBits(writeStream, header, 13);
+	writeStream.serializeData(source, sizeof(source));
+	writeStream.flush();
+
+	ReadStream readStream(writeStream.getData(), roundTo(writeStream.getDataLength(), 4));
+	uint32_t receivedHeader = 0;
+	serializeBits(readStream, receivedHeader, 13);
+
+	char received[sizeof(source)];
+	serializeData(readStream, received, sizeof(received));
+
+	if (receivedHeader != header || memcmp(received, source, sizeof(source)) != 0)
+	{
+		ASSERT(false, "Serialization Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
+bool testFragmentBuffer()
+{
+	using namespace network;
+
+	static char source[g_fragmentSize * 3];
+	for (char& byte : source)
+	{
+		byte = static_cast<char>(rand());
+	}
+
+	const int32_t numFragments = 3;
+	const int32_t length = g_fragmentSize * 2 + 100;
+	const Address address(127, 0, 0, 1, 1234);
+
+	FragmentBuffer fragments(2);
+	const char* packetData = nullptr;
+	int32_t packetLength = 0;
+
+	// Out of order, with a duplicate
+	const int32_t order[] = { 2, 0, 0, 1 };
+	bool isComplete = false;
+	for (int32_t fragmentId : order)
+	{
+		const int32_t numBytes = std::min(length - fragmentId * g_fragmentSize, g_fragmentSize);
+		isComplete = fragments.addFragment(address, 7, fragmentId, numFragments, 
+			source + fragmentId * g_fragmentSize, numBytes, packetData, packetLength);
+	}
+
+	if (!isComplete || packetLength != length || memcmp(packetData, source, length) != 0)
+	{
+		ASSERT(false, "Fragment Reassembly Test Failed");
+		return false;
+	}
+
+	// A partial packet that goes stale is dropped
+	fragments.addFragment(address, 8, 0, numFragments, source, g_fragmentSize, packetData, packetLength);
+	fragments.update(0);
+	if (fragments.getNumDropped() != 1)
+	{
+		ASSERT(false, "Fragment Reassembly Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
+/* Hands out queued datagrams, as if received from the network */
+class QueuedSocket : public network::Socket
+{
+public:
+	QueuedSocket() : m_isInitialized(false) {}
+
+	bool initialize(uint16_t /*port*/) override { return m_isInitialized = true; }
+	bool isInitialized() const override { return m_isInitialized; }
+
+	bool receive(network::Address& address, char* buffer, int32_t& length) override
+	{
+		if (datagrams.empty())
+		{
+			return false;
+		}
+
+		address = network::Address(127, 0, 0, 1, 1234);
+		length = static_cast<int32_t>(datagrams.front().size());
+		memcpy(buffer, datagrams.front().data(), length);
+		datagrams.erase(datagrams.begin());
+		return true;
+	}
+	bool send(const network::Address& /*address*/, const void* /*buffer*/, const size_t /*length*/) override { return true; }
+
+	uint32_t getPort()            const override { return 0; }
+	uint64_t getBytesReceived()   const override { return 0; }
+	uint64_t getBytesSent()       const override { return 0; }
+	uint64_t getPacketsReceived() const override { return 0; }
+	uint64_t getPacketsSent()     const override { return 0; }
+
+	std::vector<std::vector<char>> datagrams;
+
+private:
+	bool m_isInitialized;
+};
+
+bool testOversizedFragment()
+{
+	using namespace network;
+
+	// Header fields are read with more bits than their valid range needs
+	const int32_t fragmentBytes = g_maxDatagramSize - 10;
+	static_assert(fragmentBytes > g_fragmentSize, "Fragment must not fit");
+
+	WriteStream stream(g_maxDatagramSize);
+	uint32_t protocolId = g_protocolId;
+	uint32_t datagramType = static_cast<uint32_t>(DatagramType::Fragment);
+	uint32_t sequence = 1;
+	uint32_t numFragments = 0;
+	uint32_t fragmentId = 0;
+	uint32_t numBytes = fragmentBytes - 1;
+	serializeBits(stream, protocolId, 32);
+	serializeBits(stream, datagramType, 8);
+	serializeBits(stream, sequence, 16);
+	serializeBits(stream, numFragments, bitsRequired(2, g_maxFragmentsPerPacket));
+	serializeBits(stream, fragmentId, bitsRequired(0, g_maxFragmentsPerPacket - 1));
+	serializeBits(stream, numBytes, bitsRequired(1, g_fragmentSize));
+	stream.alignToByte();
+
+	static char fragment[fragmentBytes];
+	stream.serializeData(fragment, fragmentBytes);
+	stream.flush();
+
+	const int32_t length = stream.getDataLength();
+	if (length > g_maxDatagramSize)
+	{
+		ASSERT(false, "OversizedFragment Test Failed");
+		return false;
+	}
+	(uint32_t&)stream.getData()[0] = crcFast((unsigned char*)stream.getData(), length);
+
+	QueuedSocket socket;
+	socket.initialize(0);
+	socket.datagrams.emplace_back(stream.getData(), stream.getData() + length);
+
+	const uint64_t numInvalid = NetworkMetrics::get().invalidPackets.get();
+	PacketReceiver receiver(4);
+	receiver.receivePackets(&socket, nullptr);
+	if (NetworkMetrics::get().invalidPackets.get() != numInvalid + 1 || receiver.getPackets().getCount() != 0)
+	{
+		ASSERT(false, "OversizedFragment Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
+bool testClockSync()
+{
+	using namespace network;
+
+	// Server clock 3 seconds ahead and 200 ppm fast, 20ms one way with occasional queueing delays
+	const int64_t  offset   = 3000000;
+	const double   drift    = 0.0002;
+	const uint64_t timestep = 16666;
+	auto serverClock = [&](uint64_t localTime) -> uint64_t {
+		return localTime + offset + static_cast<uint64_t>(localTime * drift);
+	};
+
+	ClockSync clockSync;
+	uint64_t localTime = 1000000;
+	for (int32_t i = 0; i < 64; i++)
+	{
+		const uint64_t latency = 20000 + ((i % 5 == 0) ? static_cast<uint64_t>(rand() % 80000) : 0);
+		const uint64_t serverTime = serverClock(localTime + latency);
+		const Sequence serverFrame = static_cast<Sequence>(serverTime / timestep);
+
+		// Timestamps travel as 64-bit values
+		WriteStream writeStream(16);
+		uint64_t sentTime = serverTime;
+		serializeUint64(writeStream, sentTime);
+		writeStream.flush();
+		ReadStream readStream(writeStream.getData(), writeStream.getDataLength());
+		uint64_t receivedTime = 0;
+		serializeUint64(readStream, receivedTime);
+
+		clockSync.addSample(localTime, receivedTime, serverFrame, localTime + latency * 2);
+		localTime += 250000;
+	}
+
+	const int64_t error = static_cast<int64_t>(clockSync.getServerTime(localTime) - serverClock(localTime));
+	const double frameError = clockSync.getServerFrame(localTime, timestep)
+		- static_cast<double>(serverClock(localTime)) / timestep;
+	if (!clockSync.isSynchronized() || std::abs(error) > 2000 || std::abs(frameError) > 1.0)
+	{
+		ASSERT(false, "Clock Sync Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
+bool testInterpolationBuffer()
+{
+	using namespace network;
+
+	// Snapshots every 3 frames arriving 6 frames late, one out of order, across the Sequence wrap
+	InterpolationBuffer interpolation;
+	const double startFrame = 65520.0;
+	const int32_t order[] = { 0, 1, 3, 2, 4, 5, 6, 7, 8, 9 };
+	for (int32_t i : order)
+	{
+		const double frame = startFrame + i * 3;
+		if (interpolation.addSnapshot(static_cast<Sequence>(static_cast<int64_t>(frame)), frame + 6.0))
+		{
+			interpolation.setEntity(1, Vector2(static_cast<float>(frame), 0.0f), 0.0f);
+		}
+		interpolation.update(3.0);
+	}
+
+	// The delay covers the age and spacing of snapshots, drawn positions follow the frame
+	Vector2 position;
+	float rotation = 0.0f;
+	const double renderFrame = startFrame + 25.5;
+	if (interpolation.getDelay() < 9.0 || interpolation.getNumSnapshots() != 10
+		|| !interpolation.sample(renderFrame, 1, position, rotation)
+		|| std::abs(position.x - static_cast<float>(renderFrame)) > 0.01f
+		|| interpolation.sample(renderFrame, 2, position, rotation))
+	{
+		ASSERT(false, "Interpolation Buffer Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
+bool testActionBuffer()
+{
+	ActionDictionary dictionary;
+	ActionBuffer frames[3];
+
+	input::Action jump, move;
+	jump.set("Jump", input::ButtonState::Press);
+	move.set("MoveHorizontal", -0.5f);
+	frames[0].insert(jump);
+	frames[0].insert(move);
+	frames[1].insert(frames[0]);
+	move.set("MoveHorizontal", 0.25f);
+	frames[2].insert(move);
+
+	for (const ActionBuffer& frame : frames)
+	{
+		for (const input::Action& action : frame)
+		{
+			dictionary.add(action.getHash());
+		}
+	}
+
+	// The dictionary travels once, every frame refers to it and the frame before
+	WriteStream writeStream(128);
+	dictionary.serialize(writeStream);
+	for (int32_t i = 0; i < 3; i++)
+	{
+		frames[i].serialize(writeStream, dictionary, (i > 0) ? &frames[i - 1] : nullptr);
+	}
+	writeStream.flush();
+
+	ReadStream readStream(writeStream.getData(), roundTo(writeStream.getDataLength(), 4));
+	ActionDictionary receivedDictionary;
+	receivedDictionary.serialize(readStream);
+
+	ActionBuffer received[3];
+	for (int32_t i = 0; i < 3; i++)
+	{
+		if (!received[i].serialize(readStream, receivedDictionary, (i > 0) ? &received[i - 1] : nullptr)
+			|| !received[i].isEqual(frames[i]))
+		{
+			ASSERT(false, "Action Buffer Test Failed");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool testQuantization()
+{
+	using namespace network;
+
+	QuantizationPolicy policy;
+	policy.rotation = FieldPolicy::Quantized;
+	Quantization::setWorldBounds(64, 32);
+	Quantization::setEnabled(true);
+
+	Vector2 position(-20.3f, 11.7f);
+	Vector2 velocity(12.5f, -80.0f);
+	float   angle = -3.0f;
+
+	MeasureStream measureStream;
+	Quantization::serializePosition(measureStream, position, policy);
+	Quantization::serializeVelocity(measureStream, velocity, policy);
+	Quantization::serializeRotation(measureStream, angle, policy);
+
+	WriteStream writeStream(64);
+	Quantization::serializePosition(writeStream, position, policy);
+	Quantization::serializeVelocity(writeStream, velocity, policy);
+	Quantization::serializeRotation(writeStream, angle, policy);
+	writeStream.flush();
+
+	ReadStream readStream(writeStream.getData(), roundTo(writeStream.getDataLength(), 4));
+	Vector2 receivedPosition, receivedVelocity;
+	float   receivedAngle = 0.0f;
+	Quantization::serializePosition(readStream, receivedPosition, policy);
+	Quantization::serializeVelocity(readStream, receivedVelocity, policy);
+	Quantization::serializeRotation(readStream, receivedAngle, policy);
+	Quantization::setEnabled(false);
+
+	// Within precision, velocity clamped to its range, and far fewer than the 160 bits in full
+	if (glm::length(receivedPosition - position) > policy.positionPrecision
+		|| std::abs(receivedVelocity.x - velocity.x) > policy.velocityPrecision
+		|| std::abs(receivedVelocity.y + policy.maxVelocity) > policy.velocityPrecision
+		|| std::abs(receivedAngle - angle) > glm::pi<float>() / (1 << policy.rotationBits)
+		|| measureStream.getMeasuredBits() >= 96)
+	{
+		ASSERT(false, "Quantization Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
+bool testSpscQueue()
+{
+	// A producer thread outrunning the consumer, every value arrives once and in order
+	SpscQueue<int32_t> queue(16);
+	const int32_t numValues = 100000;
+	std::thread producer([&queue]() {
+		for (int32_t i = 0; i < numValues; i++)
+		{
+			while (!queue.push(i))
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	int32_t expected = 0;
+	while (expected < numValues)
+	{
+		int32_t value = 0;
+		if (!queue.pop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		if (value != expected)
+		{
+			producer.join();
+			ASSERT(false, "SpscQueue Test Failed");
+			return false;
+		}
+		expected++;
+	}
+
+	producer.join();
+	return queue.getCount() == 0;
+}
+
+bool testWorkerPool()
+{
+	// Every job runs exactly once per run() and is done when run() returns
+	WorkerPool pool(3);
+	const int32_t numJobs = 64;
+	std::atomic<int32_t> counts[numJobs];
+	for (int32_t run = 0; run < 100; run++)
+	{
+		for (std::atomic<int32_t>& count : counts)
+		{
+			count = 0;
+		}
+
+		pool.run(numJobs, [&counts](int32_t index) {
+			counts[index]++;
+		});
+
+		for (std::atomic<int32_t>& count : counts)
+		{
+			if (count != 1)
+			{
+				ASSERT(false, "WorkerPool Test Failed");
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool testAddressTable()
+{
+	// Ports of one host collide the most, remove every other one and find the rest
+	const int32_t numAddresses = 1000;
+	network::AddressTable table(numAddresses);
+	for (int32_t i = 0; i < numAddresses; i++)
+	{
+		if (!table.insert(network::Address(127, 0, 0, 1, static_cast<uint16_t>(50000 + i)), i))
+		{
+			ASSERT(false, "AddressTable Test Failed");
+			return false;
+		}
+	}
+
+	if (table.insert(network::Address(127, 0, 0, 1, 40000), 0) || table.getCount() != numAddresses)
+	{
+		ASSERT(false, "AddressTable Test Failed");
+		return false;
+	}
+
+	for (int32_t i = 0; i < numAddresses; i += 2)
+	{
+		table.remove(network::Address(127, 0, 0, 1, static_cast<uint16_t>(50000 + i)));
+	}
+
+	for (int32_t i = 0; i < numAddresses; i++)
+	{
+		const int32_t expected = (i % 2 == 0) ? INDEX_NONE : i;
+		if (table.find(network::Address(127, 0, 0, 1, static_cast<uint16_t>(50000 + i))) != expected)
+		{
+			ASSERT(false, "AddressTable Test Failed");
+			return false;
+		}
+	}
+
+	return table.getCount() == numAddresses / 2;
+}
+
+bool testConnectionCookies()
+{
+	network::ConnectionCookies cookies;
+	const network::Address address(192, 168, 0, 10, 4000);
+	const uint64_t cookie = cookies.generate(address);
+
+	// Bound to the address and port it was handed to
+	if (!cookies.verify(address, cookie)
+		|| cookies.verify(network::Address(192, 168, 0, 10, 4001), cookie)
+		|| cookies.verify(network::Address(192, 168, 0, 11, 4000), cookie)
+		|| cookies.verify(address, cookie ^ 1))
+	{
+		ASSERT(false, "ConnectionCookies Test Failed");
+		return false;
+	}
+
+	// Valid for one rotation of the secret, not two
+	cookies.update(20.0f);
+	const bool isValidAfterRotation = cookies.verify(address, cookie);
+	cookies.update(20.0f);
+	if (!isValidAfterRotation || cookies.verify(address, cookie))
+	{
+		ASSERT(false, "ConnectionCookies Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
+bool testMetricHistogram()
+{
+	// Bounds are inclusive, values past the last bound overflow
+	MetricHistogram histogram({ 1.0, 2.0, 4.0 });
+	const double values[] = { 0.5, 1.0, 2.0, 3.0, 10.0 };
+	for (double value : values)
+	{
+		histogram.observe(value);
+	}
+
+	if (histogram.getBucketCount(0) != 2 || histogram.getBucketCount(1) != 1 
+		|| histogram.getBucketCount(2) != 1 || histogram.getBucketCount(3) != 1
+		|| histogram.getCount() != 5 || histogram.getSum() != 16.5)
+	{
+		ASSERT(false, "MetricHistogram Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
+bool testDatagramReplay()
+{
+	const char* path = "rm_test_capture.rmdc";
+	const network::Address address(127, 0, 0, 1, 4000);
+	const char first[] = "first";
+	const char second[] = "second";
+
+	if (!network::DatagramCapture::start(path))
+	{
+		ASSERT(false, "DatagramReplay Test Failed");
+		return false;
+	}
+
+	{
+		// Only datagrams received on the replayed port are replayed
+		std::shared_ptr<network::DatagramCapture> capture = network::DatagramCapture::getActive();
+		network::DatagramCapture::stop();
+		capture->write(5000, network::CaptureDirection::Received, address, first, sizeof(first));
+		capture->write(5000, network::CaptureDirection::Sent, address, first, sizeof(first));
+		capture->write(6000, network::CaptureDirection::Received, address, first, sizeof(first));
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		capture->write(5000, network::CaptureDirection::Received, address, second, sizeof(second));
+	}
+
+	network::ReplayClock clock;
+	char buffer[64];
+	int32_t length = 0;
+	network::Address from;
+	bool isValid = false;
+	{
+		network::ReplaySocket socket(path, &clock);
+		if (socket.initialize(5000))
+		{
+			// The second datagram is not due until the clock passes its time
+			isValid = socket.receive(from, buffer, length) && from == address
+				&& length == sizeof(first) && memcmp(buffer, first, length) == 0
+				&& !socket.receive(from, buffer, length);
+
+			clock.time = 1000000;
+			isValid = isValid && socket.receive(from, buffer, length)
+				&& length == sizeof(second) && memcmp(buffer, second, length) == 0
+				&& !socket.receive(from, buffer, length)
+				&& clock.numOpened == 1 && clock.numFinished == 1;
+		}
+	}
+	std::remove(path);
+
+	if (!isValid || clock.numFinished != 1)
+	{
+		ASSERT(false, "DatagramReplay Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
+/* Keeps the datagrams sent through it, to record what a peer sends */
+class RecordingSocket : public network::Socket
+{
+public:
+	RecordingSocket() : m_isInitialized(false) {}
+
+	bool initialize(uint16_t /*port*/) override { return m_isInitialized = true; }
+	bool isInitialized() const override { return m_isInitialized; }
+
+	bool receive(network::Address& /*address*/, char* /*buffer*/, int32_t& /*length*/) override { return false; }
+	bool send(const network::Address& /*address*/, const void* buffer, const size_t length) override
+	{
+		const char* data = static_cast<const char*>(buffer);
+		datagrams.emplace_back(data, data + length);
+		return true;
+	}
+
+	uint32_t getPort()            const override { return 0; }
+	uint64_t getBytesReceived()   const override { return 0; }
+	uint64_t getBytesSent()       const override { return 0; }
+	uint64_t getPacketsReceived() const override { return 0; }
+	uint64_t getPacketsSent()     const override { return 0; }
+
+	std::vector<std::vector<char>> datagrams;
+
+private:
+	bool m_isInitialized;
+};
+
+class HeadlessGame : public Game
+{
+public:
+	HeadlessGame() { m_sessionType = GameSessionType::Online; }
+
+	void initialize(const GameContext& /*context*/) override {}
+	void onPlayerJoin(int16_t /*playerId*/) override {}
+	void onPlayerLeave(int16_t /*playerId*/) override {}
+};
+
+bool testServerReplay()
+{
+	const char* path = "rm_test_server.rmdc";
+	const network::Address clientAddress(127, 0, 0, 1, 50000);
+
+	// The request of a client and its answer to the challenge of the recorded server
+	RecordingSocket clientSocket;
+	clientSocket.initialize(0);
+	network::MessageFactoryClient messageFactory;
+	Time time;
+	{
+		network::Connection connection(&clientSocket, network::Address(127, 0, 0, 1, s_defaultServerPort),
+			[](network::ConnectionCallback, network::Connection*) {}, messageFactory);
+		connection.tryConnect();
+		connection.sendPendingMessages(time);
+		connection.onChallenge(0x5EC4E7);
+		connection.sendPendingMessages(time);
+		connection.close();
+	}
+
+	if (clientSocket.datagrams.size() != 2 || !network::DatagramCapture::start(path))
+	{
+		ASSERT(false, "ServerReplay Test Failed");
+		return false;
+	}
+
+	{
+		std::shared_ptr<network::DatagramCapture> capture = network::DatagramCapture::getActive();
+		network::DatagramCapture::stop();
+		for (const std::vector<char>& datagram : clientSocket.datagrams)
+		{
+			capture->write(s_defaultServerPort, network::CaptureDirection::Received, clientAddress,
+				datagram.data(), static_cast<int32_t>(datagram.size()));
+		}
+	}
+
+	// The replayed server accepts the cookie it never handed out
+	network::ReplayClock clock;
+	Room room(0);
+	room.setSocketFactory([path, &clock]() -> network::Socket* { return new network::ReplaySocket(path, &clock); });
+	Room::bind(&room);
+
+	bool isValid = false;
+	{
+		HeadlessGame game;
+		network::Server server(&game);
+		if (server.host(s_defaultServerPort, GameSessionType::Online))
+		{
+			clock.time = 1000000;
+			server.update(time);
+			isValid = server.getNumClients() == 1 && clock.numFinished == clock.numOpened;
+		}
+	}
+
+	Room::bind(nullptr);
+	std::remove(path);
+
+	if (!isValid)
+	{
+		ASSERT(false, "ServerReplay Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
+bool testPacketCoder()
+{
+	// Quantized state is mostly small values and zeros, which codes smaller
+	char data[512];
+	char coded[512];
+	char decoded[512];
+	for (int32_t i = 0; i < 512; i++)
+	{
+		data[i] = static_cast<char>((i % 8 == 0) ? (i / 8) : 0);
+	}
+
+	const int32_t codedLength = network::PacketCoder::encode(data, 512, coded, 512);
+	if (codedLength <= 0 || codedLength >= 512
+		|| !network::PacketCoder::decode(coded, codedLength, decoded, 512)
+		|| memcmp(data, decoded, 512) != 0)
+	{
+		ASSERT(false, "PacketCoder Test Failed");
+		return false;
+	}
+
+	// Random bytes do not code smaller, but still decode when given the room
+	for (int32_t i = 0; i < 512; i++)
+	{
+		data[i] = static_cast<char>(rand());
+	}
+
+	if (network::PacketCoder::encode(data, 512, coded, 511) != 0)
+	{
+		ASSERT(false, "PacketCoder Test Failed");
+		return false;
+	}
+
+	char largeCoded[600];
+	const int32_t randomLength = network::PacketCoder::encode(data, 512, largeCoded, 600);
+	if (randomLength <= 0 
+		|| !network::PacketCoder::decode(largeCoded, randomLength, decoded, 512)
+		|| memcmp(data, decoded, 512) != 0)
+	{
+		ASSERT(false, "PacketCoder Test Failed");
+		return false;
+	}
+
+	return true;
+}
+
 bool testSerialization()
 {
 	if (!testMeasureStream())
@@ -90,6 +855,86 @@ bool testSerialization()
 		return false;
 	}
 
+	if (!testSerializeStream())
+	{
+		return false;
+	}
+
+	if (!testSerializeData())
+	{
+		return false;
+	}
+
+	if (!testFragmentBuffer())
+	{
+		return false;
+	}
+
+	if (!testOversizedFragment())
+	{
+		return false;
+	}
+
+	if (!testClockSync())
+	{
+		return false;
+	}
+
+	if (!testInterpolationBuffer())
+	{
+		return false;
+	}
+
+	if (!testActionBuffer())
+	{
+		return false;
+	}
+
+	if (!testQuantization())
+	{
+		return false;
+	}
+
+	if (!testSpscQueue())
+	{
+		return false;
+	}
+
+	if (!testWorkerPool())
+	{
+		return false;
+	}
+
+	if (!testAddressTable())
+	{
+		return false;
+	}
+
+	if (!testConnectionCookies())
+	{
+		return false;
+	}
+
+	if (!testMetricHistogram())
+	{
+		return false;
+	}
+
+	if (!testDatagramReplay())
+	{
+		return false;
+	}
+
+	if (!testServerReplay())
+	{
+		return false;
+	}
+
+	if (!testPacketCoder())
+	{
+		return false;
+	}
+
 	SerializationTestStruct testStruct;
 	WriteStream writeStream(256);
 
@@ -7,7 +7,7 @@
 #include <bitset>
 #include <assert.h>
 
-extern "C" unsigned long crcFast(unsigned char const message[], int nBytes);
+extern "C" uint32_t crcFast(unsigned char const message[], int nBytes);
 
 BitReader::BitReader(const char* data, int32_t numBytes) :
 	m_scratch(0),
@@ -278,7 +278,7 @@ void BitWriter::writeBytes(const char* data, int32_t numBytes)
 	assert(numTailBytes >= 0 && numTailBytes < 4);
 	for (int32_t i = 0; i < numTailBytes; ++i)
 	{
-		writeBits(m_data[tailStart + i], 8);
+		writeBits(data[tailStart + i], 8);
 	}
 }
 
@@ -393,6 +393,26 @@ bool WriteStream::serializeCheck(const char* string)
 	return true;
 }
 
+bool WriteStream::serializeStream(const WriteStream& stream)
+{
+	const int32_t numBits = stream.getBitsWritten();
+	if (numBits == 0)
+	{
+		return true;
+	}
+
+	BitReader reader(stream.getData(), stream.getBufferSize());
+	int32_t numBitsLeft = numBits;
+	while (numBitsLeft > 0)
+	{
+		const int32_t wordBits = std::min(numBitsLeft, 32);
+		m_writer.writeBits(reader.readBits(wordBits), wordBits);
+		numBitsLeft -= wordBits;
+	}
+
+	return true;
+}
+
 ////////
 
 
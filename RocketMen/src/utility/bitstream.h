@@ -22,6 +22,7 @@ public:
 
 	char*  getData() const { return reinterpret_cast<char*>(m_data); }
 	int32_t getDataLength() const { return m_size; }
+	int32_t getBitsRead()   const { return m_numBitsRead; }
 
 	bool alignToByte();
 
@@ -48,6 +49,7 @@ public:
 
 	char*   getData() const { return reinterpret_cast<char*>(m_data); }
 	int32_t getDataLength() const { return (m_numBitsWritten + 7) / 8; }
+	int32_t getBitsWritten() const { return m_numBitsWritten; }
 
 	bool alignToByte();
 private:
@@ -78,6 +80,9 @@ public:
 	bool serializeData(const char* data, int32_t dataLength);
 	bool serializeCheck(const char* string);
 
+	/** Appends every bit written to a flushed stream, without realigning */
+	bool serializeStream(const WriteStream& stream);
+
 	void alignToByte() { m_writer.alignToByte(); }
 	void flush() { m_writer.flush(); }
 	void release() { m_buffer = nullptr; }
@@ -85,6 +90,7 @@ public:
 
 	char*  getData() const { return m_buffer; }
 	inline int32_t getDataLength() const { return m_writer.getDataLength(); }
+	inline int32_t getBitsWritten() const { return m_writer.getBitsWritten(); }
 	inline int32_t getBufferSize() const { return m_size; }
 
 private:
@@ -121,6 +127,7 @@ public:
 
 	char*  getData() const { return m_reader.getData(); }
 	inline int32_t getDataLength() const { return m_size; }
+	inline int32_t getBitsRead() const { return m_reader.getBitsRead(); }
 
 private:
 	char* m_buffer;
@@ -230,6 +237,17 @@ void serializeInt(Stream& stream, uint32_t& value)
 	stream.serializeBits(value, 32);
 }
 
+/* Serialize a 64-bit unsigned integer value as two 32-bit halves */
+template<typename Stream>
+void serializeUint64(Stream& stream, uint64_t& value)
+{
+	uint32_t low  = static_cast<uint32_t>(value & 0xFFFFFFFF);
+	uint32_t high = static_cast<uint32_t>(value >> 32);
+	stream.serializeBits(low, 32);
+	stream.serializeBits(high, 32);
+	value = (static_cast<uint64_t>(high) << 32) | low;
+}
+
 /* Serialize a signed integer value compressed between range [min, max] */
 template<typename Stream>
 void serializeInt(Stream& stream, int32_t& value, int32_t min, int32_t max)
@@ -0,0 +1,306 @@
+#include "metrics.h"
+
+#include <core/debug.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+enum class MetricType
+{
+	Counter,
+	Gauge,
+	Histogram
+};
+
+struct MetricEntry
+{
+	std::string      name;
+	std::string      help;
+	MetricType       type;
+	MetricCounter*   counter;
+	MetricGauge*     gauge;
+	MetricHistogram* histogram;
+};
+
+/* Never destroyed, sockets and channels may still count during exit */
+struct MetricRegistry
+{
+	std::mutex               mutex;
+	std::vector<MetricEntry> entries;
+};
+
+static MetricRegistry& getRegistry()
+{
+	static MetricRegistry* registry = new MetricRegistry();
+	return *registry;
+}
+
+static MetricEntry* findEntry(MetricRegistry& registry, const char* name, MetricType type)
+{
+	for (MetricEntry& entry : registry.entries)
+	{
+		if (entry.name == name)
+		{
+			ASSERT(entry.type == type, "Metric is registered with another type");
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+static std::thread             s_exportThread;
+static std::mutex              s_exportMutex;
+static std::condition_variable s_exportCondition;
+static bool                    s_isExportStopping = false;
+
+//=============================================================================
+
+MetricHistogram::MetricHistogram(std::initializer_list<double> bounds) :
+	m_numBounds(0),
+	m_count(0),
+	m_sum(0.0)
+{
+	ASSERT(bounds.size() > 0 && bounds.size() <= s_maxBounds, "Histogram needs 1 to s_maxBounds bounds");
+	for (double bound : bounds)
+	{
+		ASSERT(m_numBounds == 0 || bound > m_bounds[m_numBounds - 1], "Histogram bounds must ascend");
+		m_bounds[m_numBounds++] = bound;
+	}
+
+	for (std::atomic<uint64_t>& bucket : m_buckets)
+	{
+		bucket.store(0, std::memory_order_relaxed);
+	}
+}
+
+void MetricHistogram::observe(double value)
+{
+	int32_t bucket = 0;
+	while (bucket < m_numBounds && value > m_bounds[bucket])
+	{
+		bucket++;
+	}
+
+	m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+
+	double sum = m_sum.load(std::memory_order_relaxed);
+	while (!m_sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed))
+	{
+	}
+}
+
+uint64_t MetricHistogram::getBucketCount(int32_t index) const
+{
+	ASSERT(index >= 0 && index <= m_numBounds);
+	return m_buckets[index].load(std::memory_order_relaxed);
+}
+
+//=============================================================================
+
+MetricCounter& Metrics::getCounter(const char* name, const char* help)
+{
+	MetricRegistry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	if (MetricEntry* entry = findEntry(registry, name, MetricType::Counter))
+	{
+		return *entry->counter;
+	}
+
+	registry.entries.push_back({ name, help, MetricType::Counter, new MetricCounter(), nullptr, nullptr });
+	return *registry.entries.back().counter;
+}
+
+MetricGauge& Metrics::getGauge(const char* name, const char* help)
+{
+	MetricRegistry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	if (MetricEntry* entry = findEntry(registry, name, MetricType::Gauge))
+	{
+		return *entry->gauge;
+	}
+
+	registry.entries.push_back({ name, help, MetricType::Gauge, nullptr, new MetricGauge(), nullptr });
+	return *registry.entries.back().gauge;
+}
+
+MetricHistogram& Metrics::getHistogram(const char* name, const char* help, std::initializer_list<double> bounds)
+{
+	MetricRegistry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	if (MetricEntry* entry = findEntry(registry, name, MetricType::Histogram))
+	{
+		return *entry->histogram;
+	}
+
+	registry.entries.push_back({ name, help, MetricType::Histogram, nullptr, nullptr, new MetricHistogram(bounds) });
+	return *registry.entries.back().histogram;
+}
+
+std::string Metrics::write(MetricsFormat format)
+{
+	MetricRegistry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	std::ostringstream stream;
+	stream.precision(9);
+
+	if (format == MetricsFormat::Prometheus)
+	{
+		for (const MetricEntry& entry : registry.entries)
+		{
+			stream << "# HELP " << entry.name << " " << entry.help << "\n";
+			switch (entry.type)
+			{
+				case MetricType::Counter:
+				{
+					stream << "# TYPE " << entry.name << " counter\n";
+					stream << entry.name << " " << entry.counter->get() << "\n";
+					break;
+				}
+				case MetricType::Gauge:
+				{
+					stream << "# TYPE " << entry.name << " gauge\n";
+					stream << entry.name << " " << entry.gauge->get() << "\n";
+					break;
+				}
+				case MetricType::Histogram:
+				{
+					// Prometheus buckets are cumulative
+					const MetricHistogram& histogram = *entry.histogram;
+					stream << "# TYPE " << entry.name << " histogram\n";
+					uint64_t cumulative = 0;
+					for (int32_t i = 0; i < histogram.getNumBounds(); i++)
+					{
+						cumulative += histogram.getBucketCount(i);
+						stream << entry.name << "_bucket{le=\"" << histogram.getBound(i) << "\"} " << cumulative << "\n";
+					}
+					cumulative += histogram.getBucketCount(histogram.getNumBounds());
+					stream << entry.name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+					stream << entry.name << "_sum " << histogram.getSum() << "\n";
+					stream << entry.name << "_count " << cumulative << "\n";
+					break;
+				}
+			}
+		}
+		return stream.str();
+	}
+
+	stream << "{\n";
+	for (size_t i = 0; i < registry.entries.size(); i++)
+	{
+		const MetricEntry& entry = registry.entries[i];
+		stream << "\t\"" << entry.name << "\": ";
+		switch (entry.type)
+		{
+			case MetricType::Counter:
+			{
+				stream << entry.counter->get();
+				break;
+			}
+			case MetricType::Gauge:
+			{
+				stream << entry.gauge->get();
+				break;
+			}
+			case MetricType::Histogram:
+			{
+				const MetricHistogram& histogram = *entry.histogram;
+				stream << "{ \"bounds\": [";
+				for (int32_t j = 0; j < histogram.getNumBounds(); j++)
+				{
+					stream << (j > 0 ? ", " : "") << histogram.getBound(j);
+				}
+				stream << "], \"buckets\": [";
+				for (int32_t j = 0; j <= histogram.getNumBounds(); j++)
+				{
+					stream << (j > 0 ? ", " : "") << histogram.getBucketCount(j);
+				}
+				stream << "], \"count\": " << histogram.getCount() << ", \"sum\": " << histogram.getSum() << " }";
+				break;
+			}
+		}
+		stream << (i + 1 < registry.entries.size() ? ",\n" : "\n");
+	}
+	stream << "}\n";
+	return stream.str();
+}
+
+bool Metrics::writeFile(const std::string& path, MetricsFormat format)
+{
+	const std::string content = write(format);
+	const std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::out | std::ios::trunc);
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		file << content;
+		if (!file.good())
+		{
+			return false;
+		}
+	}
+
+#ifdef _WIN32
+	// Rename does not replace an existing file on Windows, elsewhere it does so atomically
+	std::remove(path.c_str());
+#endif
+	return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+bool Metrics::startExport(const std::string& path, MetricsFormat format, float interval)
+{
+	ASSERT(interval > 0.0f);
+	if (s_exportThread.joinable())
+	{
+		LOG_WARNING("Metrics: already exporting");
+		return false;
+	}
+
+	if (!writeFile(path, format))
+	{
+		LOG_ERROR("Metrics: cannot write %s", path.c_str());
+		return false;
+	}
+
+	s_isExportStopping = false;
+	s_exportThread = std::thread([path, format, interval]() {
+		const auto period = std::chrono::milliseconds(static_cast<int64_t>(interval * 1000.0f));
+		std::unique_lock<std::mutex> lock(s_exportMutex);
+		while (!s_exportCondition.wait_for(lock, period, []() { return s_isExportStopping; }))
+		{
+			lock.unlock();
+			writeFile(path, format);
+			lock.lock();
+		}
+		lock.unlock();
+		writeFile(path, format);
+	});
+
+	LOG_INFO("Metrics: writing %s every %.1f seconds", path.c_str(), interval);
+	return true;
+}
+
+void Metrics::stopExport()
+{
+	if (!s_exportThread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_exportMutex);
+		s_isExportStopping = true;
+	}
+	s_exportCondition.notify_all();
+	s_exportThread.join();
+}
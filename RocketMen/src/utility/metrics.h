@@ -0,0 +1,100 @@
+#pragma once
+
+#include <common.h>
+
+#include <atomic>
+#include <initializer_list>
+#include <string>
+
+enum class MetricsFormat
+{
+	Json,
+	Prometheus
+};
+
+/* Only grows, e.g. bytes sent */
+class MetricCounter
+{
+public:
+	MetricCounter() : m_value(0) {}
+
+	void     add(uint64_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+	uint64_t get() const              { return m_value.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<uint64_t> m_value;
+};
+
+/* Goes up and down, e.g. connected clients */
+class MetricGauge
+{
+public:
+	MetricGauge() : m_value(0) {}
+
+	void    set(int64_t value)  { m_value.store(value, std::memory_order_relaxed); }
+	void    add(int64_t amount) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+	int64_t get() const         { return m_value.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<int64_t> m_value;
+};
+
+/* MetricHistogram
+*  Counts observations in fixed buckets, each bucket holds the values up
+*  to its bound and above the previous one. Values above the last bound
+*  go in an overflow bucket.
+*/
+class MetricHistogram
+{
+public:
+	static const int32_t s_maxBounds = 16;
+
+	/** @param bounds  Ascending upper bounds of the buckets */
+	MetricHistogram(std::initializer_list<double> bounds);
+
+	void observe(double value);
+
+	int32_t  getNumBounds()            const { return m_numBounds; }
+	double   getBound(int32_t index)   const { return m_bounds[index]; }
+
+	/** @param index  Bucket, getNumBounds() is the overflow bucket */
+	uint64_t getBucketCount(int32_t index) const;
+	uint64_t getCount()                const { return m_count.load(std::memory_order_relaxed); }
+	double   getSum()                  const { return m_sum.load(std::memory_order_relaxed); }
+
+private:
+	double  m_bounds[s_maxBounds];
+	int32_t m_numBounds;
+
+	std::atomic<uint64_t> m_buckets[s_maxBounds + 1];
+	std::atomic<uint64_t> m_count;
+	std::atomic<double>   m_sum;
+};
+
+/* Metrics
+*  Process wide registry of counters, gauges and histograms, kept in
+*  release builds. Looking a metric up takes a lock, so call sites keep the
+*  returned reference in a static; it stays valid until the process exits
+*  and updating it is a relaxed atomic operation. Rooms of one process
+*  share every metric.
+*/
+class Metrics
+{
+public:
+	/** Registers name on first use, later calls return the same metric
+	*   @param help  Description written along with the metric */
+	static MetricCounter&   getCounter(const char* name, const char* help);
+	static MetricGauge&     getGauge(const char* name, const char* help);
+	static MetricHistogram& getHistogram(const char* name, const char* help, std::initializer_list<double> bounds);
+
+	static std::string write(MetricsFormat format);
+
+	/** Replaces the file at path, readers never see a partly written file */
+	static bool writeFile(const std::string& path, MetricsFormat format);
+
+	/** Writes the file every interval seconds on a thread until stopExport */
+	static bool startExport(const std::string& path, MetricsFormat format, float interval);
+
+	/** Joins the export thread after a last write */
+	static void stopExport();
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <common.h>
+
+#include <atomic>
+
+/* SpscQueue
+*  Fixed size lock-free queue for exactly one producer thread and one
+*  consumer thread. The producer only writes m_tail and the consumer only
+*  writes m_head, each publishing its slots to the other with release stores.
+*/
+template<class T>
+class SpscQueue
+{
+public:
+	/** @param capacity  Must be a power of two */
+	SpscQueue(uint32_t capacity) :
+		m_buffer(new T[capacity]),
+		m_mask(capacity - 1),
+		m_head(0),
+		m_tail(0)
+	{
+		ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+	}
+
+	~SpscQueue() { delete[] m_buffer; }
+
+	/** Producer only
+	*   @return false when the queue is full */
+	bool push(const T& value)
+	{
+		const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+		{
+			return false;
+		}
+
+		m_buffer[tail & m_mask] = value;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Consumer only
+	*   @return false when the queue is empty */
+	bool pop(T& value)
+	{
+		const uint32_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		value = m_buffer[head & m_mask];
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/* Approximate while the other thread is active */
+	uint32_t getCount() const
+	{
+		return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+	}
+
+private:
+	T*       m_buffer;
+	uint32_t m_mask;
+
+	// Apart so the threads do not invalidate each other's cache line
+	alignas(64) std::atomic<uint32_t> m_head;
+	alignas(64) std::atomic<uint32_t> m_tail;
+};
@@ -2,8 +2,10 @@
 #pragma once
 
 #include <common.h>
+#include <glm/gtc/constants.hpp>
 
 #include <algorithm>
+#include <cmath>
 
 inline std::string toLower(const std::string& string)
 {
@@ -60,6 +62,18 @@ inline int32_t roundTo(int32_t value,  int32_t to)
 	return (value + to - 1) & ~ (to - 1);
 }
 
+/** @return angle alpha of the way from one angle to another in radians, along the shorter way around */
+inline float lerpAngle(float from, float to, float alpha)
+{
+	const float pi = glm::pi<float>();
+	float difference = std::fmod(to - from + pi, 2.0f * pi);
+	if (difference < 0.0f)
+	{
+		difference += 2.0f * pi;
+	}
+	return from + (difference - pi) * alpha;
+}
+
 template<typename T>
 std::string to_binary_string(T value)
 {
@@ -0,0 +1,105 @@
+#include "worker_pool.h"
+
+#include <core/debug.h>
+
+WorkerPool::WorkerPool(int32_t numThreads) :
+	m_job(nullptr),
+	m_numJobs(0),
+	m_generation(0),
+	m_numBusyThreads(0),
+	m_nextJob(0),
+	m_isStopping(false)
+{
+	ASSERT(numThreads >= 0);
+	for (int32_t i = 0; i < numThreads; i++)
+	{
+		m_threads.emplace_back(&WorkerPool::runThread, this);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isStopping = true;
+	}
+	m_startCondition.notify_all();
+
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+void WorkerPool::run(int32_t numJobs, const std::function<void(int32_t)>& job)
+{
+	if (numJobs <= 0)
+	{
+		return;
+	}
+
+	if (m_threads.empty() || numJobs == 1)
+	{
+		for (int32_t i = 0; i < numJobs; i++)
+		{
+			job(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_job            = &job;
+		m_numJobs        = numJobs;
+		m_numBusyThreads = static_cast<int32_t>(m_threads.size());
+		m_nextJob.store(0, std::memory_order_relaxed);
+		m_generation++;
+	}
+	m_startCondition.notify_all();
+
+	runJobs();
+
+	// Every thread has to leave the run before job goes out of scope
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCondition.wait(lock, [this]() { return m_numBusyThreads == 0; });
+	m_job = nullptr;
+}
+
+void WorkerPool::runThread()
+{
+	uint32_t generation = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_startCondition.wait(lock, [this, generation]() { return m_isStopping || m_generation != generation; });
+			if (m_isStopping)
+			{
+				return;
+			}
+			generation = m_generation;
+		}
+
+		runJobs();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_numBusyThreads--;
+		}
+		m_doneCondition.notify_one();
+	}
+}
+
+void WorkerPool::runJobs()
+{
+	for (;;)
+	{
+		const int32_t index = m_nextJob.fetch_add(1, std::memory_order_relaxed);
+		if (index >= m_numJobs)
+		{
+			return;
+		}
+
+		(*m_job)(index);
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <common.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* WorkerPool
+*  Threads that split the jobs of one run() call between them and the
+*  calling thread. run() returns once every job has finished, so the jobs
+*  form a barrier the caller cannot run past.
+*/
+class WorkerPool
+{
+public:
+	/** @param numThreads  Threads besides the caller, 0 runs every job on the caller */
+	WorkerPool(int32_t numThreads);
+	~WorkerPool();
+
+	/** Calls job once for every index in [0, numJobs) and waits for all of them */
+	void run(int32_t numJobs, const std::function<void(int32_t)>& job);
+
+	int32_t getNumThreads() const { return static_cast<int32_t>(m_threads.size()); }
+
+private:
+	void runThread();
+	void runJobs();
+
+	std::vector<std::thread> m_threads;
+	std::mutex               m_mutex;
+	std::condition_variable  m_startCondition;
+	std::condition_variable  m_doneCondition;
+
+	/* Current run, m_generation tells the threads a new one started */
+	const std::function<void(int32_t)>* m_job;
+	int32_t              m_numJobs;
+	uint32_t             m_generation;
+	int32_t              m_numBusyThreads;
+	std::atomic<int32_t> m_nextJob;
+	bool                 m_isStopping;
+};